@@ -17,8 +17,8 @@ int main(int argc, char* argv[]) try {
 
   std::cout << "Motor Speed Setting: " << device.get_motor_speed()
     << " Hz" << std::endl;
-//  std::cout << "Sample Rate Setting: " << device.get_sample_rate()
-//    << " Hz" << std::endl;
+  std::cout << "Sample Rate Setting: " << device.get_sample_rate()
+    << " Hz" << std::endl;
 
   std::cout << "Beginning data acquisition as soon as motor speed stabilizes..."
     << std::endl;
@@ -0,0 +1,169 @@
+#ifndef _ARCHIVE_HPP_
+#define _ARCHIVE_HPP_
+
+/*
+ * Columnar on-disk archive of full scans.
+ * Implementation detail; not exported.
+ *
+ * An archive is one file: a header followed by chunks of consecutive
+ * scans. Every chunk starts with a header holding its number of scans,
+ * its first scan's sequence number and its time range, and stores its
+ * scans column by column (timestamps, revolutions, sample offsets, then
+ * all angles and all distances), each column 64 byte aligned in host byte
+ * order. Readers map the file and index the chunk headers once; a scan's
+ * samples are then two plain arrays inside the mapping.
+ *
+ * The writer fills the open chunk's columns in memory on the appending
+ * thread and hands full chunks to its own thread, which writes them out;
+ * appending never waits on the disk. If the disk falls behind by more
+ * than a few chunks, scans are dropped and counted instead.
+ *
+ * Timestamps are microseconds since the Unix epoch.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "error.hpp"
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace archive {
+
+struct error : neo::error::error {
+  using base = neo::error::error;
+  using base::base;
+};
+
+class writer {
+ public:
+  // Creates the file at path, replacing an existing one
+  writer(const char* path, int32_t chunk_scans);
+  // Writes the open chunk; failures are lost, see flush
+  ~writer();
+
+  writer(const writer&) = delete;
+  writer& operator=(const writer&) = delete;
+
+  // Copies a full scan completed at timestamp (steady clock in us, 0 if
+  // unknown) into the open chunk. One appending thread at a time. Throws
+  // once a chunk could not be written.
+  void append(const sample* samples, int32_t count, int32_t revolution,
+      int64_t timestamp);
+
+  // Writes everything appended so far, including the open chunk. May be
+  // called from any thread, also while another one appends.
+  void flush();
+
+  uint64_t dropped() const { return dropped_scans.load(); }
+
+ private:
+  struct chunk {
+    uint64_t first_sequence;
+    std::vector<int64_t> timestamps;
+    std::vector<int32_t> revolutions;
+    std::vector<uint32_t> offsets;  // into angles and distances, scans + 1
+    std::vector<float> angles;
+    std::vector<int32_t> distances;
+
+    // Empties the columns, keeping their capacity
+    void restart(uint64_t first);
+  };
+
+  // Queues the open chunk for writing; false if too many are queued
+  bool hand_off();
+  void queue_open();  // under the lock, with room in the queue
+  void run();
+  void write(const chunk& c);
+
+  FILE* file;
+  int32_t chunk_scans;
+  int64_t epoch_offset;  // system minus steady clock, us
+
+  // Taken before `mutex`: the appending thread fills `open` under it, only
+  // ever contended by a flush
+  std::mutex open_mutex;
+  std::unique_ptr<chunk> open;
+  uint64_t sequence;  // of the next scan appended
+
+  std::mutex mutex;
+  std::condition_variable wake;     // for the writing thread
+  std::condition_variable written;  // for flush
+  std::deque<std::unique_ptr<chunk>> queued;
+  std::vector<std::unique_ptr<chunk>> spare;
+  bool writing;  // a chunk is out of the queue but not written yet
+  bool closing;
+  std::exception_ptr failure;
+  std::atomic<bool> failed;
+
+  std::atomic<uint64_t> dropped_scans;
+  std::thread thread;
+};
+
+// A scan in place inside the mapped archive
+struct view {
+  int64_t timestamp;
+  int32_t revolution;
+  int32_t count;
+  const float* angles;
+  const int32_t* distances;
+};
+
+// Read-only mapping of a whole file
+struct mapping {
+  const uint8_t* data;
+  size_t size;
+};
+
+mapping map_file(const char* path);
+void unmap_file(const mapping& m);
+
+class reader {
+ public:
+  // Maps the archive; sees the chunks complete at this point
+  explicit reader(const char* path);
+  ~reader();
+
+  reader(const reader&) = delete;
+  reader& operator=(const reader&) = delete;
+
+  uint64_t count() const { return scans; }
+
+  // First scan at or after timestamp; count() if there is none
+  uint64_t find(int64_t timestamp) const;
+
+  view at(uint64_t index) const;
+
+ private:
+  struct chunk {
+    uint64_t first_sequence;
+    uint32_t scans;
+    int64_t last_timestamp;
+    const int64_t* timestamps;
+    const int32_t* revolutions;
+    const uint32_t* offsets;
+    const float* angles;
+    const int32_t* distances;
+  };
+
+  const chunk& chunk_of(uint64_t index) const;
+
+  mapping file;
+  std::vector<chunk> chunks;
+  uint64_t scans;
+};
+
+}  // namespace archive
+}  // namespace neo
+
+#endif  // _ARCHIVE_HPP_
@@ -0,0 +1,59 @@
+#ifndef _BACKGROUND_HPP_
+#define _BACKGROUND_HPP_
+
+/*
+ * Learned static background and change detection.
+ * Implementation detail; not exported.
+ *
+ * Keeps an exponentially weighted mean and variance of the distance per
+ * angular bin (see grid.hpp for the binning). A sample is a change if it
+ * is further than max(min_change, 3 sigma) from its bin's mean. Background
+ * samples update their bin at 1 / learning_scans; changes only pull the
+ * mean, 16 times slower, so whatever stays put long enough joins the
+ * background.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace background {
+
+class model {
+ public:
+  model(int32_t bins, int32_t learning_scans, int32_t min_change);
+
+  // Learns from a full scan and copies its changed samples to out, which
+  // may be in; returns their number. Nothing changes while learning.
+  int32_t subtract(const sample* in, int32_t count, sample* out);
+
+  // Forgets the background and learns it anew
+  void relearn();
+
+  // Preallocated room for subtract's output, NEO_MAX_SAMPLES samples
+  sample* changes() { return changed.data(); }
+
+ private:
+  struct bin {
+    float mean;      // cm
+    float variance;  // cm^2
+    int32_t seen;    // samples learned, saturates at learning_scans
+  };
+
+  std::vector<uint16_t> bin_of;  // by fixed-point angle
+  std::vector<bin> bins;
+  std::vector<sample> changed;
+
+  int32_t learning_scans;
+  float min_change;
+  int32_t scans;  // learned so far, saturates at learning_scans
+};
+
+}  // namespace background
+}  // namespace neo
+
+#endif  // _BACKGROUND_HPP_
@@ -0,0 +1,37 @@
+#ifndef _CLUSTERS_HPP_
+#define _CLUSTERS_HPP_
+
+/*
+ * Clustering of scan samples into objects.
+ * Implementation detail; not exported.
+ *
+ * Samples arrive ordered by angle, so an object's samples are neighbors
+ * in the scan: one pass starts a new cluster wherever two consecutive
+ * returns are further apart than a gap, and the clusters touching 0 and
+ * 360 degrees are joined at the end. No pairwise distances, linear time.
+ *
+ * Points are (distance cos angle, distance sin angle) in cm.
+ */
+
+#include <stdint.h>
+
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace clusters {
+
+struct settings {
+  float max_gap;        // cm between consecutive samples of a cluster
+  int32_t min_samples;  // smaller clusters are dropped
+};
+
+// Writes up to capacity clusters of the samples to out in scan order, a
+// cluster wrapping past 360 degrees last; returns their number
+int32_t extract(const sample* samples, int32_t count, const settings& config,
+    cluster* out, int32_t capacity);
+
+}  // namespace clusters
+}  // namespace neo
+
+#endif  // _CLUSTERS_HPP_
@@ -0,0 +1,51 @@
+#ifndef _CODEC_HPP_
+#define _CODEC_HPP_
+
+/*
+ * Compact binary scan encoding.
+ * Implementation detail; not exported.
+ *
+ * Layout, all integers as LEB128 varints, signed ones zigzag encoded:
+ *
+ *   'N' 'S' version flags
+ *   count revolution sector
+ *   [raw body size]                      if flags & compress
+ *   body                                 LZ compressed if flags & compress
+ *
+ * The body holds per sample the second-order difference of the angle in
+ * 1/128 degree (the device's native resolution, so lossless) followed by
+ * the first-order difference of the distance.
+ */
+
+#include <stdint.h>
+
+#include "error.hpp"
+#include "scan.hpp"
+
+namespace neo {
+namespace codec {
+
+struct error : neo::error::error {
+  using base = neo::error::error;
+  using base::base;
+};
+
+enum flags : int32_t {
+  compress = 1 << 0,  // LZ compress the body
+};
+
+// Upper bound for the encoded size of a scan with count samples.
+int32_t encode_bound(int32_t count);
+
+// Returns the encoded size; throws if capacity is too small or flags has
+// unknown bits.
+int32_t encode(const neo_scan& scan, int32_t flags, uint8_t* out,
+    int32_t capacity);
+
+// Throws on malformed or truncated input, and on unknown flags.
+void decode(const uint8_t* in, int32_t size, neo_scan& out);
+
+}  // namespace codec
+}  // namespace neo
+
+#endif  // _CODEC_HPP_
@@ -0,0 +1,52 @@
+#ifndef _DENSITY_HPP_
+#define _DENSITY_HPP_
+
+/*
+ * Picks motor speed and sample rate for a scan density target.
+ * Implementation detail; not exported.
+ *
+ * A revolution at `motor_speed` Hz with `sample_rate` samples per second
+ * has an angular resolution of 360 * motor_speed / sample_rate degrees.
+ * Every sample is a 5 byte packet, so the link's baud rate caps the
+ * sample rate that can be carried without falling behind.
+ */
+
+#include <stdint.h>
+
+#include "error.hpp"
+#include "neo.h"
+
+namespace neo {
+namespace density {
+
+struct error : neo::error::error {
+  using base = neo::error::error;
+  using base::base;
+};
+
+struct setting {
+  int32_t motor_speed;  // Hz, 1 to 10
+  int32_t sample_rate;  // Hz, one of sample_rates
+};
+
+// Sample rates the device supports, in ascending order
+constexpr int32_t sample_rates[] = {500, 750, 1000};
+
+// Between Hz and the LR / LI argument codes
+int32_t sample_rate_to_code(int32_t hz);
+int32_t sample_rate_from_code(int32_t code);
+
+// Samples per second a serial link at `baudrate` carries, 8N1 framing
+int32_t sample_budget(int32_t baudrate);
+
+// Fastest revolution at or below `degrees` between samples; the lowest
+// sample rate that does, which leaves the most range and bandwidth.
+setting for_resolution(float degrees, int32_t baudrate);
+
+// Densest scans at `motor_speed` revolutions per second
+setting for_update_rate(int32_t motor_speed, int32_t baudrate);
+
+}  // namespace density
+}  // namespace neo
+
+#endif  // _DENSITY_HPP_
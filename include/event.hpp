@@ -0,0 +1,43 @@
+#ifndef _EVENT_HPP_
+#define _EVENT_HPP_
+
+/*
+ * Pollable readiness flag for application event loops.
+ * Implementation detail; not exported.
+ *
+ * The flag's descriptor polls readable while the flag is set and not
+ * otherwise: an eventfd on Linux, a pipe on other POSIX systems. Setting
+ * a set flag or clearing a clear one costs no system call, so owners can
+ * set it on every new element and clear it whenever they run out; it is
+ * level triggered and also drives edge triggered loops correctly.
+ */
+
+#include <stdint.h>
+
+#include "error.hpp"
+#include "neo.h"
+
+namespace neo {
+namespace event {
+
+using flag_s = struct flag*;
+
+struct error : neo::error::error {
+  using base = neo::error::error;
+  using base::base;
+};
+
+flag_s flag_construct();
+void flag_destruct(flag_s flag);
+
+// Not thread safe: set and clear under the lock of what the flag stands for
+void flag_set(flag_s flag);
+void flag_clear(flag_s flag);
+
+// For the application to poll; never read from or closed by it
+int32_t flag_fd(flag_s flag);
+
+}  // namespace event
+}  // namespace neo
+
+#endif  // _EVENT_HPP_
@@ -0,0 +1,69 @@
+#ifndef _GRID_HPP_
+#define _GRID_HPP_
+
+/*
+ * Resampling of scans onto a fixed angular grid.
+ * Implementation detail; not exported.
+ *
+ * Samples are binned by their fixed-point angle (1/128 degree, as sent by
+ * the device) through a precomputed table, so adding a sample is a table
+ * lookup and one update of its bin; no sorting, no floating point.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace grid {
+
+constexpr int32_t steps_per_revolution = 360 * 128;
+
+// Device angle in degrees back to its fixed-point representation
+inline uint16_t to_fixed(float degrees) {
+  return static_cast<uint16_t>(static_cast<int32_t>(degrees * 128 + 0.5f));
+}
+
+// Bin of every fixed-point angle (wrapped past 360 degrees) for `bins`
+// equal bins starting at 0 degrees
+std::vector<uint16_t> bin_table(int32_t bins);
+
+class accumulator {
+ public:
+  // bins in [1, NEO_MAX_GRID_BINS], reduction one of neo_grid_reduction
+  accumulator(int32_t bins, int32_t reduction);
+
+  void add(uint16_t angle, int32_t distance);
+
+  // Writes the reduced bins (NEO_GRID_EMPTY where nothing arrived) and
+  // starts over for the next scan.
+  void finish(int32_t* out);
+
+  // Drops what was added since the last finish
+  void clear();
+
+  int32_t bins() const { return static_cast<int32_t>(count.size()); }
+
+ private:
+  // Distance from the bin center, in 1/(2 * bins) of a fixed-point step
+  uint32_t offset(uint16_t angle, uint16_t bin) const;
+
+  int32_t reduction;
+  std::vector<uint16_t> bin_of;  // by fixed-point angle, wrapped past 360
+
+  std::vector<int64_t> value;    // minimum, nearest distance or sum
+  std::vector<uint32_t> count;
+  std::vector<uint32_t> nearest;  // offset of the sample kept, NEAREST only
+};
+
+// One-shot resampling of a complete scan; reuses the bin table and bins
+// of the calling thread's previous call with the same bins and reduction
+void resample(const neo_scan& scan, int32_t bins, int32_t reduction, int32_t* out);
+
+}  // namespace grid
+}  // namespace neo
+
+#endif  // _GRID_HPP_
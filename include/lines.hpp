@@ -0,0 +1,51 @@
+#ifndef _LINES_HPP_
+#define _LINES_HPP_
+
+/*
+ * Line segment extraction from scans.
+ * Implementation detail; not exported.
+ *
+ * Samples arrive ordered by angle, so neighbors on a wall are neighbors in
+ * the scan: segments grow one sample at a time with a total least squares
+ * fit kept up to date from running moments, and end at the first sample
+ * off the line or past a gap. A second pass merges neighboring segments
+ * whose joint fit is still good, e.g. walls split by a single noisy
+ * sample. Both passes are linear in the number of samples.
+ *
+ * Points are (distance cos angle, distance sin angle) in cm.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace lines {
+
+struct settings {
+  float max_deviation;  // cm a sample may be off the line
+  float max_gap;        // cm between neighboring samples of a segment
+  int32_t min_samples;  // shorter segments are dropped
+};
+
+struct segment {
+  float start_x;  // first sample projected onto the line, cm
+  float start_y;
+  float end_x;    // last sample projected onto the line, cm
+  float end_y;
+  int32_t first;  // sample indices, inclusive
+  int32_t last;
+  float rms;      // of the samples' distances to the line, cm
+};
+
+// Appends the segments of the scan's samples to out in scan order
+void extract(const neo_scan& scan, const settings& config,
+    std::vector<segment>& out);
+
+}  // namespace lines
+}  // namespace neo
+
+#endif  // _LINES_HPP_
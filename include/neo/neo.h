@@ -44,6 +44,84 @@ NEO_API bool neo_is_abi_compatible(void);
 typedef struct neo_error*  neo_error_s;
 typedef struct neo_device* neo_device_s;
 typedef struct neo_scan*   neo_scan_s;
+typedef struct neo_device_options* neo_device_options_s;
+typedef struct neo_shm_reader* neo_shm_reader_s;
+typedef struct neo_identity* neo_identity_s;
+typedef struct neo_discovery* neo_discovery_s;
+typedef struct neo_pose* neo_pose_s;
+typedef struct neo_lines* neo_lines_s;
+typedef struct neo_clusters* neo_clusters_s;
+typedef struct neo_tracks* neo_tracks_s;
+typedef struct neo_archive_writer* neo_archive_writer_s;
+typedef struct neo_archive_reader* neo_archive_reader_s;
+
+// How full scans reach the application
+enum neo_delivery_mode {
+  NEO_DELIVERY_QUEUE = 0,   // default: FIFO, see neo_device_get_scan
+  NEO_DELIVERY_LATEST = 1,  // triple buffer, see neo_device_get_latest_scan
+};
+
+// How the samples falling into one bin of a fixed angular grid are reduced
+enum neo_grid_reduction {
+  NEO_GRID_MIN = 0,      // closest return
+  NEO_GRID_NEAREST = 1,  // return nearest to the bin's center angle
+  NEO_GRID_MEAN = 2,     // average of the returns
+};
+
+enum neo_grid_limits {
+  NEO_GRID_EMPTY = -1,       // distance of a bin without returns
+  NEO_MAX_GRID_BINS = 1440,  // 0.25 degrees, finer than the device resolves
+};
+
+// How the grid bins of consecutive full scans are combined
+enum neo_temporal_filter {
+  NEO_TEMPORAL_MEDIAN = 0,  // median distance over the window
+  NEO_TEMPORAL_VOTE = 1,    // newest distance if most of the window agrees
+};
+
+enum neo_temporal_limits {
+  NEO_MAX_TEMPORAL_WINDOW = 15,  // scans
+};
+
+enum neo_cluster_limits {
+  NEO_MAX_CLUSTERS = 256,  // per scan clustered during assembly
+};
+
+enum neo_tracking_limits {
+  NEO_MAX_TRACKS = 64,  // followed at once, new objects beyond are ignored
+};
+
+// Serial port trade-off between reaction time and CPU wakeups
+enum neo_serial_profile {
+  NEO_SERIAL_PROFILE_STANDARD = 0,     // default: wake up on every arrival
+  NEO_SERIAL_PROFILE_LOW_LATENCY = 1,  // also disable the driver latency timer
+  NEO_SERIAL_PROFILE_LOW_CPU = 2,      // batch ~10 ms of bytes per wakeup
+};
+
+// What the device does with a new scan when its queue is full
+enum neo_queue_policy {
+  NEO_QUEUE_DROP_OLDEST = 0,     // default: make room by dropping the oldest
+  NEO_QUEUE_DROP_NEWEST = 1,     // drop the new scan
+  NEO_QUEUE_BLOCK_PRODUCER = 2,  // lossless: stall acquisition until consumed
+  NEO_QUEUE_KEEP_LATEST = 3,     // hold only the most recent scan
+};
+
+// Connection changes reported to a neo_status_callback
+enum neo_device_status {
+  NEO_STATUS_DISCONNECTED = 0,  // acquisition failed, reconnecting
+  NEO_STATUS_RECONNECTED = 1,   // streaming again after the gap
+};
+
+// Called on the acquisition thread; return quickly and do not call into the
+// device. `reason` is the failure with NEO_STATUS_DISCONNECTED, NULL
+// otherwise, and only valid during the call.
+typedef void (*neo_status_callback)(int32_t status, const char* reason,
+    void* user_data);
+
+// Flags for neo_scan_encode
+enum neo_encode_flags {
+  NEO_ENCODE_COMPRESS = 1,  // additionally LZ compress the sample data
+};
 
 NEO_API const char* neo_error_message(neo_error_s error);
 NEO_API void neo_error_destruct(neo_error_s error);
@@ -54,23 +132,458 @@ NEO_API neo_device_s neo_device_construct(
     const char* port, int32_t baudrate, neo_error_s* error);
 NEO_API void neo_device_destruct(neo_device_s device);
 
+// Construction-time device options; the device copies what it needs.
+NEO_API neo_device_options_s neo_device_options_construct(neo_error_s* error);
+NEO_API void neo_device_options_destruct(neo_device_options_s options);
+// Depth of the scan and sector queues (default 20)
+NEO_API void neo_device_options_set_queue_depth(
+    neo_device_options_s options, int32_t depth);
+// One of neo_queue_policy (default NEO_QUEUE_DROP_OLDEST)
+NEO_API void neo_device_options_set_queue_policy(
+    neo_device_options_s options, int32_t policy);
+
+// One of neo_delivery_mode (default NEO_DELIVERY_QUEUE)
+NEO_API void neo_device_options_set_delivery(
+    neo_device_options_s options, int32_t delivery);
+
+// Acquisition thread scheduling. Settings the platform or the process'
+// permissions do not allow quietly fall back to the defaults (check with
+// e.g. `ps -L -o rtprio` or /proc/<pid>/status where it matters).
+// CPU bit mask the thread is pinned to (default 0: not pinned)
+NEO_API void neo_device_options_set_thread_affinity(
+    neo_device_options_s options, uint64_t cpu_mask);
+// SCHED_FIFO priority 1-99 (default 0: regular scheduling)
+NEO_API void neo_device_options_set_thread_priority(
+    neo_device_options_s options, int32_t priority);
+// Thread name shown by debuggers and top (default "neo-scan")
+NEO_API void neo_device_options_set_thread_name(
+    neo_device_options_s options, const char* name);
+// Pre-fault and pin the scan buffers in memory (default false)
+NEO_API void neo_device_options_set_lock_memory(
+    neo_device_options_s options, bool lock);
+
+// One of neo_serial_profile (default NEO_SERIAL_PROFILE_STANDARD)
+NEO_API void neo_device_options_set_serial_profile(
+    neo_device_options_s options, int32_t profile);
+
+// Read the serial port through io_uring (default false). All devices share
+// one ring and the thread serving it. Falls back to select() where the
+// build or the running kernel lacks io_uring.
+NEO_API void neo_device_options_set_io_uring(
+    neo_device_options_s options, bool enable);
+
+// Also publish full scans into the POSIX shared memory ring `name` (e.g.
+// "/neo-scans") of `slots` >= 2 scans, for neo_shm_reader in other
+// processes. Construction fails while another running publisher holds
+// `name`; a ring left by one that crashed is replaced. NULL or "" disables
+// (default). Not available on Windows.
+NEO_API void neo_device_options_set_shm_ring(
+    neo_device_options_s options, const char* name, int32_t slots);
+
+// Also append full scans to the archive file `path` (see
+// neo_archive_writer), created when the device is constructed, in chunks
+// of `chunk_scans` scans. The acquisition thread only copies the samples;
+// a failed write ends scanning with an error. NULL or "" disables
+// (default).
+NEO_API void neo_device_options_set_archive(
+    neo_device_options_s options, const char* path, int32_t chunk_scans);
+
+// Instead of ending scanning with an error when the link fails (unplugged
+// cable, garbled bytes, closed socket), close the port, reopen it and
+// restart streaming, waiting 50 ms before the first attempt and twice as
+// long before each further one, up to `max_backoff_ms`. A reopened unit
+// that does not answer DS within 2 s counts as a failed attempt. Adapters
+// that may come back under another name are best opened by a stable one
+// such as /dev/serial/by-id/... . `callback` (may be NULL) is told when
+// scans stop and resume; see also neo_device_get_reconnects. Serial ports
+// and sockets only: replays and neo:// devices fail as before. 0
+// max_backoff_ms disables (default).
+NEO_API void neo_device_options_set_reconnect(neo_device_options_s options,
+    int32_t max_backoff_ms, neo_status_callback callback, void* user_data);
+
+// Deliver only the samples of full scans that differ from a learned static
+// background; a scan without any is the "no change" marker. The background
+// is a running mean and variance of the distance in each of `bins` angular
+// bins, learned from the first `learning_scans` scans (which come out
+// empty) and then kept up to date. A sample is a change if it is more than
+// max(min_change cm, 3 sigma) off; changes that stay are pulled into the
+// background 16 times slower than it learns. Grids still see all samples.
+// 0 bins disables (default).
+NEO_API void neo_device_options_set_background(neo_device_options_s options,
+    int32_t bins, int32_t learning_scans, int32_t min_change);
+
+// Lidar odometry: register every full scan against the previous one with
+// point-to-line ICP, pairing points at most `max_distance` cm apart, on a
+// thread of its own so acquisition never waits for it; read the poses with
+// neo_device_get_pose. Instead of the previous scan, match against a
+// keyframe replaced once the sensor moved `keyframe_distance` cm or turned
+// `keyframe_angle` degrees away from it (0 for either ignores it), which
+// keeps drift down at low speeds. 0 max_distance disables (default).
+NEO_API void neo_device_options_set_odometry(neo_device_options_s options,
+    int32_t max_distance, int32_t keyframe_distance, int32_t keyframe_angle);
+// CPU bit mask the odometry thread is pinned to (default 0: not pinned)
+NEO_API void neo_device_options_set_odometry_affinity(
+    neo_device_options_s options, uint64_t cpu_mask);
+
+// Cache file for per-unit bring-up state, keyed by serial number. Opening
+// a unit that still runs at its cached, non-default motor speed over the
+// same baud rate (so it was not power cycled) skips the motor settle wait
+// and the calibration; other units are brought up with their cached motor
+// speed. Safe to share between processes. NULL or "" disables (default).
+NEO_API void neo_device_options_set_profile_cache(
+    neo_device_options_s options, const char* path);
+
+// Also bin every full scan into `bins` equal angular bins starting at 0
+// degrees while it is assembled, reducing each bin by one of
+// neo_grid_reduction; read them with neo_scan_get_grid. 0 disables
+// (default), at most NEO_MAX_GRID_BINS.
+NEO_API void neo_device_options_set_grid(
+    neo_device_options_s options, int32_t bins, int32_t reduction);
+
+// Filter the grid (neo_device_options_set_grid) of every full scan over
+// the last `window` full scans by one of neo_temporal_filter, removing
+// returns that do not persist (dust, glass edges). NEO_TEMPORAL_VOTE keeps
+// a bin's newest distance if more than half of the window is within
+// `tolerance` cm of it and empties the bin otherwise. Each scan updates
+// every bin's window in place. Needs the grid. 0 window disables
+// (default), at most NEO_MAX_TEMPORAL_WINDOW; odd windows avoid ties.
+NEO_API void neo_device_options_set_temporal_filter(
+    neo_device_options_s options, int32_t window, int32_t mode,
+    int32_t tolerance);
+
+// Also cluster the samples of every full scan into objects while it is
+// assembled; read them with neo_scan_get_clusters. Consecutive samples at
+// most `max_gap` cm apart belong to the same cluster, clusters of fewer
+// than `min_samples` samples are dropped. Clusters the samples delivered,
+// i.e. only the changes with background subtraction. 0 max_gap disables
+// (default).
+NEO_API void neo_device_options_set_clusters(
+    neo_device_options_s options, int32_t max_gap, int32_t min_samples);
+
+// Also track the clusters of consecutive full scans as moving objects;
+// read them with neo_scan_get_tracks. A cluster continues a track if it is
+// at most `max_distance` cm from the track's predicted position; tracks
+// without a cluster for more than `max_misses` scans in a row end. Needs
+// clustering (neo_device_options_set_clusters). 0 max_distance disables
+// (default).
+NEO_API void neo_device_options_set_tracking(
+    neo_device_options_s options, int32_t max_distance, int32_t max_misses);
+
+NEO_API neo_device_s neo_device_construct_with_options(const char* port,
+    int32_t baudrate, neo_device_options_s options, neo_error_s* error);
+
+// Upper bound in bytes for the scans the device's queues can hold
+NEO_API int64_t neo_device_get_queue_memory_budget(neo_device_s device);
+
+// Completed reconnects and the microseconds spent without a link so far
+// (see neo_device_options_set_reconnect); safe to call while scanning
+NEO_API int64_t neo_device_get_reconnects(neo_device_s device);
+NEO_API int64_t neo_device_get_downtime(neo_device_s device);
+
+// Updates of the profile cache (neo_device_options_set_profile_cache) that
+// could not be written; the device keeps working without them
+NEO_API int64_t neo_device_get_profile_cache_failures(neo_device_s device);
+
 NEO_API void neo_device_start_scanning(neo_device_s device, neo_error_s* error);
+// Threads waiting in neo_device_get_scan or neo_device_get_sector meanwhile
+// get a "scanning stopped." error. Fails if the unit does not confirm the
+// stop within 2 s.
 NEO_API void neo_device_stop_scanning(neo_device_s device, neo_error_s* error);
 
 // Retrieves a scan from the queue (will block until scan is available)
 NEO_API neo_scan_s neo_device_get_scan(neo_device_s device, neo_error_s* error);
+
+// Descriptor for event loops (poll, epoll, libuv, asio) that polls
+// readable exactly while full scans are queued; fetch them with
+// neo_device_try_get_scan until it returns NULL. Created on the first call
+// and owned by the device: do not read from or close it. Call from one
+// thread at a time. Not available with NEO_DELIVERY_LATEST or on Windows.
+NEO_API int32_t neo_device_get_readiness_fd(neo_device_s device,
+    neo_error_s* error);
+// Retrieves a scan from the queue, or NULL right away if there is none.
+// Once scanning failed, reports the error on this and every later call.
+NEO_API neo_scan_s neo_device_try_get_scan(neo_device_s device,
+    neo_error_s* error);
+
+// Returns the newest complete scan without blocking, copying or locking, or
+// NULL if none arrived yet (requires NEO_DELIVERY_LATEST). The scan is owned
+// by the device and stays valid until the next call; do not destruct it.
+// Call from one thread at a time.
+NEO_API neo_scan_s neo_device_get_latest_scan(
+    neo_device_s device, neo_error_s* error);
+
+// Sector streaming: publishes every `degrees` wide sector as soon as it is
+// complete, in addition to full scans. Set before scanning; 0 disables.
+// Fails while scanning and for sizes that do not evenly divide 360.
+NEO_API void neo_device_set_sector_size(
+    neo_device_s device, int32_t degrees, neo_error_s* error);
+// Retrieves a sector from the queue (will block until sector is available)
+NEO_API neo_scan_s neo_device_get_sector(neo_device_s device, neo_error_s* error);
 NEO_API void neo_scan_destruct(neo_scan_s scan);
 
+// Retrieves the pose of the next full scan (will block until available).
+// Poses come in scan order but may skip scans the odometry thread could
+// not keep up with; each scanning session starts at the origin.
+NEO_API neo_pose_s neo_device_get_pose(neo_device_s device, neo_error_s* error);
+NEO_API void neo_pose_destruct(neo_pose_s pose);
+
+// Revolution of the scan the pose belongs to
+NEO_API int32_t neo_pose_get_revolution(neo_pose_s pose);
+// Position in cm and heading in degrees relative to the session's first
+// scan, in the frame of its samples (x along 0 degrees)
+NEO_API float neo_pose_get_x(neo_pose_s pose);
+NEO_API float neo_pose_get_y(neo_pose_s pose);
+NEO_API float neo_pose_get_heading(neo_pose_s pose);
+// Copies the 3x3 row-major covariance of x, y and heading (cm^2, cm
+// degrees, degrees^2) of the match against the reference scan
+NEO_API void neo_pose_get_covariance(neo_pose_s pose, float* covariance);
+// Point pairs the match used; 0 for the first scan and for scans that
+// could not be matched, whose pose is extrapolated from the previous ones
+NEO_API int32_t neo_pose_get_correspondences(neo_pose_s pose);
+
 NEO_API int32_t neo_scan_get_number_of_samples(neo_scan_s scan);
 NEO_API float neo_scan_get_angle(neo_scan_s scan, int32_t sample);
 NEO_API int32_t neo_scan_get_distance(neo_scan_s scan, int32_t sample);
 NEO_API int32_t neo_scan_get_signal_strength(neo_scan_s scan, int32_t sample);
+NEO_API int32_t neo_scan_get_revolution(neo_scan_s scan);
+// Index of the sector within its revolution; -1 for full scans
+NEO_API int32_t neo_scan_get_sector_index(neo_scan_s scan);
+// Steady clock time in microseconds at which the scan was completed,
+// 0 if unknown (decoded, or built by neo_scan_construct)
+NEO_API int64_t neo_scan_get_timestamp(neo_scan_s scan);
+
+// Bins of the scan's fixed angular grid, 0 if it was not binned
+NEO_API int32_t neo_scan_get_grid_bins(neo_scan_s scan);
+// Copies the grid distances (NEO_GRID_EMPTY for empty bins) into ranges,
+// which holds at least neo_scan_get_grid_bins; returns the number of bins
+NEO_API int32_t neo_scan_get_grid(neo_scan_s scan, int32_t* ranges,
+    int32_t capacity);
+// Bins any scan into `bins` fixed angular bins like the device option does
+NEO_API void neo_scan_resample(neo_scan_s scan, int32_t bins,
+    int32_t reduction, int32_t* ranges, neo_error_s* error);
+
+// Line segments (walls, edges) of a scan's samples in scan order, for
+// (distance cos angle, distance sin angle) points in cm. A segment ends at
+// the first sample more than `max_deviation` cm off its fitted line or
+// more than `max_gap` cm from the previous sample; segments of fewer than
+// `min_samples` samples are dropped. Runs in time linear in the samples.
+NEO_API neo_lines_s neo_scan_extract_lines(neo_scan_s scan,
+    int32_t max_deviation, int32_t max_gap, int32_t min_samples,
+    neo_error_s* error);
+NEO_API void neo_lines_destruct(neo_lines_s lines);
+
+NEO_API int32_t neo_lines_get_count(neo_lines_s lines);
+// End points: the segment's first and last sample projected onto its line
+NEO_API float neo_lines_get_start_x(neo_lines_s lines, int32_t line);
+NEO_API float neo_lines_get_start_y(neo_lines_s lines, int32_t line);
+NEO_API float neo_lines_get_end_x(neo_lines_s lines, int32_t line);
+NEO_API float neo_lines_get_end_y(neo_lines_s lines, int32_t line);
+// Indices of the segment's first and last sample in the scan
+NEO_API int32_t neo_lines_get_first_sample(neo_lines_s lines, int32_t line);
+NEO_API int32_t neo_lines_get_last_sample(neo_lines_s lines, int32_t line);
+// Fit quality: root mean square distance of the samples to the line in cm
+NEO_API float neo_lines_get_rms(neo_lines_s lines, int32_t line);
+
+// Clusters of a scan's samples as objects, in scan order; a cluster
+// crossing 0 degrees comes last. Consecutive samples at most `max_gap` cm
+// apart belong to the same cluster, clusters of fewer than `min_samples`
+// samples are dropped. Single pass over the angle-ordered samples.
+NEO_API neo_clusters_s neo_scan_extract_clusters(neo_scan_s scan,
+    int32_t max_gap, int32_t min_samples, neo_error_s* error);
+// Clusters found while the scan was assembled (see
+// neo_device_options_set_clusters), none if it was not clustered
+NEO_API neo_clusters_s neo_scan_get_clusters(neo_scan_s scan,
+    neo_error_s* error);
+NEO_API void neo_clusters_destruct(neo_clusters_s clusters);
+
+NEO_API int32_t neo_clusters_get_count(neo_clusters_s clusters);
+// Mean of the cluster's points in cm
+NEO_API float neo_clusters_get_centroid_x(neo_clusters_s clusters,
+    int32_t cluster);
+NEO_API float neo_clusters_get_centroid_y(neo_clusters_s clusters,
+    int32_t cluster);
+// Extent: axis-aligned bounding box of the cluster's points in cm
+NEO_API float neo_clusters_get_min_x(neo_clusters_s clusters, int32_t cluster);
+NEO_API float neo_clusters_get_min_y(neo_clusters_s clusters, int32_t cluster);
+NEO_API float neo_clusters_get_max_x(neo_clusters_s clusters, int32_t cluster);
+NEO_API float neo_clusters_get_max_y(neo_clusters_s clusters, int32_t cluster);
+// Indices of the cluster's first and last sample in the scan; first is
+// larger than last if the cluster wraps past 360 degrees
+NEO_API int32_t neo_clusters_get_first_sample(neo_clusters_s clusters,
+    int32_t cluster);
+NEO_API int32_t neo_clusters_get_last_sample(neo_clusters_s clusters,
+    int32_t cluster);
+NEO_API int32_t neo_clusters_get_sample_count(neo_clusters_s clusters,
+    int32_t cluster);
+
+// Confirmed tracks of moving objects as of the scan (see
+// neo_device_options_set_tracking), none if it was not tracked
+NEO_API neo_tracks_s neo_scan_get_tracks(neo_scan_s scan, neo_error_s* error);
+NEO_API void neo_tracks_destruct(neo_tracks_s tracks);
+
+NEO_API int32_t neo_tracks_get_count(neo_tracks_s tracks);
+// Identifies the object across scans; not reused within a session
+NEO_API int32_t neo_tracks_get_id(neo_tracks_s tracks, int32_t track);
+// Filtered position in cm and velocity in cm/s
+NEO_API float neo_tracks_get_x(neo_tracks_s tracks, int32_t track);
+NEO_API float neo_tracks_get_y(neo_tracks_s tracks, int32_t track);
+NEO_API float neo_tracks_get_velocity_x(neo_tracks_s tracks, int32_t track);
+NEO_API float neo_tracks_get_velocity_y(neo_tracks_s tracks, int32_t track);
+// Scans since the track started, and since it last had a cluster
+NEO_API int32_t neo_tracks_get_age(neo_tracks_s tracks, int32_t track);
+NEO_API int32_t neo_tracks_get_misses(neo_tracks_s tracks, int32_t track);
+
+// Builds a scan from sample arrays, e.g. to encode data from other sources
+NEO_API neo_scan_s neo_scan_construct(const float* angles,
+    const int32_t* distances, int32_t count, int32_t revolution,
+    int32_t sector, neo_error_s* error);
+// Sets the completion time of a constructed or decoded scan, see
+// neo_scan_get_timestamp
+NEO_API void neo_scan_set_timestamp(neo_scan_s scan, int64_t timestamp);
+
+// Compact binary scan encoding: fixed-point angle and distance deltas as
+// varints, optionally LZ compressed; angles keep the device's 1/128 degree
+// resolution. Encoded scans are self-describing and platform independent.
+//
+// Upper bound for the encoded size of a scan
+NEO_API int32_t neo_scan_encode_bound(neo_scan_s scan);
+// Encodes into buffer; returns the number of bytes written
+NEO_API int32_t neo_scan_encode(neo_scan_s scan, int32_t flags,
+    uint8_t* buffer, int32_t capacity, neo_error_s* error);
+// Decodes a new scan; destruct it with neo_scan_destruct
+NEO_API neo_scan_s neo_scan_decode(
+    const uint8_t* buffer, int32_t size, neo_error_s* error);
+
+// Reads full scans from a device's shared memory ring (see
+// neo_device_options_set_shm_ring): no locks, and any number of readers.
+// Starts with the newest scan published when attaching.
+NEO_API neo_shm_reader_s neo_shm_reader_construct(
+    const char* name, neo_error_s* error);
+NEO_API void neo_shm_reader_destruct(neo_shm_reader_s reader);
+// Copies the next unread scan into `scan`, which the caller owns (e.g. from
+// neo_scan_construct) and may reuse; false if none arrives within
+// timeout_ms (0 polls, -1 waits forever). Scans the publisher overwrote
+// while they were copied are skipped. The copy holds the ring's samples
+// only. Fails once the publishing device is gone.
+NEO_API bool neo_shm_reader_read(neo_shm_reader_s reader, neo_scan_s scan,
+    int32_t timeout_ms, neo_error_s* error);
+// Publisher's number of the last scan read, counting from 1
+NEO_API uint64_t neo_shm_reader_get_sequence(neo_shm_reader_s reader);
+// Scans skipped because the reader fell behind or they were overwritten
+// mid-copy; the sequence advances by one plus the scans dropped in between
+NEO_API uint64_t neo_shm_reader_get_dropped(neo_shm_reader_s reader);
+
+// Appends scans to a columnar archive file for later analysis, replacing
+// an existing file. Scans are gathered column by column into chunks of
+// `chunk_scans` in memory; a thread of the writer writes full chunks, so
+// appending never waits on the disk. Scans arriving while a few chunks
+// are still waiting for the disk are dropped and counted.
+NEO_API neo_archive_writer_s neo_archive_writer_construct(const char* path,
+    int32_t chunk_scans, neo_error_s* error);
+// Writes the scans still in memory, see neo_archive_writer_flush
+NEO_API void neo_archive_writer_destruct(neo_archive_writer_s writer);
+// Copies the scan's samples, revolution and timestamp (the time of the
+// append if it has none); one appending thread at a time. Fails once
+// writing a chunk failed.
+NEO_API void neo_archive_writer_append(neo_archive_writer_s writer,
+    neo_scan_s scan, neo_error_s* error);
+// Writes all scans appended so far and waits until they are in the file;
+// may be called from any thread, also during an append
+NEO_API void neo_archive_writer_flush(neo_archive_writer_s writer,
+    neo_error_s* error);
+// Scans not archived because the disk fell behind
+NEO_API uint64_t neo_archive_writer_get_dropped(neo_archive_writer_s writer);
+
+// Maps an archive read-only for random access; sees the scans written up
+// to now. Scans are numbered from 0 in the order they were appended.
+// Not available on Windows.
+NEO_API neo_archive_reader_s neo_archive_reader_construct(const char* path,
+    neo_error_s* error);
+NEO_API void neo_archive_reader_destruct(neo_archive_reader_s reader);
+NEO_API int64_t neo_archive_reader_get_count(neo_archive_reader_s reader);
+// Number of the first scan at or after `timestamp` (microseconds since the
+// Unix epoch); the count if there is none. Binary search over the chunks.
+NEO_API int64_t neo_archive_reader_find(neo_archive_reader_s reader,
+    int64_t timestamp);
+// Microseconds since the Unix epoch
+NEO_API int64_t neo_archive_reader_get_timestamp(neo_archive_reader_s reader,
+    int64_t scan);
+NEO_API int32_t neo_archive_reader_get_revolution(neo_archive_reader_s reader,
+    int64_t scan);
+NEO_API int32_t neo_archive_reader_get_number_of_samples(
+    neo_archive_reader_s reader, int64_t scan);
+// The scan's angles and distances in place inside the mapping: no copies,
+// valid until the reader is destructed
+NEO_API const float* neo_archive_reader_get_angles(neo_archive_reader_s reader,
+    int64_t scan);
+NEO_API const int32_t* neo_archive_reader_get_distances(
+    neo_archive_reader_s reader, int64_t scan);
 
 NEO_API int32_t neo_device_get_motor_speed(
     neo_device_s device, neo_error_s* error);
 NEO_API void neo_device_set_motor_speed(
     neo_device_s device, int32_t hz, neo_error_s* error);
 
+// Samples per second: 500, 750 or 1000
+NEO_API int32_t neo_device_get_sample_rate(
+    neo_device_s device, neo_error_s* error);
+NEO_API void neo_device_set_sample_rate(
+    neo_device_s device, int32_t hz, neo_error_s* error);
+
+// Pick motor speed and sample rate for the finest angular step `degrees`
+// at the highest update rate, or for the densest scans at `hz` updates per
+// second, within what the link's baud rate carries. Unchanged settings
+// are left alone, so the motor spin-up wait is only paid when it changes.
+NEO_API void neo_device_set_target_resolution(
+    neo_device_s device, float degrees, neo_error_s* error);
+NEO_API void neo_device_set_target_update_rate(
+    neo_device_s device, int32_t hz, neo_error_s* error);
+
+// Forgets the learned background and learns it anew from the next scans,
+// e.g. after the sensor was moved; safe to call while scanning. Fails if
+// background subtraction is disabled.
+NEO_API void neo_device_relearn_background(neo_device_s device,
+    neo_error_s* error);
+
+// Model, versions and serial number (IV) and current settings (ID)
+NEO_API neo_identity_s neo_device_get_identity(
+    neo_device_s device, neo_error_s* error);
+NEO_API void neo_identity_destruct(neo_identity_s identity);
+
+// Strings live as long as the identity
+NEO_API const char* neo_identity_get_model(neo_identity_s identity);
+NEO_API const char* neo_identity_get_serial_number(neo_identity_s identity);
+NEO_API const char* neo_identity_get_protocol_version(neo_identity_s identity);
+NEO_API const char* neo_identity_get_firmware_version(neo_identity_s identity);
+NEO_API int32_t neo_identity_get_hardware_version(neo_identity_s identity);
+NEO_API int32_t neo_identity_get_bit_rate(neo_identity_s identity);
+NEO_API int32_t neo_identity_get_motor_speed(neo_identity_s identity);
+NEO_API int32_t neo_identity_get_sample_rate(neo_identity_s identity);
+
+// Looks for devices on the USB serial ports of this machine (/dev/ttyUSB*,
+// /dev/ttyACM*, /dev/cu.usbserial*, /dev/cu.usbmodem*,
+// /dev/cu.SLAB_USBtoUART*, COM ports on Windows) without constructing them.
+// All ports are probed at once: a stream still running is stopped (DX) and
+// the unit is asked for its identity (IV, ID); ports that fail or do not
+// answer within `timeout_ms` are left out. The motor is not touched. Ports
+// already open, e.g. by a constructed device in this or another process,
+// are busy and skipped: serial ports are always opened exclusively.
+NEO_API neo_discovery_s neo_discover(int32_t baudrate, int32_t timeout_ms,
+    neo_error_s* error);
+// Probes the `count` given ports instead, e.g. /dev/serial/by-id/... names
+NEO_API neo_discovery_s neo_discover_ports(const char* const* ports,
+    int32_t count, int32_t baudrate, int32_t timeout_ms, neo_error_s* error);
+NEO_API void neo_discovery_destruct(neo_discovery_s discovery);
+
+// Devices found, in port order
+NEO_API int32_t neo_discovery_get_count(neo_discovery_s discovery);
+// Port to construct the device with; lives as long as the discovery
+NEO_API const char* neo_discovery_get_port(neo_discovery_s discovery,
+    int32_t index);
+// Destruct the identity with neo_identity_destruct
+NEO_API neo_identity_s neo_discovery_get_identity(neo_discovery_s discovery,
+    int32_t index, neo_error_s* error);
+
 NEO_API void neo_device_reset(neo_device_s device, neo_error_s* error);
 
 NEO_API void neo_device_calibrate(neo_device_s device, neo_error_s* error);
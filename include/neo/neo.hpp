@@ -6,15 +6,26 @@
  * Automatically handles resource management.
  *
  * neo::neo  - device to interact with
- * neo::scan   - a full scan returned by the device
+ * neo::device_options - construction-time device configuration
+ * neo::scan   - a full scan or sector returned by the device
  * neo::sample - a single sample point
+ * neo::encode, neo::decode - compact binary scan encoding
+ * neo::shm_reader - reads scans a device publishes into shared memory
+ * neo::archive_writer, neo::archive_reader - columnar scan archive files
+ * neo::pose - odometry estimate for a full scan
+ * neo::extract_lines - line segments of a scan
+ * neo::extract_clusters - objects in a scan
+ * neo::track - a moving object followed across scans
  *
  * On error neo::device_error gets thrown.
  */
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "neo.h"
@@ -36,14 +47,178 @@ struct sample {
   // const std::int32_t signal_strength;
 };
 
+struct cluster {
+  float centroid_x;  // cm
+  float centroid_y;
+  float min_x;  // bounding box, cm
+  float min_y;
+  float max_x;
+  float max_y;
+  // Indices into the scan's samples; first_sample > last_sample if the
+  // cluster wraps past 360 degrees
+  std::int32_t first_sample;
+  std::int32_t last_sample;
+  std::int32_t sample_count;
+};
+
+struct track {
+  std::int32_t id;  // same object across scans
+  float x;  // cm
+  float y;
+  float velocity_x;  // cm/s
+  float velocity_y;
+  std::int32_t age;     // scans since the track started
+  std::int32_t misses;  // scans since it last had a cluster
+};
+
 struct scan {
   std::vector<sample> samples;
+  std::int32_t revolution;
+  std::int32_t sector;  // -1 for full scans
+  // Distance per fixed angular bin (see device_options::set_grid), empty
+  // unless enabled; grid_empty where a bin got no returns
+  std::vector<std::int32_t> grid;
+  // Objects (see device_options::set_clusters), empty unless enabled
+  std::vector<cluster> clusters;
+  // Moving objects (see device_options::set_tracking), empty unless enabled
+  std::vector<track> tracks;
+  // Steady clock at completion in microseconds, 0 if unknown
+  std::int64_t timestamp;
+};
+
+struct pose {
+  std::int32_t revolution;
+  float x;        // cm
+  float y;        // cm
+  float heading;  // degrees
+  // Row-major over x, y and heading, of the match against the reference scan
+  float covariance[9];
+  std::int32_t correspondences;  // 0 if the scan was not matched
+};
+
+struct line_segment {
+  float start_x;  // cm
+  float start_y;
+  float end_x;
+  float end_y;
+  std::int32_t first_sample;  // indices into the scan's samples
+  std::int32_t last_sample;
+  float rms;  // cm off the line
+};
+
+struct identity {
+  std::string model;
+  std::string serial_number;
+  std::string protocol_version;
+  std::string firmware_version;
+  std::int32_t hardware_version;
+  std::int32_t bit_rate;
+  std::int32_t motor_speed;
+  std::int32_t sample_rate;
+};
+
+// A device found by discover, not constructed yet
+struct discovered_device {
+  std::string port;  // to construct it with
+  identity device;
+};
+
+enum class queue_policy : std::int32_t {
+  drop_oldest = NEO_QUEUE_DROP_OLDEST,
+  drop_newest = NEO_QUEUE_DROP_NEWEST,
+  block_producer = NEO_QUEUE_BLOCK_PRODUCER,
+  keep_latest = NEO_QUEUE_KEEP_LATEST,
+};
+
+enum class delivery_mode : std::int32_t {
+  queue = NEO_DELIVERY_QUEUE,
+  latest = NEO_DELIVERY_LATEST,
+};
+
+enum class grid_reduction : std::int32_t {
+  min = NEO_GRID_MIN,
+  nearest = NEO_GRID_NEAREST,
+  mean = NEO_GRID_MEAN,
+};
+
+constexpr std::int32_t grid_empty = NEO_GRID_EMPTY;
+
+enum class temporal_filter : std::int32_t {
+  median = NEO_TEMPORAL_MEDIAN,
+  vote = NEO_TEMPORAL_VOTE,
+};
+
+enum class serial_profile : std::int32_t {
+  standard = NEO_SERIAL_PROFILE_STANDARD,
+  low_latency = NEO_SERIAL_PROFILE_LOW_LATENCY,
+  low_cpu = NEO_SERIAL_PROFILE_LOW_CPU,
+};
+
+enum class device_status : std::int32_t {
+  disconnected = NEO_STATUS_DISCONNECTED,
+  reconnected = NEO_STATUS_RECONNECTED,
+};
+
+// Takes a neo_device_status; runs on the acquisition thread
+using status_callback = ::neo_status_callback;
+
+class device_options {
+ public:
+  device_options();
+
+  void set_queue_depth(std::int32_t depth);
+  void set_queue_policy(queue_policy policy);
+  void set_delivery(delivery_mode mode);
+
+  void set_thread_affinity(std::uint64_t cpu_mask);
+  void set_thread_priority(std::int32_t priority);
+  void set_thread_name(const char* name);
+  void set_lock_memory(bool lock);
+
+  void set_serial_profile(serial_profile profile);
+  void set_io_uring(bool enable);
+
+  // Publish full scans into a shared memory ring for shm_reader
+  void set_shm_ring(const char* name, std::int32_t slots);
+  // Append full scans to the archive file at path, see archive_writer
+  void set_archive(const char* path, std::int32_t chunk_scans = 256);
+  // Reopen the port and resume streaming when the link fails
+  void set_reconnect(std::int32_t max_backoff_ms, status_callback callback = nullptr,
+      void* user_data = nullptr);
+  void set_profile_cache(const char* path);
+  void set_grid(std::int32_t bins, grid_reduction reduction = grid_reduction::min);
+  // Needs set_grid
+  void set_temporal_filter(std::int32_t window,
+      temporal_filter mode = temporal_filter::median, std::int32_t tolerance = 10);
+  void set_background(std::int32_t bins, std::int32_t learning_scans,
+      std::int32_t min_change);
+  void set_clusters(std::int32_t max_gap, std::int32_t min_samples);
+  // Needs set_clusters
+  void set_tracking(std::int32_t max_distance, std::int32_t max_misses = 5);
+  void set_odometry(std::int32_t max_distance, std::int32_t keyframe_distance = 0,
+      std::int32_t keyframe_angle = 0);
+  void set_odometry_affinity(std::uint64_t cpu_mask);
+
+ private:
+  friend class neo;
+  std::unique_ptr<::neo_device_options,
+    decltype(&::neo_device_options_destruct)> options;
 };
 
 class neo {
  public:
   explicit neo(const char* port);
   neo(const char* port, std::int32_t baudrate);
+  neo(const char* port, std::int32_t baudrate, const device_options& options);
+
+  std::int64_t get_queue_memory_budget();
+
+  // See device_options::set_reconnect; downtime in microseconds
+  std::int64_t get_reconnects();
+  std::int64_t get_downtime();
+
+  // See device_options::set_profile_cache
+  std::int64_t get_profile_cache_failures();
 
   void start_scanning();
   void stop_scanning();
@@ -54,7 +229,26 @@ class neo {
   std::int32_t get_sample_rate();
   void set_sample_rate(std::int32_t speed);
 
+  void set_target_resolution(float degrees);
+  void set_target_update_rate(std::int32_t hz);
+
   scan get_scan();
+  // Newest scan, empty with revolution -1 if none arrived yet
+  scan get_latest_scan();
+
+  // Polls readable while scans are queued, for event loops; owned by the device
+  std::int32_t get_readiness_fd();
+  // Oldest queued scan, empty with revolution -1 if none is queued
+  scan try_get_scan();
+
+  void set_sector_size(std::int32_t degrees);
+  scan get_sector();
+
+  void relearn_background();
+
+  pose get_pose();
+
+  identity get_identity();
 
   void reset();
 
@@ -64,6 +258,83 @@ class neo {
   std::unique_ptr<::neo_device, decltype(&::neo_device_destruct)> device;
 };
 
+class shm_reader {
+ public:
+  explicit shm_reader(const char* name);
+
+  // Copies the next unread scan into out; false if none arrived within
+  // timeout_ms (-1 waits forever). Scans overwritten mid-read are skipped.
+  bool read(scan& out, std::int32_t timeout_ms = -1);
+
+  std::uint64_t get_sequence();
+  std::uint64_t get_dropped();
+
+ private:
+  std::unique_ptr<::neo_shm_reader, decltype(&::neo_shm_reader_destruct)> reader;
+  // Reused for every read
+  std::unique_ptr<::neo_scan, decltype(&::neo_scan_destruct)> buffer;
+};
+
+class archive_writer {
+ public:
+  explicit archive_writer(const char* path, std::int32_t chunk_scans = 256);
+
+  // Copies the scan; never waits on the disk
+  void append(const scan& scan);
+  // Waits until everything appended is in the file
+  void flush();
+
+  std::uint64_t get_dropped();
+
+ private:
+  std::unique_ptr<::neo_archive_writer, decltype(&::neo_archive_writer_destruct)> writer;
+};
+
+// An archived scan in place inside the reader's mapping
+struct archive_scan {
+  std::int64_t timestamp;  // us since the Unix epoch
+  std::int32_t revolution;
+  std::int32_t count;
+  const float* angles;  // count each, valid while the reader lives
+  const std::int32_t* distances;
+};
+
+class archive_reader {
+ public:
+  explicit archive_reader(const char* path);
+
+  std::int64_t size();
+  // First scan at or after timestamp, size() if none
+  std::int64_t find(std::int64_t timestamp);
+  archive_scan at(std::int64_t index);
+
+ private:
+  std::unique_ptr<::neo_archive_reader, decltype(&::neo_archive_reader_destruct)> reader;
+};
+
+// Compact, platform independent encoding for logging and IPC
+std::vector<std::uint8_t> encode(const scan& scan, bool compress = false);
+scan decode(const std::uint8_t* data, std::size_t size);
+
+// Bins a scan into `bins` equal angular bins starting at 0 degrees
+std::vector<std::int32_t> resample(const scan& scan, std::int32_t bins,
+    grid_reduction reduction = grid_reduction::min);
+
+// Clusters of a scan, see neo_scan_extract_clusters
+std::vector<cluster> extract_clusters(const scan& scan, std::int32_t max_gap,
+    std::int32_t min_samples);
+
+// Line segments of a scan, see neo_scan_extract_lines
+std::vector<line_segment> extract_lines(const scan& scan,
+    std::int32_t max_deviation, std::int32_t max_gap, std::int32_t min_samples);
+
+// Devices on the USB serial ports of this machine or on the given ports,
+// probed concurrently; see neo_discover
+std::vector<discovered_device> discover(std::int32_t baudrate = 115200,
+    std::int32_t timeout_ms = 500);
+std::vector<discovered_device> discover(const std::vector<std::string>& ports,
+    std::int32_t baudrate = 115200, std::int32_t timeout_ms = 500);
+
 // Implementation
 
 namespace detail {
@@ -80,8 +351,243 @@ struct error_to_exception {
 
   ::neo_error_s error = nullptr;
 };
+
+using scan_owner = std::unique_ptr<::neo_scan, decltype(&::neo_scan_destruct)>;
+
+inline std::vector<cluster> to_clusters(::neo_clusters_s releasing) {
+  const std::unique_ptr<::neo_clusters, decltype(&::neo_clusters_destruct)> owner{
+    releasing, &::neo_clusters_destruct};
+
+  const auto count = ::neo_clusters_get_count(owner.get());
+
+  std::vector<cluster> out;
+  out.reserve(count);
+
+  for ( std::int32_t n = 0; n < count; ++n ) {
+    out.push_back({::neo_clusters_get_centroid_x(owner.get(), n),
+        ::neo_clusters_get_centroid_y(owner.get(), n),
+        ::neo_clusters_get_min_x(owner.get(), n),
+        ::neo_clusters_get_min_y(owner.get(), n),
+        ::neo_clusters_get_max_x(owner.get(), n),
+        ::neo_clusters_get_max_y(owner.get(), n),
+        ::neo_clusters_get_first_sample(owner.get(), n),
+        ::neo_clusters_get_last_sample(owner.get(), n),
+        ::neo_clusters_get_sample_count(owner.get(), n)});
+  }
+
+  return out;
+}
+
+inline std::vector<track> to_tracks(::neo_tracks_s releasing) {
+  const std::unique_ptr<::neo_tracks, decltype(&::neo_tracks_destruct)> owner{
+    releasing, &::neo_tracks_destruct};
+
+  const auto count = ::neo_tracks_get_count(owner.get());
+
+  std::vector<track> out;
+  out.reserve(count);
+
+  for ( std::int32_t n = 0; n < count; ++n ) {
+    out.push_back({::neo_tracks_get_id(owner.get(), n),
+        ::neo_tracks_get_x(owner.get(), n),
+        ::neo_tracks_get_y(owner.get(), n),
+        ::neo_tracks_get_velocity_x(owner.get(), n),
+        ::neo_tracks_get_velocity_y(owner.get(), n),
+        ::neo_tracks_get_age(owner.get(), n),
+        ::neo_tracks_get_misses(owner.get(), n)});
+  }
+
+  return out;
+}
+
+inline identity to_identity(::neo_identity_s releasing) {
+  const std::unique_ptr<::neo_identity, decltype(&::neo_identity_destruct)> owner{
+    releasing, &::neo_identity_destruct};
+
+  return {::neo_identity_get_model(owner.get()),
+    ::neo_identity_get_serial_number(owner.get()),
+    ::neo_identity_get_protocol_version(owner.get()),
+    ::neo_identity_get_firmware_version(owner.get()),
+    ::neo_identity_get_hardware_version(owner.get()),
+    ::neo_identity_get_bit_rate(owner.get()),
+    ::neo_identity_get_motor_speed(owner.get()),
+    ::neo_identity_get_sample_rate(owner.get())};
+}
+
+inline std::vector<discovered_device> to_discovered(::neo_discovery_s releasing) {
+  const std::unique_ptr<::neo_discovery, decltype(&::neo_discovery_destruct)> owner{
+    releasing, &::neo_discovery_destruct};
+
+  const auto count = ::neo_discovery_get_count(owner.get());
+
+  std::vector<discovered_device> out;
+  out.reserve(count);
+
+  for ( std::int32_t n = 0; n < count; ++n ) {
+    const auto device = ::neo_discovery_get_identity(owner.get(), n,
+        error_to_exception{});
+
+    out.push_back({::neo_discovery_get_port(owner.get(), n), to_identity(device)});
+  }
+
+  return out;
+}
+
+inline scan copy_scan(::neo_scan_s borrowed) {
+  const auto num_samples = ::neo_scan_get_number_of_samples(borrowed);
+
+  scan result;
+  result.samples.reserve(num_samples);
+  result.revolution = ::neo_scan_get_revolution(borrowed);
+  result.sector = ::neo_scan_get_sector_index(borrowed);
+
+  for ( std::int32_t n = 0; n < num_samples; ++n ) {
+    auto angle = ::neo_scan_get_angle(borrowed, n);
+    auto distance = ::neo_scan_get_distance(borrowed, n);
+    // auto signal = ::neo_scan_get_signal_strength(borrowed, n);
+
+    result.samples.push_back(sample{angle, distance});
+  }
+
+  result.grid.resize(::neo_scan_get_grid_bins(borrowed));
+  ::neo_scan_get_grid(borrowed, result.grid.data(),
+      static_cast<std::int32_t>(result.grid.size()));
+
+  const auto clusters = ::neo_scan_get_clusters(borrowed, error_to_exception{});
+  result.clusters = to_clusters(clusters);
+
+  const auto tracks = ::neo_scan_get_tracks(borrowed, error_to_exception{});
+  result.tracks = to_tracks(tracks);
+
+  result.timestamp = ::neo_scan_get_timestamp(borrowed);
+
+  return result;
+}
+
+inline scan_owner construct_scan(const scan& scan) {
+  std::vector<float> angles;
+  std::vector<std::int32_t> distances;
+  angles.reserve(scan.samples.size());
+  distances.reserve(scan.samples.size());
+
+  for ( const auto& sample : scan.samples ) {
+    angles.push_back(sample.angle);
+    distances.push_back(sample.distance);
+  }
+
+  const auto constructed = ::neo_scan_construct(angles.data(), distances.data(),
+      static_cast<std::int32_t>(scan.samples.size()), scan.revolution,
+      scan.sector, error_to_exception{});
+
+  return scan_owner{constructed, &::neo_scan_destruct};
+}
+
+inline scan to_scan(::neo_scan_s releasing) {
+  const scan_owner releasing_scan{releasing, &::neo_scan_destruct};
+
+  return copy_scan(releasing_scan.get());
+}
 }  // namespace detail
 
+inline device_options::device_options()
+    : options{::neo_device_options_construct(detail::error_to_exception{}),
+      &::neo_device_options_destruct} {}
+
+inline void device_options::set_queue_depth(std::int32_t depth) {
+  ::neo_device_options_set_queue_depth(options.get(), depth);
+}
+
+inline void device_options::set_queue_policy(queue_policy policy) {
+  ::neo_device_options_set_queue_policy(options.get(),
+      static_cast<std::int32_t>(policy));
+}
+
+inline void device_options::set_delivery(delivery_mode mode) {
+  ::neo_device_options_set_delivery(options.get(),
+      static_cast<std::int32_t>(mode));
+}
+
+inline void device_options::set_thread_affinity(std::uint64_t cpu_mask) {
+  ::neo_device_options_set_thread_affinity(options.get(), cpu_mask);
+}
+
+inline void device_options::set_thread_priority(std::int32_t priority) {
+  ::neo_device_options_set_thread_priority(options.get(), priority);
+}
+
+inline void device_options::set_thread_name(const char* name) {
+  ::neo_device_options_set_thread_name(options.get(), name);
+}
+
+inline void device_options::set_lock_memory(bool lock) {
+  ::neo_device_options_set_lock_memory(options.get(), lock);
+}
+
+inline void device_options::set_serial_profile(serial_profile profile) {
+  ::neo_device_options_set_serial_profile(options.get(),
+      static_cast<std::int32_t>(profile));
+}
+
+inline void device_options::set_io_uring(bool enable) {
+  ::neo_device_options_set_io_uring(options.get(), enable);
+}
+
+inline void device_options::set_shm_ring(const char* name, std::int32_t slots) {
+  ::neo_device_options_set_shm_ring(options.get(), name, slots);
+}
+
+inline void device_options::set_archive(const char* path,
+    std::int32_t chunk_scans) {
+  ::neo_device_options_set_archive(options.get(), path, chunk_scans);
+}
+
+inline void device_options::set_reconnect(std::int32_t max_backoff_ms,
+    status_callback callback, void* user_data) {
+  ::neo_device_options_set_reconnect(options.get(), max_backoff_ms, callback,
+      user_data);
+}
+
+inline void device_options::set_grid(std::int32_t bins, grid_reduction reduction) {
+  ::neo_device_options_set_grid(options.get(), bins,
+      static_cast<std::int32_t>(reduction));
+}
+
+inline void device_options::set_temporal_filter(std::int32_t window,
+    temporal_filter mode, std::int32_t tolerance) {
+  ::neo_device_options_set_temporal_filter(options.get(), window,
+      static_cast<std::int32_t>(mode), tolerance);
+}
+
+inline void device_options::set_background(std::int32_t bins,
+    std::int32_t learning_scans, std::int32_t min_change) {
+  ::neo_device_options_set_background(options.get(), bins, learning_scans,
+      min_change);
+}
+
+inline void device_options::set_clusters(std::int32_t max_gap,
+    std::int32_t min_samples) {
+  ::neo_device_options_set_clusters(options.get(), max_gap, min_samples);
+}
+
+inline void device_options::set_tracking(std::int32_t max_distance,
+    std::int32_t max_misses) {
+  ::neo_device_options_set_tracking(options.get(), max_distance, max_misses);
+}
+
+inline void device_options::set_odometry(std::int32_t max_distance,
+    std::int32_t keyframe_distance, std::int32_t keyframe_angle) {
+  ::neo_device_options_set_odometry(options.get(), max_distance,
+      keyframe_distance, keyframe_angle);
+}
+
+inline void device_options::set_odometry_affinity(std::uint64_t cpu_mask) {
+  ::neo_device_options_set_odometry_affinity(options.get(), cpu_mask);
+}
+
+inline void device_options::set_profile_cache(const char* path) {
+  ::neo_device_options_set_profile_cache(options.get(), path);
+}
+
 inline neo::neo(const char* port)
     : device{::neo_device_construct_simple(port, detail::error_to_exception{}),
       &::neo_device_destruct} {}
@@ -90,6 +596,28 @@ inline neo::neo(const char* port, std::int32_t baudrate)
     : device{::neo_device_construct(port, baudrate, detail::error_to_exception{}),
       &::neo_device_destruct} {}
 
+inline neo::neo(const char* port, std::int32_t baudrate,
+    const device_options& options)
+    : device{::neo_device_construct_with_options(port, baudrate,
+        options.options.get(), detail::error_to_exception{}),
+      &::neo_device_destruct} {}
+
+inline std::int64_t neo::get_queue_memory_budget() {
+  return ::neo_device_get_queue_memory_budget(device.get());
+}
+
+inline std::int64_t neo::get_reconnects() {
+  return ::neo_device_get_reconnects(device.get());
+}
+
+inline std::int64_t neo::get_downtime() {
+  return ::neo_device_get_downtime(device.get());
+}
+
+inline std::int64_t neo::get_profile_cache_failures() {
+  return ::neo_device_get_profile_cache_failures(device.get());
+}
+
 inline void neo::start_scanning() { ::neo_device_start_scanning(device.get(),
     detail::error_to_exception{}); }
 
@@ -104,34 +632,247 @@ inline void neo::set_motor_speed(std::int32_t speed) {
   ::neo_device_set_motor_speed(device.get(), speed, detail::error_to_exception{});
 }
 
+inline std::int32_t neo::get_sample_rate() {
+  return ::neo_device_get_sample_rate(device.get(), detail::error_to_exception{});
+}
+
+inline void neo::set_sample_rate(std::int32_t speed) {
+  ::neo_device_set_sample_rate(device.get(), speed, detail::error_to_exception{});
+}
+
+inline void neo::set_target_resolution(float degrees) {
+  ::neo_device_set_target_resolution(device.get(), degrees,
+      detail::error_to_exception{});
+}
+
+inline void neo::set_target_update_rate(std::int32_t hz) {
+  ::neo_device_set_target_update_rate(device.get(), hz,
+      detail::error_to_exception{});
+}
+
 inline scan neo::get_scan() {
-  using scan_owner = std::unique_ptr<::neo_scan, decltype(&::neo_scan_destruct)>;
+  // error_to_exception throws at the end of the statement, before conversion
+  const auto releasing = ::neo_device_get_scan(device.get(),
+      detail::error_to_exception{});
 
-  const scan_owner releasing_scan{
-    ::neo_device_get_scan(device.get(), detail::error_to_exception{}),
-      &::neo_scan_destruct
-  };
+  return detail::to_scan(releasing);
+}
 
-  const auto num_samples = ::neo_scan_get_number_of_samples(releasing_scan.get());
+inline scan neo::get_latest_scan() {
+  const auto borrowed = ::neo_device_get_latest_scan(device.get(),
+      detail::error_to_exception{});
 
-  scan result;
-  result.samples.reserve(num_samples);
+  if ( !borrowed )
+    return scan{{}, -1, -1, {}, {}, {}, 0};
 
-  for ( std::int32_t n = 0; n < num_samples; ++n ) {
-    auto angle = ::neo_scan_get_angle(releasing_scan.get(), n);
-    auto distance = ::neo_scan_get_distance(releasing_scan.get(), n);
-    // auto signal = ::neo_scan_get_signal_strength(releasing_scan.get(), n);
+  return detail::copy_scan(borrowed);
+}
 
-    result.samples.push_back(sample{angle, distance});
-  }
+inline std::int32_t neo::get_readiness_fd() {
+  return ::neo_device_get_readiness_fd(device.get(), detail::error_to_exception{});
+}
 
-  return result;
+inline scan neo::try_get_scan() {
+  const auto releasing = ::neo_device_try_get_scan(device.get(),
+      detail::error_to_exception{});
+
+  if ( !releasing )
+    return scan{{}, -1, -1, {}, {}, {}, 0};
+
+  return detail::to_scan(releasing);
+}
+
+inline void neo::set_sector_size(std::int32_t degrees) {
+  ::neo_device_set_sector_size(device.get(), degrees, detail::error_to_exception{});
+}
+
+inline scan neo::get_sector() {
+  const auto releasing = ::neo_device_get_sector(device.get(),
+      detail::error_to_exception{});
+
+  return detail::to_scan(releasing);
+}
+
+inline void neo::relearn_background() {
+  ::neo_device_relearn_background(device.get(), detail::error_to_exception{});
+}
+
+inline pose neo::get_pose() {
+  std::unique_ptr<::neo_pose, decltype(&::neo_pose_destruct)> out{
+    ::neo_device_get_pose(device.get(), detail::error_to_exception{}),
+    &::neo_pose_destruct};
+
+  pose ret{::neo_pose_get_revolution(out.get()), ::neo_pose_get_x(out.get()),
+    ::neo_pose_get_y(out.get()), ::neo_pose_get_heading(out.get()), {},
+    ::neo_pose_get_correspondences(out.get())};
+  ::neo_pose_get_covariance(out.get(), ret.covariance);
+
+  return ret;
+}
+
+inline identity neo::get_identity() {
+  const auto out = ::neo_device_get_identity(device.get(),
+      detail::error_to_exception{});
+
+  return detail::to_identity(out);
 }
 
 inline void neo::reset() { ::neo_device_reset(device.get(), detail::error_to_exception{}); }
 inline void neo::calibrate() { ::neo_device_calibrate(device.get(),
     detail::error_to_exception{}); }
 
+inline shm_reader::shm_reader(const char* name)
+    : reader{::neo_shm_reader_construct(name, detail::error_to_exception{}),
+      &::neo_shm_reader_destruct},
+      buffer{::neo_scan_construct(nullptr, nullptr, 0, 0, -1,
+          detail::error_to_exception{}), &::neo_scan_destruct} {}
+
+inline bool shm_reader::read(scan& out, std::int32_t timeout_ms) {
+  if ( !::neo_shm_reader_read(reader.get(), buffer.get(), timeout_ms,
+        detail::error_to_exception{}) )
+    return false;
+
+  out = detail::copy_scan(buffer.get());
+  return true;
+}
+
+inline std::uint64_t shm_reader::get_sequence() {
+  return ::neo_shm_reader_get_sequence(reader.get());
+}
+
+inline std::uint64_t shm_reader::get_dropped() {
+  return ::neo_shm_reader_get_dropped(reader.get());
+}
+
+inline archive_writer::archive_writer(const char* path, std::int32_t chunk_scans)
+    : writer{::neo_archive_writer_construct(path, chunk_scans,
+        detail::error_to_exception{}), &::neo_archive_writer_destruct} {}
+
+inline void archive_writer::append(const scan& scan) {
+  const auto owner = detail::construct_scan(scan);
+  ::neo_scan_set_timestamp(owner.get(), scan.timestamp);
+
+  ::neo_archive_writer_append(writer.get(), owner.get(),
+      detail::error_to_exception{});
+}
+
+inline void archive_writer::flush() {
+  ::neo_archive_writer_flush(writer.get(), detail::error_to_exception{});
+}
+
+inline std::uint64_t archive_writer::get_dropped() {
+  return ::neo_archive_writer_get_dropped(writer.get());
+}
+
+inline archive_reader::archive_reader(const char* path)
+    : reader{::neo_archive_reader_construct(path, detail::error_to_exception{}),
+      &::neo_archive_reader_destruct} {}
+
+inline std::int64_t archive_reader::size() {
+  return ::neo_archive_reader_get_count(reader.get());
+}
+
+inline std::int64_t archive_reader::find(std::int64_t timestamp) {
+  return ::neo_archive_reader_find(reader.get(), timestamp);
+}
+
+inline archive_scan archive_reader::at(std::int64_t index) {
+  return {::neo_archive_reader_get_timestamp(reader.get(), index),
+    ::neo_archive_reader_get_revolution(reader.get(), index),
+    ::neo_archive_reader_get_number_of_samples(reader.get(), index),
+    ::neo_archive_reader_get_angles(reader.get(), index),
+    ::neo_archive_reader_get_distances(reader.get(), index)};
+}
+
+inline std::vector<std::uint8_t> encode(const scan& scan, bool compress) {
+  const auto owner = detail::construct_scan(scan);
+
+  std::vector<std::uint8_t> out(::neo_scan_encode_bound(owner.get()));
+  const auto size = ::neo_scan_encode(owner.get(),
+      compress ? NEO_ENCODE_COMPRESS : 0, out.data(),
+      static_cast<std::int32_t>(out.size()), detail::error_to_exception{});
+  out.resize(size);
+
+  return out;
+}
+
+inline scan decode(const std::uint8_t* data, std::size_t size) {
+  const auto releasing = ::neo_scan_decode(data,
+      static_cast<std::int32_t>(size), detail::error_to_exception{});
+
+  return detail::to_scan(releasing);
+}
+
+inline std::vector<std::int32_t> resample(const scan& scan, std::int32_t bins,
+    grid_reduction reduction) {
+  const auto owner = detail::construct_scan(scan);
+
+  std::vector<std::int32_t> out(bins);
+  ::neo_scan_resample(owner.get(), bins, static_cast<std::int32_t>(reduction),
+      out.data(), detail::error_to_exception{});
+
+  return out;
+}
+
+inline std::vector<cluster> extract_clusters(const scan& scan,
+    std::int32_t max_gap, std::int32_t min_samples) {
+  const auto owner = detail::construct_scan(scan);
+
+  const auto clusters = ::neo_scan_extract_clusters(owner.get(), max_gap,
+      min_samples, detail::error_to_exception{});
+
+  return detail::to_clusters(clusters);
+}
+
+inline std::vector<line_segment> extract_lines(const scan& scan,
+    std::int32_t max_deviation, std::int32_t max_gap, std::int32_t min_samples) {
+  const auto owner = detail::construct_scan(scan);
+
+  std::unique_ptr<::neo_lines, decltype(&::neo_lines_destruct)> lines{
+    ::neo_scan_extract_lines(owner.get(), max_deviation, max_gap, min_samples,
+        detail::error_to_exception{}), &::neo_lines_destruct};
+
+  const auto count = ::neo_lines_get_count(lines.get());
+
+  std::vector<line_segment> out;
+  out.reserve(count);
+
+  for ( std::int32_t n = 0; n < count; ++n ) {
+    out.push_back({::neo_lines_get_start_x(lines.get(), n),
+        ::neo_lines_get_start_y(lines.get(), n),
+        ::neo_lines_get_end_x(lines.get(), n),
+        ::neo_lines_get_end_y(lines.get(), n),
+        ::neo_lines_get_first_sample(lines.get(), n),
+        ::neo_lines_get_last_sample(lines.get(), n),
+        ::neo_lines_get_rms(lines.get(), n)});
+  }
+
+  return out;
+}
+
+inline std::vector<discovered_device> discover(std::int32_t baudrate,
+    std::int32_t timeout_ms) {
+  const auto discovery = ::neo_discover(baudrate, timeout_ms,
+      detail::error_to_exception{});
+
+  return detail::to_discovered(discovery);
+}
+
+inline std::vector<discovered_device> discover(const std::vector<std::string>& ports,
+    std::int32_t baudrate, std::int32_t timeout_ms) {
+  std::vector<const char*> names;
+  names.reserve(ports.size());
+
+  for ( const auto& port : ports )
+    names.push_back(port.c_str());
+
+  const auto discovery = ::neo_discover_ports(names.data(),
+      static_cast<std::int32_t>(names.size()), baudrate, timeout_ms,
+      detail::error_to_exception{});
+
+  return detail::to_discovered(discovery);
+}
+
 }  // namespace neo
 
 #endif  // _NEO_HPP_
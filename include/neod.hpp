@@ -0,0 +1,74 @@
+#ifndef _NEOD_HPP_
+#define _NEOD_HPP_
+
+/*
+ * Wire protocol between the neod scan daemon and neo:// devices.
+ * Implementation detail; not exported.
+ *
+ * A stream of frames: a little-endian uint32 payload length, a type byte
+ * and the payload. Integers in payloads are little-endian as well.
+ *
+ *   client                          neod
+ *   hello     version, device name  ->
+ *                                   <- welcome  version, motor speed, sector size
+ *   subscribe streams, decimation   ->
+ *                                   <- scan     codec encoded scan (repeated)
+ *                                   <- error    message, then the connection closes
+ *
+ * Scans are in the codec format (see codec.hpp); sectors carry their index.
+ */
+
+#include <stdint.h>
+
+namespace neo {
+namespace neod {
+
+constexpr uint8_t version = 1;
+
+constexpr uint32_t header_size = 5;
+constexpr uint32_t max_payload = 1 << 20;
+
+enum class frame : uint8_t {
+  hello = 1,
+  welcome = 2,
+  subscribe = 3,
+  scan = 4,
+  error = 5,
+};
+
+// Bits of the subscribe frame's streams byte
+enum streams : uint8_t {
+  full_scans = 1 << 0,
+  sectors = 1 << 1,
+};
+
+inline void put_u16(uint8_t* to, uint16_t v) {
+  to[0] = static_cast<uint8_t>(v);
+  to[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void put_u32(uint8_t* to, uint32_t v) {
+  for ( int32_t n = 0; n < 4; ++n )
+    to[n] = static_cast<uint8_t>(v >> (8 * n));
+}
+
+inline uint16_t get_u16(const uint8_t* from) {
+  return static_cast<uint16_t>(from[0] | (from[1] << 8));
+}
+
+inline uint32_t get_u32(const uint8_t* from) {
+  uint32_t v = 0;
+  for ( int32_t n = 0; n < 4; ++n )
+    v |= static_cast<uint32_t>(from[n]) << (8 * n);
+  return v;
+}
+
+inline void put_header(uint8_t* to, frame type, uint32_t length) {
+  put_u32(to, length);
+  to[4] = static_cast<uint8_t>(type);
+}
+
+}  // namespace neod
+}  // namespace neo
+
+#endif  // _NEOD_HPP_
@@ -0,0 +1,115 @@
+#ifndef _ODOMETRY_HPP_
+#define _ODOMETRY_HPP_
+
+/*
+ * Scan-to-scan matching for 2D lidar odometry.
+ * Implementation detail; not exported.
+ *
+ * Every full scan is registered against a reference scan with point-to-line
+ * ICP: correspondences come from a hashed grid over the reference points,
+ * the normal equations are accumulated over structure-of-arrays buffers in
+ * fixed-width lanes the compiler vectorizes. The reference is the previous
+ * scan, or a keyframe that is only replaced once the sensor moved far
+ * enough from it, which keeps drift down while standing still.
+ *
+ * Points are (distance cos angle, distance sin angle) in cm; poses are in
+ * the frame of the first scan, headings in degrees in the device's angle
+ * direction.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace odometry {
+
+struct settings {
+  float max_distance;       // cm, correspondence gate
+  // A new keyframe once moved or turned this far from the last one, 0 never;
+  // both 0 matches every scan against the previous one
+  float keyframe_distance;  // cm
+  float keyframe_angle;     // degrees
+};
+
+struct estimate {
+  int32_t revolution;
+  float x;        // cm
+  float y;        // cm
+  float heading;  // degrees
+  // Of the registration against the reference scan, row-major over x, y
+  // and heading (cm^2, cm degrees, degrees^2); zero without a registration
+  float covariance[9];
+  int32_t correspondences;  // 0 for the first scan or a failed registration
+};
+
+class matcher {
+ public:
+  explicit matcher(const settings& config);
+
+  // Registers a full scan and returns its pose
+  estimate add(const sample* samples, int32_t count, int32_t revolution);
+
+ private:
+  struct pose {
+    double x;
+    double y;
+    double theta;  // radians
+  };
+
+  // a followed by b, with b expressed in a's frame
+  static pose compose(const pose& a, const pose& b);
+  static pose inverse(const pose& a);
+
+  // Points of the scan in structure-of-arrays form
+  struct cloud {
+    std::vector<float> x;
+    std::vector<float> y;
+  };
+
+  static void to_cloud(const sample* samples, int32_t count, cloud& out);
+
+  // Makes the scan in current the reference and indexes it
+  void set_reference();
+
+  // Index of the reference point closest to (x, y) within max_distance, -1
+  // if none or it has no normal
+  int32_t closest(float x, float y) const;
+
+  // Point-to-line ICP of current against the reference starting at guess;
+  // false if the registration is not constrained
+  bool register_current(pose& guess, float* covariance, int32_t& matched);
+
+  settings config;
+
+  cloud current;
+  cloud reference;
+  std::vector<float> normal_x;  // per reference point, 0 0 if undefined
+  std::vector<float> normal_y;
+
+  // Hashed grid of max_distance cells over the reference points: the points
+  // of bucket b are order[start[b]] .. order[start[b + 1] - 1]
+  std::vector<int32_t> start;
+  std::vector<int32_t> order;
+  uint32_t bucket_mask;
+
+  // Gathered correspondences, reused across iterations
+  std::vector<float> pair_x;   // transformed current point
+  std::vector<float> pair_y;
+  std::vector<float> pair_nx;  // reference line normal
+  std::vector<float> pair_ny;
+  std::vector<float> pair_d;   // reference line offset, n . q
+
+  bool has_reference;
+  pose keyframe;  // in the first scan's frame
+  pose relative;  // last scan relative to the keyframe
+  pose motion;    // between the last two scans, predicts the next one
+};
+
+}  // namespace odometry
+}  // namespace neo
+
+#endif  // _ODOMETRY_HPP_
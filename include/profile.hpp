@@ -0,0 +1,56 @@
+#ifndef _PROFILE_HPP_
+#define _PROFILE_HPP_
+
+/*
+ * Cache of per-unit bring-up state, keyed by serial number.
+ * Implementation detail; not exported.
+ *
+ * A text file with one line per unit:
+ *
+ *   # neo device profiles v1
+ *   <serial number> <baud rate> <motor speed> <calibrated at, unix time>
+ *
+ * It only spares waits: lines that do not parse are skipped, and a unit
+ * without a matching line goes through the full bring-up.
+ */
+
+#include <stdint.h>
+
+#include <string>
+
+#include "neo.h"
+
+namespace neo {
+namespace profile {
+
+struct profile {
+  std::string serial_number;  // empty while the cache is disabled
+  int32_t baudrate;
+  int32_t motor_speed;
+  int64_t calibrated_at;      // 0 if never calibrated
+};
+
+// Looks up the unit's line; false if the file or the line is missing
+bool load(const char* path, const std::string& serial_number, profile& out);
+
+// Replaces the unit's line, keeping all others; false if writing failed.
+// Safe against other processes and devices updating the same file.
+bool store(const char* path, const profile& in);
+
+// Platform layer
+
+// Exclusive advisory lock serialising read-modify-write updates of path.
+// Taken on a "<path>.lock" sibling, since replace() swaps the file itself.
+typedef struct update_lock* update_lock_s;
+
+update_lock_s lock_for_update(const char* path);  // nullptr if not lockable
+void unlock_for_update(update_lock_s lock);
+
+// Writes contents to a uniquely named temporary next to path and renames it
+// over path in one step; false if any of it failed.
+bool replace(const char* path, const std::string& contents);
+
+}  // namespace profile
+}  // namespace neo
+
+#endif  // _PROFILE_HPP_
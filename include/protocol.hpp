@@ -9,7 +9,7 @@
 #include <stdint.h>
 
 #include "error.hpp"
-#include "serial.hpp"
+#include "transport.hpp"
 #include "neo.h"
 
 namespace neo {
@@ -26,8 +26,8 @@ constexpr uint8_t DATA_ACQUISITION_START[2] = {'D', 'S'};
 constexpr uint8_t DATA_ACQUISITION_STOP[2]  = {'D', 'X'};
 constexpr uint8_t MOTOR_SPEED_ADJUST[2]     = {'M', 'S'};
 constexpr uint8_t MOTOR_INFORMATION[2]      = {'M', 'I'};
-// constexpr uint8_t SAMPLE_RATE_ADJUST[2]     = {'L', 'R'};
-// constexpr uint8_t SAMPLE_RATE_INFORMATION[2]= {'L', 'I'};
+constexpr uint8_t SAMPLE_RATE_ADJUST[2]     = {'L', 'R'};
+constexpr uint8_t SAMPLE_RATE_INFORMATION[2]= {'L', 'I'};
 constexpr uint8_t VERSION_INFORMATION[2]    = {'I', 'V'};
 constexpr uint8_t DEVICE_INFORMATION[2]     = {'I', 'D'};
 constexpr uint8_t RESET_DEVICE[2]           = {'R', 'R'};
@@ -155,25 +155,47 @@ struct response_info_motor_s {
 static_assert(sizeof(response_info_motor_s) == 5,
     "response info motor size mismatch.");
 
+struct response_info_sample_rate_s {
+  uint8_t cmdByte1;
+  uint8_t cmdByte2;
+  uint8_t sample_rate[2];
+  uint8_t term;
+};
+
+static_assert(sizeof(response_info_sample_rate_s) == 5,
+    "response info sample rate size mismatch.");
+
 // Done with in-memory representations for packets we send over the wire.
 #pragma pack(pop)
 
 // Read and write specific packets
 
-void write_command(neo::serial::device_s serial, const uint8_t cmd[2]);
+void write_command(neo::transport::transport_s transport, const uint8_t cmd[2]);
 
-void write_command_with_arguments(neo::serial::device_s serial,
+void write_command_with_arguments(neo::transport::transport_s transport,
     const uint8_t cmd[2], const uint8_t arg[2]);
 
-response_header_s read_response_header(neo::serial::device_s serial,
+response_header_s read_response_header(neo::transport::transport_s transport,
     const uint8_t cmd[2]);
 
-response_param_s read_response_param(neo::serial::device_s serial,
+response_param_s read_response_param(neo::transport::transport_s transport,
     const uint8_t cmd[2]);
 
-response_scan_packet_s read_response_scan(neo::serial::device_s serial);
+response_scan_packet_s read_response_scan(neo::transport::transport_s transport);
+
+response_info_motor_s read_response_info_motor(neo::transport::transport_s transport);
+
+response_info_sample_rate_s read_response_info_sample_rate(
+    neo::transport::transport_s transport);
+
+response_info_device_s read_response_info_device(
+    neo::transport::transport_s transport);
+
+response_info_version_s read_response_info_version(
+    neo::transport::transport_s transport);
 
-response_info_motor_s read_response_info_motor(neo::serial::device_s serial);
+// Decimal ASCII field of a response; throws on anything but digits
+int32_t ascii_field_to_integral(const uint8_t* bytes, int32_t len);
 
 inline void integral_to_ascii_bytes(const int32_t integral, uint8_t bytes[2]) {
   NEO_ASSERT(integral >= 0);
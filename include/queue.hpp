@@ -14,30 +14,97 @@
 #include <queue>
 #include <utility>
 
+#include "event.hpp"
+
 namespace neo {
 namespace queue {
 
+// What enqueue does when the queue is full
+enum class policy {
+  drop_oldest,     // remove the oldest element to make room
+  drop_newest,     // discard the element being enqueued
+  block_producer,  // wait until a consumer made room
+  keep_latest,     // hold at most the single most recent element
+};
+
 template <typename T> class queue {
  public:
-  queue(int32_t max) : max_size(max) {}
+  queue(int32_t max, policy p = policy::drop_oldest)
+      : max_size(p == policy::keep_latest ? 1 : max), the_policy(p) {}
 
-  // Empty the queue
+  // Maximum number of elements held at any time
+  int32_t capacity() const { return max_size; }
+
+  // Empty the queue and re-arm it after cancel()
   void clear() {
     std::unique_lock<std::mutex> lock(the_mutex);
     while (!the_queue.empty()) {
       the_queue.pop();
     }
+    cancelled = false;
+    if (readiness)
+      event::flag_clear(readiness);
+    the_not_full_var.notify_all();
+  }
+
+  // Keep the flag set exactly while elements are queued; not owned
+  void set_readiness(event::flag_s flag) {
+    std::lock_guard<std::mutex> lock(the_mutex);
+    readiness = flag;
+    if (!the_queue.empty())
+      event::flag_set(readiness);
+  }
+
+  // Release a producer blocked on a full queue; its element gets dropped.
+  void cancel() {
+    std::lock_guard<std::mutex> lock(the_mutex);
+    cancelled = true;
+    the_not_full_var.notify_all();
   }
 
   // Add an element to the queue.
   void enqueue(T v) {
-    std::lock_guard<std::mutex> lock(the_mutex);
+    std::unique_lock<std::mutex> lock(the_mutex);
 
-    // if necessary, remove the oldest scan to make room for new
-    if (static_cast<int32_t>(the_queue.size()) >= max_size)
+    if (static_cast<int32_t>(the_queue.size()) >= max_size) {
+      switch (the_policy) {
+      case policy::drop_oldest:
+      case policy::keep_latest:
+        // remove the oldest scan to make room for new
+        the_queue.pop();
+        break;
+      case policy::drop_newest:
+        return;
+      case policy::block_producer:
+        while (!cancelled && static_cast<int32_t>(the_queue.size()) >= max_size)
+          the_not_full_var.wait(lock);
+        if (cancelled)
+          return;
+        break;
+      }
+    }
+
+    the_queue.push(std::move(v));
+    if (readiness)
+      event::flag_set(readiness);
+    the_cond_var.notify_one();
+  }
+
+  // Add a final element (an error, the end of the stream) past the
+  // policy: it is never dropped and never waits, even after cancel(). If
+  // the queue is full it makes room by removing the oldest element, except
+  // under block_producer, which loses nothing: there it goes in one past
+  // the capacity.
+  void enqueue_final(T v) {
+    std::unique_lock<std::mutex> lock(the_mutex);
+
+    if (static_cast<int32_t>(the_queue.size()) >= max_size
+        && the_policy != policy::block_producer)
       the_queue.pop();
 
     the_queue.push(std::move(v));
+    if (readiness)
+      event::flag_set(readiness);
     the_cond_var.notify_one();
   }
 
@@ -55,14 +122,34 @@ template <typename T> class queue {
     }
     auto v = std::move(the_queue.front());
     the_queue.pop();
+    if (readiness && the_queue.empty())
+      event::flag_clear(readiness);
+    the_not_full_var.notify_one();
     return v;
   }
 
+  // Take the oldest element if there is one, never waiting.
+  bool try_dequeue(T& out) {
+    std::lock_guard<std::mutex> lock(the_mutex);
+    if (the_queue.empty())
+      return false;
+    out = std::move(the_queue.front());
+    the_queue.pop();
+    if (readiness && the_queue.empty())
+      event::flag_clear(readiness);
+    the_not_full_var.notify_one();
+    return true;
+  }
+
  private:
   int32_t max_size;
+  policy the_policy;
+  bool cancelled = false;
+  event::flag_s readiness = nullptr;
   std::queue<T> the_queue;
   mutable std::mutex the_mutex;
   mutable std::condition_variable the_cond_var;
+  mutable std::condition_variable the_not_full_var;
 };
 
 }  // namespace queue
@@ -0,0 +1,74 @@
+#ifndef _REMOTE_HPP_
+#define _REMOTE_HPP_
+
+/*
+ * Client side of neo:// devices served by the neod daemon.
+ * Implementation detail; not exported.
+ *
+ * Port strings name the daemon's socket and optionally a device and a
+ * decimation of the revolutions to receive:
+ *
+ *   neo:///run/neod.sock               Unix-domain socket
+ *   neo://127.0.0.1:7001?device=front  TCP, device by name
+ *   neo:///run/neod.sock?decimate=2    every second revolution
+ */
+
+#include <stdint.h>
+
+#include <string>
+
+#include "error.hpp"
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace remote {
+
+using connection_s = struct connection*;
+
+struct error : neo::error::error {
+  using base = neo::error::error;
+  using base::base;
+};
+
+// Thrown by connection_read after connection_interrupt was called.
+struct interrupted : error {
+  using base = error;
+  using base::base;
+};
+
+struct endpoint {
+  std::string path;  // Unix-domain socket, or empty for TCP
+  std::string host;
+  std::string port;
+  std::string device;  // empty: the daemon's first device
+  int32_t decimate;    // only revolutions divisible by this
+};
+
+// What the daemon reports about the device it serves
+struct info {
+  int32_t motor_speed;
+  int32_t sector_size;  // 0 if the daemon does not stream sectors
+};
+
+bool is_remote(const char* port);
+endpoint parse(const char* port);
+
+// Connects and greets the daemon; throws if it does not know the device.
+connection_s connection_construct(const endpoint& to, info& out);
+void connection_destruct(connection_s connection);
+
+void connection_subscribe(connection_s connection, bool sectors,
+    int32_t decimate);
+
+// Blocks for the next scan or sector. Errors the daemon reports for the
+// device are thrown as remote::error.
+void connection_read(connection_s connection, neo_scan& out);
+
+// Wakes up a thread blocked in connection_read; safe to call from any thread.
+void connection_interrupt(connection_s connection);
+
+}  // namespace remote
+}  // namespace neo
+
+#endif  // _REMOTE_HPP_
@@ -0,0 +1,59 @@
+#ifndef _SCAN_HPP_
+#define _SCAN_HPP_
+
+/*
+ * In-memory scan representation shared by the sub-systems.
+ * Implementation detail; not exported.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "neo.h"
+
+#define NEO_MAX_SAMPLES 4096
+
+struct sample {
+  float angle;             // in degrees
+  int32_t distance;        // in cm
+  // int32_t signal_strength[NEO_MAX_SAMPLES]; // range 0:255
+};
+
+struct cluster {
+  float centroid_x;  // cm
+  float centroid_y;
+  float min_x;       // bounding box, cm
+  float min_y;
+  float max_x;
+  float max_y;
+  int32_t first;     // sample indices, inclusive; first > last if the
+  int32_t last;      // cluster wraps past 360 degrees
+  int32_t count;     // samples
+};
+
+struct track {
+  int32_t id;          // unique within a scanning session
+  float x;             // filtered position, cm
+  float y;
+  float velocity_x;    // cm/s
+  float velocity_y;
+  int32_t age;         // scans since the track started
+  int32_t misses;      // consecutive scans without a matching cluster
+};
+
+struct neo_scan {
+  sample samples[NEO_MAX_SAMPLES];
+  int32_t count;
+  int32_t revolution;  // full revolutions since scanning started
+  int32_t sector;      // sector index, -1 for a full scan
+  int64_t timestamp;   // steady clock at completion in us, 0 if unknown
+
+  // Derived during assembly, each empty unless its stage is enabled; only
+  // then do they allocate
+  std::vector<int32_t> grid;      // distance per bin, see grid.hpp
+  std::vector<cluster> clusters;  // at most NEO_MAX_CLUSTERS, see clusters.hpp
+  std::vector<track> tracks;      // at most NEO_MAX_TRACKS, see tracking.hpp
+};
+
+#endif  // _SCAN_HPP_
@@ -11,6 +11,10 @@
 
 #include <stdint.h>
 
+#include <chrono>
+#include <string>
+#include <vector>
+
 namespace neo {
 namespace serial {
 
@@ -22,13 +26,54 @@ struct error : neo::error::error {
   using base::base;
 };
 
-device_s device_construct(const char* port, int32_t baudrate);
+// Thrown by device_read after device_interrupt was called. The interrupt is
+// sticky: every further read throws until device_flush clears it.
+struct interrupted : error {
+  using base = error;
+  using base::base;
+};
+
+// Thrown by device_read waiting past the deadline from device_set_deadline.
+struct timed_out : error {
+  using base = error;
+  using base::base;
+};
+
+using deadline = std::chrono::steady_clock::time_point;
+
+// Trade-off between reaction time and wakeups per received byte
+enum class profile {
+  standard,     // wake up on the first byte, driver defaults otherwise
+  low_latency,  // additionally ask the driver to skip its latency timer
+  low_cpu,      // batch wakeups: wait for ~10 ms worth of bytes (VMIN)
+};
+
+struct config {
+  profile latency_profile;
+  bool io_uring;  // read through io_uring where available, else select()
+};
+
+device_s device_construct(const char* port, int32_t baudrate,
+    const config& cfg);
 void device_destruct(device_s serial);
 
 void device_read(device_s serial, void* to, int32_t len);
 void device_write(device_s serial, const void* from, int32_t len);
 void device_flush(device_s serial);
 
+// Wakes up a thread blocked in device_read; safe to call from any thread.
+void device_interrupt(device_s serial);
+
+// Bounds how long device_read waits for bytes; deadline::max(), the
+// initial value, waits forever.
+void device_set_deadline(device_s serial, deadline until);
+
+// Descriptor of the port for polling, -1 where there is none
+int32_t device_fd(device_s serial);
+
+// Serial ports of USB adapters present on this machine, in name order
+std::vector<std::string> list_ports();
+
 }  // namespace serial
 }  // namespace neo
 
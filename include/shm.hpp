@@ -0,0 +1,76 @@
+#ifndef _SHM_HPP_
+#define _SHM_HPP_
+
+/*
+ * Shared-memory scan ring for local multi-process consumers.
+ * Implementation detail; not exported.
+ *
+ * One publisher process writes completed scans into a named shared memory
+ * segment holding a header and a ring of slots; any number of readers map
+ * it read-only and borrow or copy the scans from there. Every slot is a
+ * seqlock: its sequence word is odd while the publisher writes and otherwise
+ * holds the number of the scan stored in it, so readers never lock and can
+ * tell afterwards whether the publisher lapped them mid-read.
+ */
+
+#include <stdint.h>
+
+#include "error.hpp"
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace shm {
+
+using publisher_s = struct publisher*;
+using reader_s = struct reader*;
+
+struct error : neo::error::error {
+  using base = neo::error::error;
+  using base::base;
+};
+
+// What a slot holds: the samples of a scan, none of its derived data
+struct frame {
+  int32_t count;
+  int32_t revolution;
+  int32_t sector;
+  int64_t timestamp;
+  sample samples[NEO_MAX_SAMPLES];
+};
+
+// Creates the segment `name` (e.g. "/neo-scans"), replacing a stale one
+// left by a publisher that is gone; throws if a running one holds it.
+publisher_s publisher_construct(const char* name, int32_t slots);
+// Marks the ring closed for readers and removes the name.
+void publisher_destruct(publisher_s publisher);
+
+// The timestamp is on the steady clock, which all processes share.
+void publisher_publish(publisher_s publisher, const sample* samples,
+    int32_t count, int32_t revolution, int32_t sector, int64_t timestamp);
+
+// Readers start with the newest scan published when they attach.
+reader_s reader_construct(const char* name);
+void reader_destruct(reader_s reader);
+
+// Borrows the next unread scan from the ring; nullptr if none arrives
+// within timeout_ms (0 polls, negative waits forever). Readers falling
+// more than a ring behind skip ahead and count the scans as dropped.
+// Throws once the publisher has closed the ring.
+const frame* reader_acquire(reader_s reader, int32_t timeout_ms);
+// Ends the borrow; false if the publisher overwrote the scan meanwhile, in
+// which case whatever was read from it must be discarded.
+bool reader_release(reader_s reader);
+
+// Copies the next unread scan into out under the seqlock, skipping and
+// counting as dropped scans the publisher overwrote mid-copy; false if none
+// arrives within timeout_ms.
+bool reader_read(reader_s reader, int32_t timeout_ms, neo_scan& out);
+
+uint64_t reader_sequence(reader_s reader);  // number of the last borrowed scan
+uint64_t reader_dropped(reader_s reader);
+
+}  // namespace shm
+}  // namespace neo
+
+#endif  // _SHM_HPP_
@@ -0,0 +1,53 @@
+#ifndef _TEMPORAL_HPP_
+#define _TEMPORAL_HPP_
+
+/*
+ * Temporal filtering of binned full scans.
+ * Implementation detail; not exported.
+ *
+ * Keeps the distances of every grid bin (see grid.hpp) over the last
+ * `window` scans, both in arrival order and sorted. A new scan replaces
+ * each bin's oldest distance in place, so an update costs a shift within
+ * one bounded window per bin regardless of history. Empty bins take part
+ * as NEO_GRID_EMPTY, below every distance: a bin empty in most scans
+ * stays empty.
+ *
+ * Median: a bin's distance is the (lower) median of its window.
+ * Vote: a bin keeps its newest distance if a majority of its window lies
+ * within the tolerance of it, otherwise it becomes empty.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "neo.h"
+
+namespace neo {
+namespace temporal {
+
+class filter {
+ public:
+  // window in [1, NEO_MAX_TEMPORAL_WINDOW], mode one of neo_temporal_filter
+  filter(int32_t bins, int32_t window, int32_t mode, int32_t tolerance);
+
+  // Adds a scan's grid to the window and replaces it by the filtered one
+  void apply(int32_t* ranges);
+
+ private:
+  int32_t bins;
+  int32_t window;
+  int32_t mode;
+  int32_t tolerance;  // cm, vote only
+
+  // Per bin `window` consecutive distances, valid up to `filled`
+  std::vector<int32_t> history;  // ring, the oldest at `oldest`
+  std::vector<int32_t> sorted;
+  int32_t filled;
+  int32_t oldest;
+};
+
+}  // namespace temporal
+}  // namespace neo
+
+#endif  // _TEMPORAL_HPP_
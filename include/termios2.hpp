@@ -0,0 +1,29 @@
+#ifndef _TERMIOS2_HPP_
+#define _TERMIOS2_HPP_
+
+/*
+ * Linux-only tty controls beyond POSIX termios.
+ * Implementation detail; not exported.
+ *
+ * Lives in its own translation unit since <asm/termbits.h> clashes with
+ * the <termios.h> used by the rest of the serial implementation.
+ */
+
+#include <stdint.h>
+
+namespace neo {
+namespace serial {
+namespace termios2 {
+
+// Sets an arbitrary baud rate through termios2 and BOTHER.
+bool set_custom_baudrate(int32_t fd, int32_t baudrate);
+
+// Toggles ASYNC_LOW_LATENCY; drivers like ftdi_sio then skip their
+// latency timer instead of batching input for up to 16 ms.
+bool set_low_latency(int32_t fd, bool enable);
+
+}  // namespace termios2
+}  // namespace serial
+}  // namespace neo
+
+#endif  // _TERMIOS2_HPP_
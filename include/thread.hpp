@@ -0,0 +1,36 @@
+#ifndef _THREAD_HPP_
+#define _THREAD_HPP_
+
+/*
+ * Scheduling controls for the calling thread.
+ * Implementation detail; not exported.
+ *
+ * All functions are best effort: they return false when the platform does
+ * not support the request or the process lacks the permission for it.
+ */
+
+#include "neo.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace neo {
+namespace thread {
+
+// Pins the calling thread to the CPUs set in mask (bit n is CPU n).
+bool set_affinity(uint64_t cpu_mask);
+
+// Switches the calling thread to real-time FIFO scheduling.
+bool set_realtime_priority(int32_t priority);
+
+// Names the calling thread for debuggers and tools like top.
+bool set_name(const char* name);
+
+// Faults in and pins the pages of the given range into physical memory.
+bool lock_memory(const void* address, size_t length);
+void unlock_memory(const void* address, size_t length);
+
+}  // namespace thread
+}  // namespace neo
+
+#endif  // _THREAD_HPP_
@@ -0,0 +1,87 @@
+#ifndef _TRACKING_HPP_
+#define _TRACKING_HPP_
+
+/*
+ * Multi-object tracking across scans.
+ * Implementation detail; not exported.
+ *
+ * Consumes the clusters of consecutive full scans. Each track runs a
+ * constant velocity Kalman filter; the x and y axes share one 2x2
+ * covariance since both see the same noise. Clusters are assigned to
+ * tracks by gated global nearest neighbor: all pairs within the gate,
+ * closest first, each track and cluster used once. Unassigned clusters
+ * start tentative tracks, confirmed after a few hits in a row; tracks
+ * missing too many scans in a row are dropped.
+ *
+ * All storage is allocated up front; updates do not allocate.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "neo.h"
+#include "scan.hpp"
+
+namespace neo {
+namespace tracking {
+
+struct settings {
+  float max_distance;  // cm between a track's predicted position and a cluster
+  int32_t max_misses;  // scans a track survives without a cluster
+};
+
+class tracker {
+ public:
+  explicit tracker(const settings& config);
+
+  // Associates the clusters of a scan completed at timestamp (in us) with
+  // the tracks and writes the confirmed ones to out, which holds
+  // NEO_MAX_TRACKS; returns their number
+  int32_t update(const cluster* clusters, int32_t count, int64_t timestamp,
+      track* out);
+
+  // Drops all tracks, e.g. for a new scanning session
+  void reset();
+
+ private:
+  struct state {
+    bool used;
+    int32_t id;
+    float x;
+    float y;
+    float vx;
+    float vy;
+    float pp;  // covariance per axis: position, position-velocity, velocity
+    float pv;
+    float vv;
+    int32_t age;
+    int32_t hits;  // consecutive, saturating at confirm_hits
+    int32_t misses;
+    bool confirmed;
+    bool assigned;  // during an update
+  };
+
+  struct candidate {
+    float distance;
+    int32_t track;
+    int32_t cluster;
+  };
+
+  void predict(state& s, float dt) const;
+  void correct(state& s, float x, float y) const;
+
+  settings config;
+
+  std::vector<state> tracks;          // NEO_MAX_TRACKS slots
+  std::vector<candidate> candidates;  // capacity for every pair
+  std::vector<uint8_t> taken;         // by cluster, during an update
+
+  int64_t last_timestamp;
+  int32_t next_id;
+};
+
+}  // namespace tracking
+}  // namespace neo
+
+#endif  // _TRACKING_HPP_
@@ -0,0 +1,112 @@
+#ifndef _TRANSPORT_HPP_
+#define _TRANSPORT_HPP_
+
+/*
+ * Byte sources the device protocol runs on.
+ * Implementation detail; not exported.
+ *
+ * The port string selects the transport:
+ *
+ *   /dev/ttyUSB0, COM8   serial port (see serial.hpp)
+ *   file:capture.bin     replays recorded device bytes once
+ *   mem:capture.bin      loads recorded bytes and replays them from memory
+ *                        in an endless loop, e.g. for benchmarks
+ *   unix:/run/neo.sock   stream socket carrying device bytes (POSIX)
+ *   tcp://10.0.0.7:4001  raw TCP serial server, e.g. a serial-to-Ethernet
+ *                        bridge; the baud rate is configured on the bridge
+ *
+ * Replays are not interactive: nothing answers commands, so the device
+ * bring-up and scan start and stop handshakes are skipped for them.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "error.hpp"
+#include "neo.h"
+#include "serial.hpp"
+
+namespace neo {
+namespace transport {
+
+struct error : neo::error::error {
+  using base = neo::error::error;
+  using base::base;
+};
+
+// Thrown by transport_read after transport_interrupt was called. The
+// interrupt is sticky: every further read throws until transport_flush.
+struct interrupted : error {
+  using base = error;
+  using base::base;
+};
+
+// Thrown by transport_read waiting past the deadline from
+// transport_set_deadline.
+struct timed_out : error {
+  using base = error;
+  using base::base;
+};
+
+using deadline = serial::deadline;
+
+// Implemented by every byte source; use the transport_* functions below.
+struct transport {
+  virtual ~transport() {}
+
+  virtual void read(void* to, int32_t len) = 0;  // exactly len bytes
+  virtual void write(const void* from, int32_t len) = 0;
+  virtual void flush() = 0;
+  virtual void interrupt() = 0;
+  virtual void set_deadline(deadline until) = 0;
+
+  virtual int32_t readiness_fd() = 0;
+  virtual bool interactive() = 0;
+};
+
+using transport_s = transport*;
+
+// Lets another thread abandon a transport_construct still connecting, e.g.
+// to a serial server that does not answer, which then throws interrupted.
+// Sticky until interrupter_reset. Platform specific, in src/<os>/socket.cpp.
+using interrupter_s = struct interrupter*;
+
+interrupter_s interrupter_construct();
+void interrupter_destruct(interrupter_s interrupter);
+void interrupter_interrupt(interrupter_s interrupter);  // from any thread
+void interrupter_reset(interrupter_s interrupter);
+
+transport_s transport_construct(const char* port, int32_t baudrate,
+    const serial::config& cfg, interrupter_s interrupter = nullptr);
+void transport_destruct(transport_s transport);
+
+// Reliable full read xor error
+void transport_read(transport_s transport, void* to, int32_t len);
+void transport_write(transport_s transport, const void* from, int32_t len);
+// Drops pending input together with a pending interrupt
+void transport_flush(transport_s transport);
+// Wakes up a thread blocked in transport_read; safe to call from any thread.
+void transport_interrupt(transport_s transport);
+// Bounds how long transport_read waits for bytes, e.g. for the answer to a
+// command; deadline::max(), the initial value, waits forever.
+void transport_set_deadline(transport_s transport, deadline until);
+
+// Descriptor that polls readable when new bytes arrive, -1 if there is none.
+// Bytes may already be buffered while it does not.
+int32_t transport_readiness_fd(transport_s transport);
+// Whether the other end answers commands
+bool transport_interactive(transport_s transport);
+
+// Endless replay of bytes from memory
+transport_s memory_construct(std::vector<uint8_t> bytes);
+
+// Platform specific, in src/<os>/socket.cpp
+transport_s unix_socket_construct(const char* path);
+// host:port; gives up on a server not accepting within a few seconds
+transport_s tcp_socket_construct(const char* address, interrupter_s interrupter);
+
+}  // namespace transport
+}  // namespace neo
+
+#endif  // _TRANSPORT_HPP_
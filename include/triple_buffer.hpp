@@ -0,0 +1,61 @@
+#ifndef _TRIPLE_BUFFER_HPP_
+#define _TRIPLE_BUFFER_HPP_
+
+/*
+ * Wait-free single-producer single-consumer triple buffer.
+ * Implementation detail; not exported.
+ */
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace neo {
+namespace triple_buffer {
+
+template <typename T> class triple_buffer {
+ public:
+  // Producer: the slot to fill before the next publish().
+  T& back() { return slots[back_index]; }
+
+  // Producer: make back() the newest slot and continue on the spare one.
+  void publish() {
+    back_index = middle.exchange(back_index | fresh, std::memory_order_acq_rel)
+      & index_mask;
+  }
+
+  // Consumer: the newest published slot, nullptr before the first publish().
+  // Stays untouched by the producer until the next call to latest().
+  T* latest() {
+    if ( middle.load(std::memory_order_acquire) & fresh ) {
+      front_index = middle.exchange(front_index, std::memory_order_acq_rel)
+        & index_mask;
+      has_front = true;
+    }
+
+    return has_front ? &slots[front_index] : nullptr;
+  }
+
+  // Forget everything published; neither side may be active.
+  void clear() {
+    back_index = 0;
+    middle.store(1, std::memory_order_relaxed);
+    front_index = 2;
+    has_front = false;
+  }
+
+ private:
+  enum : uint8_t { index_mask = 0x3, fresh = 0x4 };
+
+  T slots[3];
+
+  uint8_t back_index = 0;          // owned by the producer
+  std::atomic<uint8_t> middle{1};  // shared: index of the spare slot | fresh
+  uint8_t front_index = 2;         // owned by the consumer
+  bool has_front = false;
+};
+
+}  // namespace triple_buffer
+}  // namespace neo
+
+#endif  // _TRIPLE_BUFFER_HPP_
@@ -0,0 +1,43 @@
+#ifndef _URING_HPP_
+#define _URING_HPP_
+
+/*
+ * io_uring read path for serial devices (Linux).
+ * Implementation detail; not exported.
+ *
+ * All devices of the process share one ring and a thread serving it, which
+ * submits and waits in a single io_uring_enter and harvests the completions
+ * of every device at once. Each device keeps a chain of reads posted into
+ * registered buffers, so chunks keep landing while earlier ones are parsed;
+ * a device waiting for bytes sleeps until the ring thread hands it some.
+ */
+
+#include <stdint.h>
+
+#include "serial.hpp"
+
+namespace neo {
+namespace serial {
+namespace uring {
+
+using reader_s = struct reader*;
+
+// Starts reading fd through the shared ring, which also watches wake_fd
+// for wakeups. Returns nullptr when io_uring is unavailable at build or
+// at run time, or all reader slots of the ring are taken.
+reader_s reader_construct(int32_t fd, int32_t wake_fd);
+void reader_destruct(reader_s reader);
+
+// Blocks for the next chunk of bytes. The chunk stays valid until the next
+// call. Throws serial::interrupted once wake_fd became readable, and
+// serial::timed_out once until passed.
+int32_t reader_read(reader_s reader, deadline until, const uint8_t** data);
+
+// Drops the chunks in flight and re-arms the wakeup after wake_fd was drained.
+void reader_flush(reader_s reader);
+
+}  // namespace uring
+}  // namespace serial
+}  // namespace neo
+
+#endif  // _URING_HPP_
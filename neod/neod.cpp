@@ -0,0 +1,736 @@
+// neod: owns lidar devices and serves their scans to local clients.
+//
+// Clients open "neo:///run/neod.sock" or "neo://127.0.0.1:7001" with the
+// regular neo_device_construct and subscribe to full scans, sectors and a
+// decimation of the revolutions. Acquisition never waits for clients: each
+// client has a bounded outgoing queue, and a client that cannot keep up
+// loses its oldest scans instead of stalling the device.
+//
+// Usage: neod [options] [name=]port[@baudrate]...
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <neo/neo.h>
+
+#include "neod.hpp"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace wire = neo::neod;
+
+using frame_s = std::shared_ptr<const std::vector<uint8_t>>;
+
+static void usage() {
+  fprintf(stderr,
+      "Usage: neod [options] [name=]port[@baudrate]...\n"
+      "  -u path     serve on a Unix-domain socket (default /tmp/neod.sock)\n"
+      "  -t host:port  also serve on TCP, e.g. 127.0.0.1:7001\n"
+      "  -s degrees  stream sectors of this size as well\n"
+      "  -q bytes    per-client queue limit (default 1048576)\n"
+      "  -c          LZ compress scans (saves bandwidth, costs CPU)\n"
+      "Devices are named dev0, dev1, ... unless given a name.\n");
+}
+
+static frame_s make_frame(wire::frame type, const uint8_t* payload,
+    uint32_t length) {
+  auto out = std::make_shared<std::vector<uint8_t>>(wire::header_size + length);
+  wire::put_header(out->data(), type, length);
+  std::copy(payload, payload + length, out->begin() + wire::header_size);
+  return out;
+}
+
+static frame_s make_error_frame(const std::string& what) {
+  return make_frame(wire::frame::error,
+      reinterpret_cast<const uint8_t*>(what.data()),
+      static_cast<uint32_t>(what.size()));
+}
+
+// Devices and their acquisition threads
+
+enum class kind { scan, sector, error };
+
+struct message {
+  size_t device;
+  kind what;
+  int32_t revolution;
+  frame_s frame;
+};
+
+// Hands frames from the acquisition threads to the network loop
+class hub {
+ public:
+  hub() {
+    if ( pipe(wake) == -1 ) {
+      perror("pipe");
+      exit(EXIT_FAILURE);
+    }
+
+    fcntl(wake[0], F_SETFL, O_NONBLOCK);
+    fcntl(wake[1], F_SETFL, O_NONBLOCK);
+  }
+
+  void post(message m) {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+
+      // The network loop is stuck; do not let acquisition pile up behind it
+      if ( pending.size() >= max_pending )
+        pending.erase(pending.begin());
+
+      pending.push_back(std::move(m));
+    }
+
+    notify();
+  }
+
+  void notify() {
+    const uint8_t one = 1;
+    if ( write(wake[1], &one, sizeof(one)) == -1 ) {
+      // full pipe: a wakeup is pending already
+    }
+  }
+
+  std::vector<message> take() {
+    uint8_t discard[64];
+    while ( read(wake[0], discard, sizeof(discard)) > 0 ) {
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+    std::vector<message> out;
+    out.swap(pending);
+    return out;
+  }
+
+  int wake_fd() const { return wake[0]; }
+
+ private:
+  static constexpr size_t max_pending = 1024;
+
+  std::mutex mutex;
+  std::vector<message> pending;
+  int wake[2];
+};
+
+static std::atomic<bool> running{true};
+
+struct device {
+  std::string name;
+  std::string port;
+  int32_t baudrate;
+
+  neo_device_s handle;
+  int32_t motor_speed;
+  int32_t sector_size;
+
+  std::thread scans;
+  std::thread sectors;
+
+  frame_s failure;  // error frame once acquisition failed, for new clients
+};
+
+static void acquire(device& dev, size_t index, hub& out, bool sectors,
+    int32_t flags) {
+  std::vector<uint8_t> buffer;
+
+  while ( running ) {
+    neo_error_s error = nullptr;
+    neo_scan_s scan = sectors ? neo_device_get_sector(dev.handle, &error)
+      : neo_device_get_scan(dev.handle, &error);
+
+    // Stopped on shutdown is not a failure worth reporting
+    if ( error ) {
+      if ( running ) {
+        fprintf(stderr, "neod: %s: %s\n", dev.name.c_str(), neo_error_message(error));
+        out.post({index, kind::error, 0, make_error_frame(neo_error_message(error))});
+      }
+
+      neo_error_destruct(error);
+      return;
+    }
+
+    buffer.resize(wire::header_size + neo_scan_encode_bound(scan));
+
+    const int32_t size = neo_scan_encode(scan, flags, buffer.data() + wire::header_size,
+        static_cast<int32_t>(buffer.size() - wire::header_size), &error);
+    const int32_t revolution = neo_scan_get_revolution(scan);
+    neo_scan_destruct(scan);
+
+    if ( error ) {
+      neo_error_destruct(error);
+      continue;
+    }
+
+    wire::put_header(buffer.data(), wire::frame::scan, static_cast<uint32_t>(size));
+
+    out.post({index, sectors ? kind::sector : kind::scan, revolution,
+        std::make_shared<std::vector<uint8_t>>(buffer.begin(),
+            buffer.begin() + wire::header_size + size)});
+  }
+}
+
+// Clients
+
+struct client {
+  int fd;
+  std::vector<uint8_t> in;
+
+  bool greeted;
+  size_t device;
+  uint8_t streams;  // wire::streams bits, 0 until subscribed
+  int32_t decimate;
+
+  std::deque<frame_s> out;
+  size_t out_bytes;
+  size_t offset;  // of the first frame, partially sent
+  bool closing;   // close once out is flushed
+
+  uint64_t dropped;
+};
+
+static void queue_frame(client& to, frame_s frame, size_t limit) {
+  // Make room by dropping the oldest frames that have not started sending
+  while ( to.out_bytes + frame->size() > limit && to.out.size() > (to.offset ? 1 : 0) ) {
+    auto victim = to.out.begin() + (to.offset ? 1 : 0);
+    to.out_bytes -= (*victim)->size();
+    to.out.erase(victim);
+    ++to.dropped;
+  }
+
+  if ( to.out_bytes + frame->size() > limit && !to.out.empty() ) {
+    ++to.dropped;
+    return;
+  }
+
+  to.out_bytes += frame->size();
+  to.out.push_back(std::move(frame));
+}
+
+// Sends as much as the socket takes, many frames per syscall; false if the
+// connection broke
+static bool flush(client& to) {
+  while ( !to.out.empty() ) {
+    iovec iov[64];
+    int count = 0;
+
+    for ( auto it = to.out.begin(); it != to.out.end() && count < 64; ++it, ++count ) {
+      const size_t skip = count == 0 ? to.offset : 0;
+      iov[count].iov_base = const_cast<uint8_t*>((*it)->data()) + skip;
+      iov[count].iov_len = (*it)->size() - skip;
+    }
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+
+    ssize_t sent = sendmsg(to.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+    if ( sent == -1 )
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+    while ( sent > 0 ) {
+      const size_t left = to.out.front()->size() - to.offset;
+
+      if ( static_cast<size_t>(sent) < left ) {
+        to.offset += static_cast<size_t>(sent);
+        break;
+      }
+
+      sent -= static_cast<ssize_t>(left);
+      to.out_bytes -= to.out.front()->size();
+      to.out.pop_front();
+      to.offset = 0;
+    }
+  }
+
+  return true;
+}
+
+static void greet(client& c, const std::vector<device>& devices,
+    const uint8_t* payload, uint32_t length, size_t limit) {
+  if ( length < 1 || payload[0] != wire::version ) {
+    queue_frame(c, make_error_frame("neod speaks a different protocol version."), limit);
+    c.closing = true;
+    return;
+  }
+
+  const std::string name{reinterpret_cast<const char*>(payload) + 1, length - 1};
+
+  auto found = std::find_if(devices.begin(), devices.end(),
+      [&](const device& d) { return name.empty() || d.name == name; });
+
+  if ( found == devices.end() ) {
+    queue_frame(c, make_error_frame("neod serves no device named '" + name + "'."), limit);
+    c.closing = true;
+    return;
+  }
+
+  // Nothing will ever stream; tell the client why instead of welcoming it
+  if ( found->failure ) {
+    queue_frame(c, found->failure, limit);
+    c.closing = true;
+    return;
+  }
+
+  c.greeted = true;
+  c.device = static_cast<size_t>(found - devices.begin());
+
+  uint8_t welcome[9];
+  welcome[0] = wire::version;
+  wire::put_u32(welcome + 1, static_cast<uint32_t>(found->motor_speed));
+  wire::put_u32(welcome + 5, static_cast<uint32_t>(found->sector_size));
+
+  queue_frame(c, make_frame(wire::frame::welcome, welcome, sizeof(welcome)), limit);
+}
+
+// Parses complete frames from the client; false to drop the client
+static bool handle_input(client& c, const std::vector<device>& devices,
+    size_t limit) {
+  size_t head = 0;
+
+  while ( c.in.size() - head >= wire::header_size ) {
+    const uint32_t length = wire::get_u32(c.in.data() + head);
+
+    if ( length > wire::max_payload )
+      return false;
+
+    if ( c.in.size() - head < wire::header_size + length )
+      break;
+
+    const auto type = static_cast<wire::frame>(c.in[head + 4]);
+    const uint8_t* payload = c.in.data() + head + wire::header_size;
+    head += wire::header_size + length;
+
+    if ( type == wire::frame::hello && !c.greeted ) {
+      greet(c, devices, payload, length, limit);
+    } else if ( type == wire::frame::subscribe && c.greeted && length >= 3 ) {
+      c.streams = payload[0];
+      c.decimate = std::max<int32_t>(wire::get_u16(payload + 1), 1);
+    } else {
+      return false;
+    }
+  }
+
+  c.in.erase(c.in.begin(), c.in.begin() + head);
+  return true;
+}
+
+static bool wants(const client& c, const message& m) {
+  if ( !c.greeted || c.device != m.device )
+    return false;
+
+  switch ( m.what ) {
+  case kind::error:
+    return true;
+  case kind::scan:
+    return (c.streams & wire::full_scans) && m.revolution % c.decimate == 0;
+  case kind::sector:
+    return (c.streams & wire::sectors) && m.revolution % c.decimate == 0;
+  }
+
+  return false;
+}
+
+// Listening sockets
+
+static int listen_unix(const std::string& path) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if ( path.size() >= sizeof(address.sun_path) ) {
+    fprintf(stderr, "neod: socket path too long: %s\n", path.c_str());
+    return -1;
+  }
+
+  memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  // Only a socket nobody accepts on any more is left over from a daemon
+  // that died; never take over a running daemon's path or a plain file
+  struct stat before;
+
+  if ( lstat(path.c_str(), &before) == 0 ) {
+    if ( !S_ISSOCK(before.st_mode) ) {
+      fprintf(stderr, "neod: %s exists and is not a socket\n", path.c_str());
+      return -1;
+    }
+
+    const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    const bool live = probe != -1
+      && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+
+    if ( probe != -1 )
+      close(probe);
+
+    if ( live ) {
+      fprintf(stderr, "neod: %s is served by a running neod\n", path.c_str());
+      return -1;
+    }
+
+    // Unlink what we probed, not a socket a new daemon bound meanwhile
+    struct stat now;
+
+    if ( lstat(path.c_str(), &now) == 0 && now.st_dev == before.st_dev
+        && now.st_ino == before.st_ino )
+      unlink(path.c_str());
+  }
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if ( fd == -1 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+      || listen(fd, 16) == -1 ) {
+    perror("neod: unix socket");
+
+    if ( fd != -1 )
+      close(fd);
+
+    return -1;
+  }
+
+  return fd;
+}
+
+static int listen_tcp(const std::string& endpoint) {
+  const auto colon = endpoint.rfind(':');
+
+  if ( colon == std::string::npos ) {
+    fprintf(stderr, "neod: expected host:port, got %s\n", endpoint.c_str());
+    return -1;
+  }
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+
+  addrinfo* addresses = nullptr;
+
+  if ( getaddrinfo(endpoint.substr(0, colon).c_str(), endpoint.substr(colon + 1).c_str(),
+        &hints, &addresses) != 0 || !addresses ) {
+    fprintf(stderr, "neod: cannot resolve %s\n", endpoint.c_str());
+    return -1;
+  }
+
+  const int fd = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+  const int one = 1;
+
+  if ( fd != -1 )
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  const bool ok = fd != -1
+    && bind(fd, addresses->ai_addr, addresses->ai_addrlen) == 0
+    && listen(fd, 16) == 0;
+
+  freeaddrinfo(addresses);
+
+  if ( !ok ) {
+    perror("neod: tcp socket");
+
+    if ( fd != -1 )
+      close(fd);
+
+    return -1;
+  }
+
+  return fd;
+}
+
+// Stops and releases every device that got a handle, after joining the
+// acquisition threads that were started; used on failed start-up as well
+static void release_devices(std::vector<device>& devices) {
+  running = false;
+
+  // A silent or failed device never delivers another scan: stopping
+  // interrupts its reads and wakes the acquisition threads with an error
+  for ( device& dev : devices ) {
+    if ( !dev.handle )
+      continue;
+
+    neo_error_s error = nullptr;
+    neo_device_stop_scanning(dev.handle, &error);
+
+    if ( error ) {
+      fprintf(stderr, "neod: %s: %s\n", dev.name.c_str(), neo_error_message(error));
+      neo_error_destruct(error);
+    }
+  }
+
+  for ( device& dev : devices ) {
+    if ( dev.scans.joinable() )
+      dev.scans.join();
+
+    if ( dev.sectors.joinable() )
+      dev.sectors.join();
+
+    if ( dev.handle )
+      neo_device_destruct(dev.handle);
+
+    dev.handle = nullptr;
+  }
+}
+
+static void close_listeners(const std::vector<int>& listeners, bool unix_bound,
+    const std::string& unix_path) {
+  for ( int fd : listeners )
+    close(fd);
+
+  if ( unix_bound )
+    unlink(unix_path.c_str());
+}
+
+static hub* the_hub = nullptr;
+
+static void on_signal(int) {
+  running = false;
+
+  if ( the_hub )
+    the_hub->notify();
+}
+
+int main(int argc, char* argv[]) {
+  std::string unix_path = "/tmp/neod.sock";
+  std::string tcp_endpoint;
+  int32_t sector_size = 0;
+  size_t limit = 1 << 20;
+  int32_t flags = 0;
+
+  int opt;
+  while ( (opt = getopt(argc, argv, "u:t:s:q:ch")) != -1 ) {
+    switch ( opt ) {
+    case 'u': unix_path = optarg; break;
+    case 't': tcp_endpoint = optarg; break;
+    case 's': sector_size = atoi(optarg); break;
+    case 'q': limit = static_cast<size_t>(atol(optarg)); break;
+    case 'c': flags |= NEO_ENCODE_COMPRESS; break;
+    default: usage(); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+
+  if ( optind == argc || sector_size < 0 || sector_size > 360
+      || (sector_size > 0 && 360 % sector_size != 0) ) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<device> devices;
+
+  for ( int n = optind; n < argc; ++n ) {
+    std::string spec = argv[n];
+    device dev;
+
+    const auto equals = spec.find('=');
+    dev.name = equals == std::string::npos ? "dev" + std::to_string(devices.size())
+      : spec.substr(0, equals);
+    spec = equals == std::string::npos ? spec : spec.substr(equals + 1);
+
+    const auto at = spec.rfind('@');
+    dev.port = spec.substr(0, at);
+    dev.baudrate = at == std::string::npos ? 115200 : atoi(spec.c_str() + at + 1);
+    dev.handle = nullptr;
+    dev.motor_speed = 0;
+    dev.sector_size = sector_size;
+
+    devices.push_back(std::move(dev));
+  }
+
+  hub messages;
+  the_hub = &messages;
+
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  // Listeners first: a taken socket fails fast, before the slow bring-up
+  std::vector<int> listeners;
+  bool unix_bound = false;
+
+  if ( !unix_path.empty() ) {
+    const int fd = listen_unix(unix_path);
+    unix_bound = fd != -1;
+
+    if ( fd == -1 )
+      return EXIT_FAILURE;
+
+    listeners.push_back(fd);
+  }
+
+  if ( !tcp_endpoint.empty() ) {
+    const int fd = listen_tcp(tcp_endpoint);
+
+    if ( fd == -1 ) {
+      close_listeners(listeners, unix_bound, unix_path);
+      return EXIT_FAILURE;
+    }
+
+    listeners.push_back(fd);
+  }
+
+  // Bring all devices up; this is the slow part clients no longer pay for.
+  // No acquisition thread runs before every device is up.
+  for ( device& dev : devices ) {
+    neo_error_s error = nullptr;
+
+    fprintf(stderr, "neod: bringing up %s on %s\n", dev.name.c_str(), dev.port.c_str());
+
+    // A failed construct may still hand out a device that needs releasing
+    dev.handle = neo_device_construct(dev.port.c_str(), dev.baudrate, &error);
+
+    if ( !error )
+      dev.motor_speed = neo_device_get_motor_speed(dev.handle, &error);
+
+    if ( !error && dev.sector_size > 0 )
+      neo_device_set_sector_size(dev.handle, dev.sector_size, &error);
+
+    if ( !error )
+      neo_device_start_scanning(dev.handle, &error);
+
+    if ( error ) {
+      fprintf(stderr, "neod: %s: %s\n", dev.name.c_str(), neo_error_message(error));
+      neo_error_destruct(error);
+
+      release_devices(devices);
+      close_listeners(listeners, unix_bound, unix_path);
+      return EXIT_FAILURE;
+    }
+  }
+
+  for ( size_t n = 0; n < devices.size(); ++n ) {
+    device& dev = devices[n];
+    dev.scans = std::thread(acquire, std::ref(dev), n, std::ref(messages), false, flags);
+
+    if ( dev.sector_size > 0 )
+      dev.sectors = std::thread(acquire, std::ref(dev), n, std::ref(messages), true, flags);
+  }
+
+  fprintf(stderr, "neod: serving %zu device(s)\n", devices.size());
+
+  std::vector<client> clients;
+
+  while ( running ) {
+    std::vector<pollfd> fds;
+    fds.push_back({messages.wake_fd(), POLLIN, 0});
+
+    for ( int fd : listeners )
+      fds.push_back({fd, POLLIN, 0});
+
+    for ( const client& c : clients )
+      fds.push_back({c.fd, static_cast<short>(POLLIN | (c.out.empty() ? 0 : POLLOUT)), 0});
+
+    if ( poll(fds.data(), fds.size(), -1) == -1 && errno != EINTR ) {
+      perror("neod: poll");
+      break;
+    }
+
+    // Fan out new frames; messages carry shared buffers, no copies per client
+    if ( fds[0].revents & POLLIN ) {
+      for ( message& m : messages.take() ) {
+        if ( m.what == kind::error && !devices[m.device].failure )
+          devices[m.device].failure = m.frame;
+
+        for ( client& c : clients ) {
+          if ( wants(c, m) ) {
+            queue_frame(c, m.frame, limit);
+            c.closing = c.closing || m.what == kind::error;
+          }
+        }
+      }
+    }
+
+    std::vector<bool> keep(clients.size(), true);
+
+    for ( size_t n = 0; n < clients.size(); ++n ) {
+      client& c = clients[n];
+      const short revents = fds[1 + listeners.size() + n].revents;
+
+      if ( revents & (POLLIN | POLLHUP | POLLERR) ) {
+        uint8_t chunk[4096];
+        const ssize_t received = recv(c.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+
+        if ( received <= 0 && !(received == -1 && (errno == EAGAIN || errno == EINTR)) ) {
+          keep[n] = false;
+          continue;
+        }
+
+        if ( received > 0 ) {
+          c.in.insert(c.in.end(), chunk, chunk + received);
+          keep[n] = handle_input(c, devices, limit);
+        }
+      }
+
+      // Write right away rather than waiting for the next poll round
+      if ( keep[n] && !c.out.empty() )
+        keep[n] = flush(c);
+
+      if ( keep[n] && c.closing && c.out.empty() )
+        keep[n] = false;
+    }
+
+    for ( size_t n = clients.size(); n-- > 0; ) {
+      if ( !keep[n] ) {
+        if ( clients[n].dropped > 0 )
+          fprintf(stderr, "neod: client dropped %llu frames\n",
+              static_cast<unsigned long long>(clients[n].dropped));
+
+        close(clients[n].fd);
+        clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(n));
+      }
+    }
+
+    for ( size_t n = 0; n < listeners.size(); ++n ) {
+      if ( !(fds[1 + n].revents & POLLIN) )
+        continue;
+
+      const int fd = accept(listeners[n], nullptr, nullptr);
+
+      if ( fd == -1 )
+        continue;
+
+      fcntl(fd, F_SETFL, O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+      const int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+      clients.push_back(client{fd, {}, /*greeted=*/false, /*device=*/0,
+          /*streams=*/0, /*decimate=*/1, {}, /*out_bytes=*/0, /*offset=*/0,
+          /*closing=*/false, /*dropped=*/0});
+    }
+  }
+
+  fprintf(stderr, "neod: shutting down\n");
+  running = false;
+
+  close_listeners(listeners, unix_bound, unix_path);
+
+  for ( client& c : clients )
+    close(c.fd);
+
+  release_devices(devices);
+}
@@ -25,6 +25,89 @@ libneo.neo_device_construct_simple.argtypes = [ctypes.c_char_p, ctypes.c_void_p]
 libneo.neo_device_construct.restype = ctypes.c_void_p
 libneo.neo_device_construct.argtypes = [ctypes.c_char_p, ctypes.c_int32, ctypes.c_void_p]
 
+libneo.neo_device_options_construct.restype = ctypes.c_void_p
+libneo.neo_device_options_construct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_device_options_destruct.restype = None
+libneo.neo_device_options_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_device_options_set_queue_depth.restype = None
+libneo.neo_device_options_set_queue_depth.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_device_options_set_queue_policy.restype = None
+libneo.neo_device_options_set_queue_policy.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_device_options_set_delivery.restype = None
+libneo.neo_device_options_set_delivery.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_device_options_set_thread_affinity.restype = None
+libneo.neo_device_options_set_thread_affinity.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+
+libneo.neo_device_options_set_thread_priority.restype = None
+libneo.neo_device_options_set_thread_priority.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_device_options_set_thread_name.restype = None
+libneo.neo_device_options_set_thread_name.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+
+libneo.neo_device_options_set_lock_memory.restype = None
+libneo.neo_device_options_set_lock_memory.argtypes = [ctypes.c_void_p, ctypes.c_bool]
+
+libneo.neo_device_options_set_serial_profile.restype = None
+libneo.neo_device_options_set_serial_profile.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_device_options_set_io_uring.restype = None
+libneo.neo_device_options_set_io_uring.argtypes = [ctypes.c_void_p, ctypes.c_bool]
+
+libneo.neo_device_options_set_shm_ring.restype = None
+libneo.neo_device_options_set_shm_ring.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int32]
+
+libneo.neo_device_options_set_archive.restype = None
+libneo.neo_device_options_set_archive.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int32]
+
+_status_callback = ctypes.CFUNCTYPE(None, ctypes.c_int32, ctypes.c_char_p, ctypes.c_void_p)
+
+libneo.neo_device_options_set_reconnect.restype = None
+libneo.neo_device_options_set_reconnect.argtypes = [ctypes.c_void_p, ctypes.c_int32, _status_callback, ctypes.c_void_p]
+
+libneo.neo_device_options_set_grid.restype = None
+libneo.neo_device_options_set_grid.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32]
+
+libneo.neo_device_options_set_temporal_filter.restype = None
+libneo.neo_device_options_set_temporal_filter.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32, ctypes.c_int32]
+
+libneo.neo_device_options_set_background.restype = None
+libneo.neo_device_options_set_background.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32, ctypes.c_int32]
+
+libneo.neo_device_options_set_clusters.restype = None
+libneo.neo_device_options_set_clusters.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32]
+
+libneo.neo_device_options_set_tracking.restype = None
+libneo.neo_device_options_set_tracking.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32]
+
+libneo.neo_device_options_set_odometry.restype = None
+libneo.neo_device_options_set_odometry.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32, ctypes.c_int32]
+
+libneo.neo_device_options_set_odometry_affinity.restype = None
+libneo.neo_device_options_set_odometry_affinity.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+
+libneo.neo_device_options_set_profile_cache.restype = None
+libneo.neo_device_options_set_profile_cache.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+
+libneo.neo_device_construct_with_options.restype = ctypes.c_void_p
+libneo.neo_device_construct_with_options.argtypes = [ctypes.c_char_p, ctypes.c_int32, ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_device_get_queue_memory_budget.restype = ctypes.c_int64
+libneo.neo_device_get_queue_memory_budget.argtypes = [ctypes.c_void_p]
+
+libneo.neo_device_get_reconnects.restype = ctypes.c_int64
+libneo.neo_device_get_reconnects.argtypes = [ctypes.c_void_p]
+
+libneo.neo_device_get_downtime.restype = ctypes.c_int64
+libneo.neo_device_get_downtime.argtypes = [ctypes.c_void_p]
+
+libneo.neo_device_get_profile_cache_failures.restype = ctypes.c_int64
+libneo.neo_device_get_profile_cache_failures.argtypes = [ctypes.c_void_p]
+
 libneo.neo_device_destruct.restype = None
 libneo.neo_device_destruct.argtypes = [ctypes.c_void_p]
 
@@ -37,13 +120,28 @@ libneo.neo_device_stop_scanning.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
 libneo.neo_device_get_scan.restype = ctypes.c_void_p
 libneo.neo_device_get_scan.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
 
+libneo.neo_device_get_readiness_fd.restype = ctypes.c_int32
+libneo.neo_device_get_readiness_fd.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_device_try_get_scan.restype = ctypes.c_void_p
+libneo.neo_device_try_get_scan.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_device_get_latest_scan.restype = ctypes.c_void_p
+libneo.neo_device_get_latest_scan.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_device_set_sector_size.restype = None
+libneo.neo_device_set_sector_size.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_device_get_sector.restype = ctypes.c_void_p
+libneo.neo_device_get_sector.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
 libneo.neo_scan_destruct.restype = None
 libneo.neo_scan_destruct.argtypes = [ctypes.c_void_p]
 
 libneo.neo_scan_get_number_of_samples.restype = ctypes.c_int32
 libneo.neo_scan_get_number_of_samples.argtypes = [ctypes.c_void_p]
 
-libneo.neo_scan_get_angle.restype = ctypes.c_int32
+libneo.neo_scan_get_angle.restype = ctypes.c_float
 libneo.neo_scan_get_angle.argtypes = [ctypes.c_void_p, ctypes.c_int32]
 
 libneo.neo_scan_get_distance.restype = ctypes.c_int32
@@ -52,6 +150,195 @@ libneo.neo_scan_get_distance.argtypes = [ctypes.c_void_p, ctypes.c_int32]
 libneo.neo_scan_get_signal_strength.restype = ctypes.c_int32
 libneo.neo_scan_get_signal_strength.argtypes = [ctypes.c_void_p, ctypes.c_int32]
 
+libneo.neo_scan_get_revolution.restype = ctypes.c_int32
+libneo.neo_scan_get_revolution.argtypes = [ctypes.c_void_p]
+
+libneo.neo_scan_get_sector_index.restype = ctypes.c_int32
+libneo.neo_scan_get_sector_index.argtypes = [ctypes.c_void_p]
+
+libneo.neo_scan_get_grid_bins.restype = ctypes.c_int32
+libneo.neo_scan_get_grid_bins.argtypes = [ctypes.c_void_p]
+
+libneo.neo_scan_get_grid.restype = ctypes.c_int32
+libneo.neo_scan_get_grid.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_int32), ctypes.c_int32]
+
+libneo.neo_scan_resample.restype = None
+libneo.neo_scan_resample.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32, ctypes.POINTER(ctypes.c_int32), ctypes.c_void_p]
+
+libneo.neo_scan_extract_clusters.restype = ctypes.c_void_p
+libneo.neo_scan_extract_clusters.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_scan_get_clusters.restype = ctypes.c_void_p
+libneo.neo_scan_get_clusters.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_clusters_destruct.restype = None
+libneo.neo_clusters_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_clusters_get_count.restype = ctypes.c_int32
+libneo.neo_clusters_get_count.argtypes = [ctypes.c_void_p]
+
+libneo.neo_clusters_get_centroid_x.restype = ctypes.c_float
+libneo.neo_clusters_get_centroid_x.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_clusters_get_centroid_y.restype = ctypes.c_float
+libneo.neo_clusters_get_centroid_y.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_clusters_get_min_x.restype = ctypes.c_float
+libneo.neo_clusters_get_min_x.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_clusters_get_min_y.restype = ctypes.c_float
+libneo.neo_clusters_get_min_y.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_clusters_get_max_x.restype = ctypes.c_float
+libneo.neo_clusters_get_max_x.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_clusters_get_max_y.restype = ctypes.c_float
+libneo.neo_clusters_get_max_y.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_clusters_get_first_sample.restype = ctypes.c_int32
+libneo.neo_clusters_get_first_sample.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_clusters_get_last_sample.restype = ctypes.c_int32
+libneo.neo_clusters_get_last_sample.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_clusters_get_sample_count.restype = ctypes.c_int32
+libneo.neo_clusters_get_sample_count.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_scan_get_timestamp.restype = ctypes.c_int64
+libneo.neo_scan_get_timestamp.argtypes = [ctypes.c_void_p]
+
+libneo.neo_scan_get_tracks.restype = ctypes.c_void_p
+libneo.neo_scan_get_tracks.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_tracks_destruct.restype = None
+libneo.neo_tracks_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_tracks_get_count.restype = ctypes.c_int32
+libneo.neo_tracks_get_count.argtypes = [ctypes.c_void_p]
+
+libneo.neo_tracks_get_id.restype = ctypes.c_int32
+libneo.neo_tracks_get_id.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_tracks_get_x.restype = ctypes.c_float
+libneo.neo_tracks_get_x.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_tracks_get_y.restype = ctypes.c_float
+libneo.neo_tracks_get_y.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_tracks_get_velocity_x.restype = ctypes.c_float
+libneo.neo_tracks_get_velocity_x.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_tracks_get_velocity_y.restype = ctypes.c_float
+libneo.neo_tracks_get_velocity_y.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_tracks_get_age.restype = ctypes.c_int32
+libneo.neo_tracks_get_age.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_tracks_get_misses.restype = ctypes.c_int32
+libneo.neo_tracks_get_misses.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_scan_extract_lines.restype = ctypes.c_void_p
+libneo.neo_scan_extract_lines.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_int32, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_lines_destruct.restype = None
+libneo.neo_lines_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_lines_get_count.restype = ctypes.c_int32
+libneo.neo_lines_get_count.argtypes = [ctypes.c_void_p]
+
+libneo.neo_lines_get_start_x.restype = ctypes.c_float
+libneo.neo_lines_get_start_x.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_lines_get_start_y.restype = ctypes.c_float
+libneo.neo_lines_get_start_y.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_lines_get_end_x.restype = ctypes.c_float
+libneo.neo_lines_get_end_x.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_lines_get_end_y.restype = ctypes.c_float
+libneo.neo_lines_get_end_y.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_lines_get_first_sample.restype = ctypes.c_int32
+libneo.neo_lines_get_first_sample.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_lines_get_last_sample.restype = ctypes.c_int32
+libneo.neo_lines_get_last_sample.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_lines_get_rms.restype = ctypes.c_float
+libneo.neo_lines_get_rms.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_scan_construct.restype = ctypes.c_void_p
+libneo.neo_scan_construct.argtypes = [ctypes.POINTER(ctypes.c_float), ctypes.POINTER(ctypes.c_int32), ctypes.c_int32, ctypes.c_int32, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_scan_set_timestamp.restype = None
+libneo.neo_scan_set_timestamp.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+
+libneo.neo_scan_encode_bound.restype = ctypes.c_int32
+libneo.neo_scan_encode_bound.argtypes = [ctypes.c_void_p]
+
+libneo.neo_scan_encode.restype = ctypes.c_int32
+libneo.neo_scan_encode.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_void_p, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_scan_decode.restype = ctypes.c_void_p
+libneo.neo_scan_decode.argtypes = [ctypes.c_char_p, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_shm_reader_construct.restype = ctypes.c_void_p
+libneo.neo_shm_reader_construct.argtypes = [ctypes.c_char_p, ctypes.c_void_p]
+
+libneo.neo_shm_reader_destruct.restype = None
+libneo.neo_shm_reader_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_shm_reader_read.restype = ctypes.c_bool
+libneo.neo_shm_reader_read.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_shm_reader_get_sequence.restype = ctypes.c_uint64
+libneo.neo_shm_reader_get_sequence.argtypes = [ctypes.c_void_p]
+
+libneo.neo_shm_reader_get_dropped.restype = ctypes.c_uint64
+libneo.neo_shm_reader_get_dropped.argtypes = [ctypes.c_void_p]
+
+libneo.neo_archive_writer_construct.restype = ctypes.c_void_p
+libneo.neo_archive_writer_construct.argtypes = [ctypes.c_char_p, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_archive_writer_destruct.restype = None
+libneo.neo_archive_writer_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_archive_writer_append.restype = None
+libneo.neo_archive_writer_append.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_archive_writer_flush.restype = None
+libneo.neo_archive_writer_flush.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_archive_writer_get_dropped.restype = ctypes.c_uint64
+libneo.neo_archive_writer_get_dropped.argtypes = [ctypes.c_void_p]
+
+libneo.neo_archive_reader_construct.restype = ctypes.c_void_p
+libneo.neo_archive_reader_construct.argtypes = [ctypes.c_char_p, ctypes.c_void_p]
+
+libneo.neo_archive_reader_destruct.restype = None
+libneo.neo_archive_reader_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_archive_reader_get_count.restype = ctypes.c_int64
+libneo.neo_archive_reader_get_count.argtypes = [ctypes.c_void_p]
+
+libneo.neo_archive_reader_find.restype = ctypes.c_int64
+libneo.neo_archive_reader_find.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+
+libneo.neo_archive_reader_get_timestamp.restype = ctypes.c_int64
+libneo.neo_archive_reader_get_timestamp.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+
+libneo.neo_archive_reader_get_revolution.restype = ctypes.c_int32
+libneo.neo_archive_reader_get_revolution.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+
+libneo.neo_archive_reader_get_number_of_samples.restype = ctypes.c_int32
+libneo.neo_archive_reader_get_number_of_samples.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+
+libneo.neo_archive_reader_get_angles.restype = ctypes.POINTER(ctypes.c_float)
+libneo.neo_archive_reader_get_angles.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+
+libneo.neo_archive_reader_get_distances.restype = ctypes.POINTER(ctypes.c_int32)
+libneo.neo_archive_reader_get_distances.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+
 libneo.neo_device_get_motor_speed.restype = ctypes.c_int32
 libneo.neo_device_get_motor_speed.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
 
@@ -64,6 +351,87 @@ libneo.neo_device_get_sample_rate.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
 libneo.neo_device_set_sample_rate.restype = None
 libneo.neo_device_set_sample_rate.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_void_p]
 
+libneo.neo_device_set_target_resolution.restype = None
+libneo.neo_device_set_target_resolution.argtypes = [ctypes.c_void_p, ctypes.c_float, ctypes.c_void_p]
+
+libneo.neo_device_set_target_update_rate.restype = None
+libneo.neo_device_set_target_update_rate.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_device_relearn_background.restype = None
+libneo.neo_device_relearn_background.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_device_get_pose.restype = ctypes.c_void_p
+libneo.neo_device_get_pose.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_pose_destruct.restype = None
+libneo.neo_pose_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_pose_get_revolution.restype = ctypes.c_int32
+libneo.neo_pose_get_revolution.argtypes = [ctypes.c_void_p]
+
+libneo.neo_pose_get_x.restype = ctypes.c_float
+libneo.neo_pose_get_x.argtypes = [ctypes.c_void_p]
+
+libneo.neo_pose_get_y.restype = ctypes.c_float
+libneo.neo_pose_get_y.argtypes = [ctypes.c_void_p]
+
+libneo.neo_pose_get_heading.restype = ctypes.c_float
+libneo.neo_pose_get_heading.argtypes = [ctypes.c_void_p]
+
+libneo.neo_pose_get_covariance.restype = None
+libneo.neo_pose_get_covariance.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float)]
+
+libneo.neo_pose_get_correspondences.restype = ctypes.c_int32
+libneo.neo_pose_get_correspondences.argtypes = [ctypes.c_void_p]
+
+libneo.neo_device_get_identity.restype = ctypes.c_void_p
+libneo.neo_device_get_identity.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+
+libneo.neo_identity_destruct.restype = None
+libneo.neo_identity_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_identity_get_model.restype = ctypes.c_char_p
+libneo.neo_identity_get_model.argtypes = [ctypes.c_void_p]
+
+libneo.neo_identity_get_serial_number.restype = ctypes.c_char_p
+libneo.neo_identity_get_serial_number.argtypes = [ctypes.c_void_p]
+
+libneo.neo_identity_get_protocol_version.restype = ctypes.c_char_p
+libneo.neo_identity_get_protocol_version.argtypes = [ctypes.c_void_p]
+
+libneo.neo_identity_get_firmware_version.restype = ctypes.c_char_p
+libneo.neo_identity_get_firmware_version.argtypes = [ctypes.c_void_p]
+
+libneo.neo_identity_get_hardware_version.restype = ctypes.c_int32
+libneo.neo_identity_get_hardware_version.argtypes = [ctypes.c_void_p]
+
+libneo.neo_identity_get_bit_rate.restype = ctypes.c_int32
+libneo.neo_identity_get_bit_rate.argtypes = [ctypes.c_void_p]
+
+libneo.neo_identity_get_motor_speed.restype = ctypes.c_int32
+libneo.neo_identity_get_motor_speed.argtypes = [ctypes.c_void_p]
+
+libneo.neo_identity_get_sample_rate.restype = ctypes.c_int32
+libneo.neo_identity_get_sample_rate.argtypes = [ctypes.c_void_p]
+
+libneo.neo_discover.restype = ctypes.c_void_p
+libneo.neo_discover.argtypes = [ctypes.c_int32, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_discover_ports.restype = ctypes.c_void_p
+libneo.neo_discover_ports.argtypes = [ctypes.POINTER(ctypes.c_char_p), ctypes.c_int32, ctypes.c_int32, ctypes.c_int32, ctypes.c_void_p]
+
+libneo.neo_discovery_destruct.restype = None
+libneo.neo_discovery_destruct.argtypes = [ctypes.c_void_p]
+
+libneo.neo_discovery_get_count.restype = ctypes.c_int32
+libneo.neo_discovery_get_count.argtypes = [ctypes.c_void_p]
+
+libneo.neo_discovery_get_port.restype = ctypes.c_char_p
+libneo.neo_discovery_get_port.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+
+libneo.neo_discovery_get_identity.restype = ctypes.c_void_p
+libneo.neo_discovery_get_identity.argtypes = [ctypes.c_void_p, ctypes.c_int32, ctypes.c_void_p]
+
 libneo.neo_device_reset.restype = None
 libneo.neo_device_reset.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
 
@@ -75,7 +443,142 @@ def _error_to_exception(error):
     return RuntimeError(what.decode('ascii'))
 
 
-class Scan(collections.namedtuple('Scan', 'samples')):
+QUEUE_DROP_OLDEST = 0
+QUEUE_DROP_NEWEST = 1
+QUEUE_BLOCK_PRODUCER = 2
+QUEUE_KEEP_LATEST = 3
+
+SERIAL_PROFILE_STANDARD = 0
+SERIAL_PROFILE_LOW_LATENCY = 1
+SERIAL_PROFILE_LOW_CPU = 2
+
+DELIVERY_QUEUE = 0
+DELIVERY_LATEST = 1
+
+ENCODE_COMPRESS = 1
+
+GRID_MIN = 0
+GRID_NEAREST = 1
+GRID_MEAN = 2
+
+GRID_EMPTY = -1
+MAX_GRID_BINS = 1440
+
+TEMPORAL_MEDIAN = 0
+TEMPORAL_VOTE = 1
+
+MAX_TEMPORAL_WINDOW = 15
+
+STATUS_DISCONNECTED = 0
+STATUS_RECONNECTED = 1
+
+
+class DeviceOptions:
+    ### Construction-time device options, pass as `neo(port, bitrate, options)`
+    def __init__(self):
+        error = ctypes.c_void_p()
+        self.options = libneo.neo_device_options_construct(ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+    def __del__(self):
+        if getattr(self, 'options', None):
+            libneo.neo_device_options_destruct(self.options)
+
+    ### Depth of the scan and sector queues (default 20)
+    def set_queue_depth(self, depth):
+        libneo.neo_device_options_set_queue_depth(self.options, depth)
+
+    ### One of the QUEUE_* policies (default QUEUE_DROP_OLDEST)
+    def set_queue_policy(self, policy):
+        libneo.neo_device_options_set_queue_policy(self.options, policy)
+
+    ### DELIVERY_QUEUE (default) or DELIVERY_LATEST for get_latest_scan
+    def set_delivery(self, delivery):
+        libneo.neo_device_options_set_delivery(self.options, delivery)
+
+    ### Pin the acquisition thread to the CPUs in the bit mask (0: not pinned)
+    def set_thread_affinity(self, cpu_mask):
+        libneo.neo_device_options_set_thread_affinity(self.options, cpu_mask)
+
+    ### SCHED_FIFO priority 1-99 for the acquisition thread (0: regular)
+    def set_thread_priority(self, priority):
+        libneo.neo_device_options_set_thread_priority(self.options, priority)
+
+    ### Name of the acquisition thread (default 'neo-scan')
+    def set_thread_name(self, name):
+        libneo.neo_device_options_set_thread_name(self.options, name.encode('ascii'))
+
+    ### Pre-fault and pin the scan buffers in memory
+    def set_lock_memory(self, lock):
+        libneo.neo_device_options_set_lock_memory(self.options, lock)
+
+    ### One of the SERIAL_PROFILE_* (default SERIAL_PROFILE_STANDARD)
+    def set_serial_profile(self, profile):
+        libneo.neo_device_options_set_serial_profile(self.options, profile)
+
+    ### Read the serial port through io_uring where available
+    def set_io_uring(self, enable):
+        libneo.neo_device_options_set_io_uring(self.options, enable)
+
+    ### Also publish full scans into shared memory ring `name` for ShmReader
+    def set_shm_ring(self, name, slots = 8):
+        libneo.neo_device_options_set_shm_ring(self.options, name.encode('ascii'), slots)
+
+    ### Also append full scans to the archive file at `path` for ArchiveReader
+    def set_archive(self, path, chunk_scans = 256):
+        libneo.neo_device_options_set_archive(self.options, path.encode(), chunk_scans)
+
+    ### Reopen the port and resume streaming when the link fails, retrying up to
+    ### every `max_backoff_ms`; `callback(status, reason)` runs on the acquisition
+    ### thread when scans stop and resume. 0 disables
+    def set_reconnect(self, max_backoff_ms, callback = None):
+        def report(status, reason, user_data):
+            callback(status, reason.decode() if reason else None)
+
+        # Kept alive with the options, which the device holds on to
+        self.status_callback = _status_callback(report) if callback else _status_callback()
+        libneo.neo_device_options_set_reconnect(self.options, max_backoff_ms, self.status_callback, None)
+
+    ### Also bin full scans into `bins` fixed angular bins (Scan.grid), 0 disables
+    def set_grid(self, bins, reduction = GRID_MIN):
+        libneo.neo_device_options_set_grid(self.options, bins, reduction)
+
+    ### Filter the grid over the last `window` scans, needs set_grid, 0 disables
+    def set_temporal_filter(self, window, mode = TEMPORAL_MEDIAN, tolerance = 10):
+        libneo.neo_device_options_set_temporal_filter(self.options, window, mode, tolerance)
+
+    ### Deliver only samples differing from a learned background, 0 bins disables
+    def set_background(self, bins, learning_scans = 50, min_change = 10):
+        libneo.neo_device_options_set_background(self.options, bins, learning_scans, min_change)
+
+    ### Also cluster full scans into objects (Scan.clusters), 0 max_gap disables
+    def set_clusters(self, max_gap, min_samples = 3):
+        libneo.neo_device_options_set_clusters(self.options, max_gap, min_samples)
+
+    ### Also track clusters across scans (Scan.tracks), needs set_clusters, 0 disables
+    def set_tracking(self, max_distance, max_misses = 5):
+        libneo.neo_device_options_set_tracking(self.options, max_distance, max_misses)
+
+    ### Scan matching odometry pairing points up to `max_distance` cm, 0 disables
+    def set_odometry(self, max_distance, keyframe_distance = 0, keyframe_angle = 0):
+        libneo.neo_device_options_set_odometry(self.options, max_distance, keyframe_distance, keyframe_angle)
+
+    ### CPU bit mask the odometry thread is pinned to
+    def set_odometry_affinity(self, cpu_mask):
+        libneo.neo_device_options_set_odometry_affinity(self.options, cpu_mask)
+
+    ### Cache file letting reopens of a still running unit skip the bring-up
+    def set_profile_cache(self, path):
+        libneo.neo_device_options_set_profile_cache(self.options, path.encode())
+
+
+class Scan(collections.namedtuple('Scan', 'samples grid clusters tracks timestamp')):
+    pass
+
+
+class Sector(collections.namedtuple('Sector', 'revolution index samples')):
     pass
 
 
@@ -83,58 +586,465 @@ class Sample(collections.namedtuple('Sample', 'angle distance signal_strength'))
     pass
 
 
-class neo:
-    ### Construct of neo class
-    def __init__(self, port, bitrate = None):
-        self.scoped = False
-        self.args = [port, bitrate]
-        self.scoped = True
-        self.device = None
+class Pose(collections.namedtuple('Pose', 'revolution x y heading covariance correspondences')):
+    pass
 
-        assert libneo.neo_is_abi_compatible(), 'Your installed libneo is not ABI compatible with these bindings'
 
-        error = ctypes.c_void_p();
+class Cluster(collections.namedtuple('Cluster', 'centroid_x centroid_y min_x min_y max_x max_y '
+                                     'first_sample last_sample sample_count')):
+    pass
 
-        simple = not self.args[1]
-        config = all(self.args)
 
-        assert simple or config, 'No arguments for bitrate, required'
+class Track(collections.namedtuple('Track', 'id x y velocity_x velocity_y age misses')):
+    pass
 
-        if simple:
-            port = ctypes.string_at(self.args[0].encode('ascii'))
-            device = libneo.neo_device_construct_simple(port, ctypes.byref(error))
 
-        if config:
-            port = ctypes.string_at(self.args[0].encode('ascii'))
-            bitrate = ctypes.c_int32(self.args[1])
-            device = libneo.neo_device_construct(port, bitrate, ctypes.byref(error))
+class ArchiveScan(collections.namedtuple('ArchiveScan', 'timestamp revolution angles distances')):
+    pass
+
+
+class Line(collections.namedtuple('Line', 'start_x start_y end_x end_y first_sample last_sample rms')):
+    pass
+
+
+class Identity(collections.namedtuple('Identity', 'model serial_number protocol_version '
+                                      'firmware_version hardware_version bit_rate '
+                                      'motor_speed sample_rate')):
+    pass
+
+
+class DiscoveredDevice(collections.namedtuple('DiscoveredDevice', 'port identity')):
+    pass
+
+
+class ShmReader:
+
+    ### Attach to the shared memory ring of a device in another process
+    def __init__(self, name):
+        error = ctypes.c_void_p()
+        self.reader = libneo.neo_shm_reader_construct(name.encode('ascii'), ctypes.byref(error))
 
         if error:
             raise _error_to_exception(error)
 
-        self.device = device
+        # reused for every read
+        self.scan = libneo.neo_scan_construct(None, None, 0, 0, -1, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+    def __del__(self):
+        if getattr(self, 'scan', None):
+            libneo.neo_scan_destruct(self.scan)
+
+        if getattr(self, 'reader', None):
+            libneo.neo_shm_reader_destruct(self.reader)
+
+    ### Next unread scan as a Sector (index -1), None on timeout (-1: wait forever)
+    def read(self, timeout_ms = -1):
+        error = ctypes.c_void_p()
+        ready = libneo.neo_shm_reader_read(self.reader, self.scan, timeout_ms, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+        if not ready:
+            return None
+
+        num_samples = libneo.neo_scan_get_number_of_samples(self.scan)
+
+        samples = [Sample(angle=libneo.neo_scan_get_angle(self.scan, n),
+                          distance=libneo.neo_scan_get_distance(self.scan, n),
+                          signal_strength=None)
+                   for n in range(num_samples)]
+
+        revolution = libneo.neo_scan_get_revolution(self.scan)
+
+        return Sector(revolution=revolution, index=-1, samples=samples)
+
+    ### Publisher's number of the last scan read
+    def get_sequence(self):
+        return libneo.neo_shm_reader_get_sequence(self.reader)
+
+    ### Scans skipped because the reader fell behind
+    def get_dropped(self):
+        return libneo.neo_shm_reader_get_dropped(self.reader)
+
+
+class ArchiveWriter:
+
+    ### Create the archive file at `path`, written in chunks of `chunk_scans` scans
+    def __init__(self, path, chunk_scans = 256):
+        error = ctypes.c_void_p()
+        self.writer = libneo.neo_archive_writer_construct(path.encode(), chunk_scans, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+    def __del__(self):
+        if getattr(self, 'writer', None):
+            libneo.neo_archive_writer_destruct(self.writer)
+
+    ### Append a Scan or Sector; never waits on the disk
+    def append(self, scan, revolution = 0):
+        count = len(scan.samples)
+        angles = (ctypes.c_float * count)(*[sample.angle for sample in scan.samples])
+        distances = (ctypes.c_int32 * count)(*[sample.distance for sample in scan.samples])
+        revolution = getattr(scan, 'revolution', revolution)
+
+        error = ctypes.c_void_p()
+        constructed = libneo.neo_scan_construct(angles, distances, count, revolution, -1, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+        try:
+            libneo.neo_scan_set_timestamp(constructed, getattr(scan, 'timestamp', 0))
+            libneo.neo_archive_writer_append(self.writer, constructed, ctypes.byref(error))
+
+            if error:
+                raise _error_to_exception(error)
+        finally:
+            libneo.neo_scan_destruct(constructed)
+
+    ### Wait until everything appended is in the file
+    def flush(self):
+        error = ctypes.c_void_p()
+        libneo.neo_archive_writer_flush(self.writer, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+    ### Scans not archived because the disk fell behind
+    def get_dropped(self):
+        return libneo.neo_archive_writer_get_dropped(self.writer)
+
+
+class ArchiveReader:
+
+    ### Map the archive file at `path`, seeing the scans written so far
+    def __init__(self, path):
+        error = ctypes.c_void_p()
+        self.reader = libneo.neo_archive_reader_construct(path.encode(), ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+    def __del__(self):
+        if getattr(self, 'reader', None):
+            libneo.neo_archive_reader_destruct(self.reader)
+
+    def __len__(self):
+        return libneo.neo_archive_reader_get_count(self.reader)
+
+    ### Number of the first scan at or after `timestamp` (us since the epoch), len() if none
+    def find(self, timestamp):
+        return libneo.neo_archive_reader_find(self.reader, timestamp)
+
+    ### Scan number `index` as an ArchiveScan; angles and distances are ctypes arrays
+    ### over the mapping, valid while the reader lives: numpy.frombuffer wraps them
+    ### without copying
+    def get(self, index):
+        if not 0 <= index < len(self):
+            raise IndexError('archived scan index out of range')
+
+        count = libneo.neo_archive_reader_get_number_of_samples(self.reader, index)
+        angles = libneo.neo_archive_reader_get_angles(self.reader, index)
+        distances = libneo.neo_archive_reader_get_distances(self.reader, index)
+
+        return ArchiveScan(timestamp=libneo.neo_archive_reader_get_timestamp(self.reader, index),
+                           revolution=libneo.neo_archive_reader_get_revolution(self.reader, index),
+                           angles=ctypes.cast(angles, ctypes.POINTER(ctypes.c_float * count)).contents,
+                           distances=ctypes.cast(distances, ctypes.POINTER(ctypes.c_int32 * count)).contents)
+
+
+def _scan_grid(scan):
+    bins = libneo.neo_scan_get_grid_bins(scan)
+
+    if bins == 0:
+        return None
+
+    ranges = (ctypes.c_int32 * bins)()
+    libneo.neo_scan_get_grid(scan, ranges, bins)
+    return list(ranges)
+
+
+def _to_clusters(clusters):
+    out = [Cluster(centroid_x=libneo.neo_clusters_get_centroid_x(clusters, n),
+                   centroid_y=libneo.neo_clusters_get_centroid_y(clusters, n),
+                   min_x=libneo.neo_clusters_get_min_x(clusters, n),
+                   min_y=libneo.neo_clusters_get_min_y(clusters, n),
+                   max_x=libneo.neo_clusters_get_max_x(clusters, n),
+                   max_y=libneo.neo_clusters_get_max_y(clusters, n),
+                   first_sample=libneo.neo_clusters_get_first_sample(clusters, n),
+                   last_sample=libneo.neo_clusters_get_last_sample(clusters, n),
+                   sample_count=libneo.neo_clusters_get_sample_count(clusters, n))
+           for n in range(libneo.neo_clusters_get_count(clusters))]
+
+    libneo.neo_clusters_destruct(clusters)
+    return out
+
+
+def _scan_clusters(scan):
+    error = ctypes.c_void_p()
+    clusters = libneo.neo_scan_get_clusters(scan, ctypes.byref(error))
+
+    if error:
+        raise _error_to_exception(error)
+
+    return _to_clusters(clusters)
+
+
+def _scan_tracks(scan):
+    error = ctypes.c_void_p()
+    tracks = libneo.neo_scan_get_tracks(scan, ctypes.byref(error))
+
+    if error:
+        raise _error_to_exception(error)
+
+    out = [Track(id=libneo.neo_tracks_get_id(tracks, n),
+                 x=libneo.neo_tracks_get_x(tracks, n),
+                 y=libneo.neo_tracks_get_y(tracks, n),
+                 velocity_x=libneo.neo_tracks_get_velocity_x(tracks, n),
+                 velocity_y=libneo.neo_tracks_get_velocity_y(tracks, n),
+                 age=libneo.neo_tracks_get_age(tracks, n),
+                 misses=libneo.neo_tracks_get_misses(tracks, n))
+           for n in range(libneo.neo_tracks_get_count(tracks))]
+
+    libneo.neo_tracks_destruct(tracks)
+    return out
+
+
+### Bins a Scan or Sector's samples into `bins` fixed angular bins, returns a list
+def resample_scan(scan, bins, reduction = GRID_MIN):
+    count = len(scan.samples)
+    angles = (ctypes.c_float * count)(*[sample.angle for sample in scan.samples])
+    distances = (ctypes.c_int32 * count)(*[sample.distance for sample in scan.samples])
+
+    error = ctypes.c_void_p()
+    constructed = libneo.neo_scan_construct(angles, distances, count, 0, -1, ctypes.byref(error))
+
+    if error:
+        raise _error_to_exception(error)
+
+    try:
+        ranges = (ctypes.c_int32 * bins)()
+        libneo.neo_scan_resample(constructed, bins, reduction, ranges, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+        return list(ranges)
+    finally:
+        libneo.neo_scan_destruct(constructed)
+
+
+### Clusters of a Scan or Sector's samples as objects, returns a list of Cluster
+def extract_clusters(scan, max_gap = 20, min_samples = 3):
+    count = len(scan.samples)
+    angles = (ctypes.c_float * count)(*[sample.angle for sample in scan.samples])
+    distances = (ctypes.c_int32 * count)(*[sample.distance for sample in scan.samples])
+
+    error = ctypes.c_void_p()
+    constructed = libneo.neo_scan_construct(angles, distances, count, 0, -1, ctypes.byref(error))
+
+    if error:
+        raise _error_to_exception(error)
+
+    try:
+        clusters = libneo.neo_scan_extract_clusters(constructed, max_gap, min_samples,
+                                                    ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+        return _to_clusters(clusters)
+    finally:
+        libneo.neo_scan_destruct(constructed)
+
+
+### Line segments of a Scan or Sector's samples in scan order, returns a list of Line
+def extract_lines(scan, max_deviation = 5, max_gap = 30, min_samples = 5):
+    count = len(scan.samples)
+    angles = (ctypes.c_float * count)(*[sample.angle for sample in scan.samples])
+    distances = (ctypes.c_int32 * count)(*[sample.distance for sample in scan.samples])
+
+    error = ctypes.c_void_p()
+    constructed = libneo.neo_scan_construct(angles, distances, count, 0, -1, ctypes.byref(error))
+
+    if error:
+        raise _error_to_exception(error)
+
+    try:
+        lines = libneo.neo_scan_extract_lines(constructed, max_deviation, max_gap, min_samples,
+                                              ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+        out = [Line(start_x=libneo.neo_lines_get_start_x(lines, n),
+                    start_y=libneo.neo_lines_get_start_y(lines, n),
+                    end_x=libneo.neo_lines_get_end_x(lines, n),
+                    end_y=libneo.neo_lines_get_end_y(lines, n),
+                    first_sample=libneo.neo_lines_get_first_sample(lines, n),
+                    last_sample=libneo.neo_lines_get_last_sample(lines, n),
+                    rms=libneo.neo_lines_get_rms(lines, n))
+               for n in range(libneo.neo_lines_get_count(lines))]
+
+        libneo.neo_lines_destruct(lines)
+        return out
+    finally:
+        libneo.neo_scan_destruct(constructed)
+
+
+### Compact binary encoding of a Scan or Sector's samples, returns bytes
+def encode_scan(scan, compress = False):
+    count = len(scan.samples)
+    angles = (ctypes.c_float * count)(*[sample.angle for sample in scan.samples])
+    distances = (ctypes.c_int32 * count)(*[sample.distance for sample in scan.samples])
+
+    # tuples have an index method, so check for sectors explicitly
+    revolution, index = (scan.revolution, scan.index) if isinstance(scan, Sector) else (0, -1)
+
+    error = ctypes.c_void_p()
+    constructed = libneo.neo_scan_construct(angles, distances, count, revolution, index, ctypes.byref(error))
+
+    if error:
+        raise _error_to_exception(error)
+
+    try:
+        capacity = libneo.neo_scan_encode_bound(constructed)
+        buffer = ctypes.create_string_buffer(capacity)
+
+        size = libneo.neo_scan_encode(constructed, ENCODE_COMPRESS if compress else 0,
+                                      buffer, capacity, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+        return buffer.raw[:size]
+    finally:
+        libneo.neo_scan_destruct(constructed)
+
+
+### Decodes bytes from encode_scan into a Sector; index is -1 for full scans
+def decode_scan(data):
+    error = ctypes.c_void_p()
+    scan = libneo.neo_scan_decode(data, len(data), ctypes.byref(error))
+
+    if error:
+        raise _error_to_exception(error)
+
+    num_samples = libneo.neo_scan_get_number_of_samples(scan)
+
+    samples = [Sample(angle=libneo.neo_scan_get_angle(scan, n),
+                      distance=libneo.neo_scan_get_distance(scan, n),
+                      signal_strength=None)
+               for n in range(num_samples)]
+
+    revolution = libneo.neo_scan_get_revolution(scan)
+    index = libneo.neo_scan_get_sector_index(scan)
+
+    libneo.neo_scan_destruct(scan)
+
+    return Sector(revolution=revolution, index=index, samples=samples)
+
+
+def _to_scan(scan):
+    num_samples = libneo.neo_scan_get_number_of_samples(scan)
+
+    samples = [Sample(angle=libneo.neo_scan_get_angle(scan, n),
+                      distance=libneo.neo_scan_get_distance(scan, n),
+                      signal_strength=libneo.neo_scan_get_signal_strength(scan, n))
+               for n in range(num_samples)]
+
+    return Scan(samples=samples, grid=_scan_grid(scan), clusters=_scan_clusters(scan),
+                tracks=_scan_tracks(scan), timestamp=libneo.neo_scan_get_timestamp(scan))
+
+
+def _to_identity(identity):
+    out = Identity(model=libneo.neo_identity_get_model(identity).decode('ascii'),
+                   serial_number=libneo.neo_identity_get_serial_number(identity).decode('ascii'),
+                   protocol_version=libneo.neo_identity_get_protocol_version(identity).decode('ascii'),
+                   firmware_version=libneo.neo_identity_get_firmware_version(identity).decode('ascii'),
+                   hardware_version=libneo.neo_identity_get_hardware_version(identity),
+                   bit_rate=libneo.neo_identity_get_bit_rate(identity),
+                   motor_speed=libneo.neo_identity_get_motor_speed(identity),
+                   sample_rate=libneo.neo_identity_get_sample_rate(identity))
+
+    libneo.neo_identity_destruct(identity)
+    return out
+
+
+### Devices (DiscoveredDevice tuples) on the USB serial ports of this machine, or
+### on `ports`, probed concurrently without starting their motors
+def discover(baudrate = 115200, timeout_ms = 500, ports = None):
+    error = ctypes.c_void_p()
+
+    if ports is None:
+        discovery = libneo.neo_discover(baudrate, timeout_ms, ctypes.byref(error))
+    else:
+        names = (ctypes.c_char_p * len(ports))(*[port.encode() for port in ports])
+        discovery = libneo.neo_discover_ports(names, len(ports), baudrate, timeout_ms, ctypes.byref(error))
+
+    if error:
+        raise _error_to_exception(error)
+
+    out = []
+
+    try:
+        for n in range(libneo.neo_discovery_get_count(discovery)):
+            identity = libneo.neo_discovery_get_identity(discovery, n, ctypes.byref(error))
+
+            if error:
+                raise _error_to_exception(error)
+
+            out.append(DiscoveredDevice(port=libneo.neo_discovery_get_port(discovery, n).decode(),
+                                        identity=_to_identity(identity)))
+    finally:
+        libneo.neo_discovery_destruct(discovery)
+
+    return out
+
+
+class neo:
+    ### Construct of neo class
+    def __init__(self, port, bitrate = None, options = None):
+        self.scoped = False
+        self.args = [port, bitrate, options]
+        self.scoped = True
+        self.device = None
+
+        self._construct()
 
     ### Build for `with` function
     def __enter__(self):
         self.scoped = True
         self.device = None
 
+        self._construct()
+
+        return self
+
+    def _construct(self):
         assert libneo.neo_is_abi_compatible(), 'Your installed libneo is not ABI compatible with these bindings'
 
         error = ctypes.c_void_p();
 
         simple = not self.args[1]
-        config = all(self.args)
+        config = all(self.args[:2])
+        options = self.args[2]
 
         assert simple or config, 'No arguments for bitrate, required'
 
-        if simple:
-            port = ctypes.string_at(self.args[0].encode('ascii'))
-            device = libneo.neo_device_construct_simple(port, ctypes.byref(error))
+        port = ctypes.string_at(self.args[0].encode('ascii'))
+        bitrate = ctypes.c_int32(self.args[1] or 115200)
 
-        if config:
-            port = ctypes.string_at(self.args[0].encode('ascii'))
-            bitrate = ctypes.c_int32(self.args[1])
+        if options:
+            device = libneo.neo_device_construct_with_options(port, bitrate, options.options, ctypes.byref(error))
+        elif simple:
+            device = libneo.neo_device_construct_simple(port, ctypes.byref(error))
+        else:
             device = libneo.neo_device_construct(port, bitrate, ctypes.byref(error))
 
         if error:
@@ -142,8 +1052,6 @@ class neo:
 
         self.device = device
 
-        return self
-
     ### Destruct of neo class
     def __exit__(self, *args):
         self.scoped = False
@@ -154,6 +1062,30 @@ class neo:
     def _assert_scoped(self):
         assert self.scoped, 'Use the `with` statement to guarantee for deterministic resource management'
 
+    ### Upper bound in bytes for the scans the queues can hold
+    def get_queue_memory_budget(self):
+        self._assert_scoped()
+
+        return libneo.neo_device_get_queue_memory_budget(self.device)
+
+    ### Reconnects after link failures so far, see DeviceOptions.set_reconnect
+    def get_reconnects(self):
+        self._assert_scoped()
+
+        return libneo.neo_device_get_reconnects(self.device)
+
+    ### Microseconds spent without a link so far
+    def get_downtime(self):
+        self._assert_scoped()
+
+        return libneo.neo_device_get_downtime(self.device)
+
+    ### Profile cache updates that could not be written, see DeviceOptions.set_profile_cache
+    def get_profile_cache_failures(self):
+        self._assert_scoped()
+
+        return libneo.neo_device_get_profile_cache_failures(self.device)
+
     ### Start scanning api, using C language neo_device_start_scanning function
     def start_scanning(self):
         self._assert_scoped()
@@ -218,6 +1150,26 @@ class neo:
         if error:
             raise _error_to_exception(error)
 
+    ### Pick motor speed and sample rate for an angular step in degrees
+    def set_target_resolution(self, degrees):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+        libneo.neo_device_set_target_resolution(self.device, degrees, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+    ### Pick the densest sample rate for `hz` revolutions per second
+    def set_target_update_rate(self, hz):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+        libneo.neo_device_set_target_update_rate(self.device, hz, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
     ### Get scan data
     def get_scans(self):
         self._assert_scoped()
@@ -230,16 +1182,140 @@ class neo:
             if error:
                 raise _error_to_exception(error)
 
-            num_samples = libneo.neo_scan_get_number_of_samples(scan)
+            out = _to_scan(scan)
+            libneo.neo_scan_destruct(scan)
+
+            yield out
+
+    ### Descriptor polling readable while scans are queued, for selectors and asyncio
+    def get_readiness_fd(self):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+        fd = libneo.neo_device_get_readiness_fd(self.device, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+        return fd
+
+    ### Get the oldest queued scan or None, never blocking
+    def try_get_scan(self):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+        scan = libneo.neo_device_try_get_scan(self.device, ctypes.byref(error))
 
-            samples = [Sample(angle=libneo.neo_scan_get_angle(scan, n),
-                              distance=libneo.neo_scan_get_distance(scan, n),
-                              signal_strength=libneo.neo_scan_get_signal_strength(scan, n))
+        if error:
+            raise _error_to_exception(error)
+
+        if not scan:
+            return None
+
+        out = _to_scan(scan)
+        libneo.neo_scan_destruct(scan)
+
+        return out
+
+    ### Get the newest scan or None, requires DELIVERY_LATEST
+    def get_latest_scan(self):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+        scan = libneo.neo_device_get_latest_scan(self.device, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+        if not scan:
+            return None
+
+        # owned by the device, no neo_scan_destruct
+        return _to_scan(scan)
+
+    ### Publish sectors of `degrees` as soon as they are complete, 0 disables
+    def set_sector_size(self, degrees):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+        libneo.neo_device_set_sector_size(self.device, degrees, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+    ### Get sector data
+    def get_sectors(self):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+
+        while True:
+            sector = libneo.neo_device_get_sector(self.device, ctypes.byref(error))
+
+            if error:
+                raise _error_to_exception(error)
+
+            num_samples = libneo.neo_scan_get_number_of_samples(sector)
+
+            samples = [Sample(angle=libneo.neo_scan_get_angle(sector, n),
+                              distance=libneo.neo_scan_get_distance(sector, n),
+                              signal_strength=None)
                        for n in range(num_samples)]
 
-            libneo.neo_scan_destruct(scan)
+            revolution = libneo.neo_scan_get_revolution(sector)
+            index = libneo.neo_scan_get_sector_index(sector)
+
+            libneo.neo_scan_destruct(sector)
+
+            yield Sector(revolution=revolution, index=index, samples=samples)
+
+    ### Learn the background anew, e.g. after moving the sensor
+    def relearn_background(self):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+        libneo.neo_device_relearn_background(self.device, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
+
+    ### Get odometry poses of full scans, requires set_odometry
+    def get_poses(self):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+
+        while True:
+            pose = libneo.neo_device_get_pose(self.device, ctypes.byref(error))
+
+            if error:
+                raise _error_to_exception(error)
+
+            covariance = (ctypes.c_float * 9)()
+            libneo.neo_pose_get_covariance(pose, covariance)
+
+            out = Pose(revolution=libneo.neo_pose_get_revolution(pose),
+                       x=libneo.neo_pose_get_x(pose),
+                       y=libneo.neo_pose_get_y(pose),
+                       heading=libneo.neo_pose_get_heading(pose),
+                       covariance=list(covariance),
+                       correspondences=libneo.neo_pose_get_correspondences(pose))
+
+            libneo.neo_pose_destruct(pose)
+
+            yield out
+
+    ### Model, versions, serial number and current settings
+    def get_identity(self):
+        self._assert_scoped()
+
+        error = ctypes.c_void_p()
+        identity = libneo.neo_device_get_identity(self.device, ctypes.byref(error))
+
+        if error:
+            raise _error_to_exception(error)
 
-            yield Scan(samples=samples)
+        return _to_identity(identity)
 
     ### Reset the device
     def reset(self):
@@ -0,0 +1,414 @@
+#include "archive.hpp"
+
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace neo {
+namespace archive {
+
+constexpr uint32_t file_magic = 0x4e454f41;   // "NEOA"
+constexpr uint32_t chunk_magic = 0x4e454f43;  // "NEOC"
+constexpr uint32_t version = 1;
+
+constexpr size_t alignment = 64;  // of every column, cache line and SIMD friendly
+constexpr size_t max_queued = 4;  // chunks waiting for the disk
+
+namespace {
+
+struct file_header {
+  uint32_t magic;
+  uint32_t version;
+  uint8_t reserved[56];
+};
+
+struct chunk_header {
+  uint32_t magic;
+  uint32_t scans;
+  uint64_t samples;
+  uint64_t size;  // including this header
+  uint64_t first_sequence;
+  int64_t first_timestamp;
+  int64_t last_timestamp;
+  uint8_t reserved[16];
+};
+
+static_assert(sizeof(file_header) == alignment, "archive header must keep chunks aligned.");
+static_assert(sizeof(chunk_header) == alignment, "chunk header must keep columns aligned.");
+
+// Offsets of a chunk's columns from its header
+struct layout {
+  uint64_t timestamps;
+  uint64_t revolutions;
+  uint64_t offsets;
+  uint64_t angles;
+  uint64_t distances;
+  uint64_t size;
+};
+
+}  // namespace
+
+static uint64_t padded(uint64_t bytes) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+static layout layout_of(uint64_t scans, uint64_t samples) {
+  layout out;
+  out.timestamps = sizeof(chunk_header);
+  out.revolutions = out.timestamps + padded(scans * sizeof(int64_t));
+  out.offsets = out.revolutions + padded(scans * sizeof(int32_t));
+  out.angles = out.offsets + padded((scans + 1) * sizeof(uint32_t));
+  out.distances = out.angles + padded(samples * sizeof(float));
+  out.size = out.distances + padded(samples * sizeof(int32_t));
+  return out;
+}
+
+static int64_t microseconds_since_epoch() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static int64_t steady_microseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Writes bytes and pads them to the alignment
+static void put(FILE* file, const void* data, uint64_t bytes) {
+  static const uint8_t zeros[alignment] = {};
+
+  const uint64_t padding = padded(bytes) - bytes;
+
+  if ( (bytes > 0 && fwrite(data, bytes, 1, file) != 1)
+      || (padding > 0 && fwrite(zeros, padding, 1, file) != 1) )
+    throw error{"writing scan archive failed."};
+}
+
+// Writer
+
+void writer::chunk::restart(uint64_t first) {
+  first_sequence = first;
+  timestamps.clear();
+  revolutions.clear();
+  offsets.assign(1, 0);
+  angles.clear();
+  distances.clear();
+}
+
+writer::writer(const char* path, int32_t chunk_scans)
+    : file(nullptr), chunk_scans(chunk_scans),
+    epoch_offset(microseconds_since_epoch() - steady_microseconds()),
+    open(new chunk), sequence(0), writing(false), closing(false),
+    failed(false), dropped_scans(0) {
+  NEO_ASSERT(path);
+  NEO_ASSERT(chunk_scans >= 1);
+
+  file = fopen(path, "wb");
+
+  if ( !file )
+    throw error{"creating scan archive failed."};
+
+  file_header head{};
+  head.magic = file_magic;
+  head.version = version;
+
+  if ( fwrite(&head, sizeof(head), 1, file) != 1 || fflush(file) != 0 ) {
+    fclose(file);
+    throw error{"writing scan archive failed."};
+  }
+
+  open->restart(0);
+
+  thread = std::thread(&writer::run, this);
+}
+
+writer::~writer() {
+  try {
+    flush();
+  } catch (...) {
+    // nothing we can do here
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closing = true;
+  }
+
+  wake.notify_one();
+  thread.join();
+
+  fclose(file);
+}
+
+void writer::append(const sample* samples, int32_t count, int32_t revolution,
+    int64_t timestamp) {
+  NEO_ASSERT(count >= 0 && count <= NEO_MAX_SAMPLES);
+  NEO_ASSERT(count == 0 || samples);
+
+  if ( failed ) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::rethrow_exception(failure);
+  }
+
+  std::lock_guard<std::mutex> filling(open_mutex);
+
+  const bool full = static_cast<int32_t>(open->timestamps.size()) >= chunk_scans;
+
+  // The disk is behind: keep what is queued, lose this scan
+  if ( full && !hand_off() ) {
+    ++dropped_scans;
+    return;
+  }
+
+  open->timestamps.push_back(timestamp != 0 ? timestamp + epoch_offset
+      : microseconds_since_epoch());
+  open->revolutions.push_back(revolution);
+
+  // Samples are stored as separate angle and distance columns
+  const size_t first = open->angles.size();
+  open->angles.resize(first + count);
+  open->distances.resize(first + count);
+
+  for ( int32_t n = 0; n < count; ++n ) {
+    open->angles[first + n] = samples[n].angle;
+    open->distances[first + n] = samples[n].distance;
+  }
+
+  open->offsets.push_back(static_cast<uint32_t>(first + count));
+  ++sequence;
+
+  // Retried on the next append if the queue is full
+  if ( static_cast<int32_t>(open->timestamps.size()) >= chunk_scans )
+    hand_off();
+}
+
+bool writer::hand_off() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if ( queued.size() >= max_queued )
+    return false;
+
+  queue_open();
+  return true;
+}
+
+void writer::queue_open() {
+  std::unique_ptr<chunk> next;
+
+  // Recycled chunks keep their capacity: no allocations once warmed up
+  if ( !spare.empty() ) {
+    next = std::move(spare.back());
+    spare.pop_back();
+  } else {
+    next.reset(new chunk);
+  }
+
+  next->restart(sequence);
+
+  queued.push_back(std::move(open));
+  open = std::move(next);
+
+  wake.notify_one();
+}
+
+void writer::flush() {
+  // Appending waits for the hand-over at most, never for the disk
+  for ( ;; ) {
+    {
+      std::lock_guard<std::mutex> filling(open_mutex);
+      std::lock_guard<std::mutex> lock(mutex);
+
+      if ( failure || open->timestamps.empty() )
+        break;
+
+      if ( queued.size() < max_queued ) {
+        queue_open();
+        break;
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this] { return queued.size() < max_queued || failure; });
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  written.wait(lock, [this] { return (queued.empty() && !writing) || failure; });
+
+  if ( failure )
+    std::rethrow_exception(failure);
+}
+
+void writer::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  for ( ;; ) {
+    wake.wait(lock, [this] { return !queued.empty() || closing; });
+
+    if ( queued.empty() )
+      return;
+
+    std::unique_ptr<chunk> next = std::move(queued.front());
+    queued.pop_front();
+    writing = true;
+
+    lock.unlock();
+
+    std::exception_ptr problem;
+
+    try {
+      write(*next);
+    } catch (...) {
+      problem = std::current_exception();
+    }
+
+    lock.lock();
+
+    writing = false;
+    spare.push_back(std::move(next));
+
+    // A partly written chunk ends the archive; readers ignore it
+    if ( problem ) {
+      failure = problem;
+      failed = true;
+      queued.clear();
+    }
+
+    written.notify_all();
+
+    if ( problem )
+      return;
+  }
+}
+
+void writer::write(const chunk& c) {
+  const uint64_t scans = c.timestamps.size();
+  const uint64_t samples = c.angles.size();
+
+  chunk_header head{};
+  head.magic = chunk_magic;
+  head.scans = static_cast<uint32_t>(scans);
+  head.samples = samples;
+  head.size = layout_of(scans, samples).size;
+  head.first_sequence = c.first_sequence;
+  head.first_timestamp = c.timestamps.front();
+  head.last_timestamp = c.timestamps.back();
+
+  put(file, &head, sizeof(head));
+  put(file, c.timestamps.data(), scans * sizeof(int64_t));
+  put(file, c.revolutions.data(), scans * sizeof(int32_t));
+  put(file, c.offsets.data(), (scans + 1) * sizeof(uint32_t));
+  put(file, c.angles.data(), samples * sizeof(float));
+  put(file, c.distances.data(), samples * sizeof(int32_t));
+
+  // Complete chunks reach the file one by one, for readers and crashes
+  if ( fflush(file) != 0 )
+    throw error{"writing scan archive failed."};
+}
+
+// Reader
+
+reader::reader(const char* path) : file(map_file(path)), scans(0) {
+  const uint8_t* data = file.data;
+  const uint64_t size = file.size;
+
+  file_header head;
+
+  if ( size < sizeof(head) ) {
+    unmap_file(file);
+    throw error{"not a scan archive."};
+  }
+
+  memcpy(&head, data, sizeof(head));
+
+  const char* problem = nullptr;
+
+  if ( head.magic != file_magic )
+    problem = "not a scan archive.";
+  else if ( head.version != version )
+    problem = "scan archive was written by an incompatible version.";
+
+  if ( problem ) {
+    unmap_file(file);
+    throw error{problem};
+  }
+
+  // Index the chunk headers; a torn or foreign tail ends the archive
+  uint64_t at = sizeof(head);
+
+  while ( size - at >= sizeof(chunk_header) ) {
+    chunk_header h;
+    memcpy(&h, data + at, sizeof(h));
+
+    if ( h.magic != chunk_magic || h.scans == 0 || h.scans > size
+        || h.samples > size || h.first_sequence != scans )
+      break;
+
+    const layout l = layout_of(h.scans, h.samples);
+
+    if ( h.size != l.size || h.size > size - at )
+      break;
+
+    const uint8_t* base = data + at;
+
+    chunk c;
+    c.first_sequence = h.first_sequence;
+    c.scans = h.scans;
+    c.last_timestamp = h.last_timestamp;
+    c.timestamps = reinterpret_cast<const int64_t*>(base + l.timestamps);
+    c.revolutions = reinterpret_cast<const int32_t*>(base + l.revolutions);
+    c.offsets = reinterpret_cast<const uint32_t*>(base + l.offsets);
+    c.angles = reinterpret_cast<const float*>(base + l.angles);
+    c.distances = reinterpret_cast<const int32_t*>(base + l.distances);
+
+    if ( c.offsets[0] != 0 || c.offsets[h.scans] != h.samples )
+      break;
+
+    // Decreasing offsets would make a view reach outside the mapping
+    if ( !std::is_sorted(c.offsets, c.offsets + h.scans + 1) )
+      break;
+
+    chunks.push_back(c);
+    scans += h.scans;
+    at += h.size;
+  }
+}
+
+reader::~reader() {
+  unmap_file(file);
+}
+
+const reader::chunk& reader::chunk_of(uint64_t index) const {
+  NEO_ASSERT(index < scans && "archived scan index out of bounds.");
+
+  const auto after = std::upper_bound(chunks.begin(), chunks.end(), index,
+      [](uint64_t i, const chunk& c) { return i < c.first_sequence; });
+
+  return *(after - 1);
+}
+
+uint64_t reader::find(int64_t timestamp) const {
+  const auto it = std::lower_bound(chunks.begin(), chunks.end(), timestamp,
+      [](const chunk& c, int64_t t) { return c.last_timestamp < t; });
+
+  if ( it == chunks.end() )
+    return scans;
+
+  const int64_t* first = std::lower_bound(it->timestamps,
+      it->timestamps + it->scans, timestamp);
+
+  return it->first_sequence + static_cast<uint64_t>(first - it->timestamps);
+}
+
+view reader::at(uint64_t index) const {
+  const chunk& c = chunk_of(index);
+  const uint64_t n = index - c.first_sequence;
+  const uint32_t offset = c.offsets[n];
+
+  return {c.timestamps[n], c.revolutions[n],
+    static_cast<int32_t>(c.offsets[n + 1] - offset), c.angles + offset,
+    c.distances + offset};
+}
+
+}  // namespace archive
+}  // namespace neo
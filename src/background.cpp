@@ -0,0 +1,62 @@
+#include "background.hpp"
+#include "grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace neo {
+namespace background {
+
+constexpr float sigmas = 3;
+constexpr int32_t change_slowdown = 16;
+
+model::model(int32_t bins, int32_t learning_scans, int32_t min_change)
+    : bin_of(grid::bin_table(bins)), bins(bins), changed(NEO_MAX_SAMPLES),
+    learning_scans(learning_scans),
+    min_change(static_cast<float>(min_change)), scans(0) {
+  NEO_ASSERT(learning_scans >= 1);
+  NEO_ASSERT(min_change >= 0);
+
+  relearn();
+}
+
+void model::relearn() {
+  std::fill(bins.begin(), bins.end(), bin{0, 0, 0});
+  scans = 0;
+}
+
+int32_t model::subtract(const sample* in, int32_t count, sample* out) {
+  NEO_ASSERT(count == 0 || (in && out));
+
+  const bool learned = scans >= learning_scans;
+  int32_t changed = 0;
+
+  for ( int32_t n = 0; n < count; ++n ) {
+    const sample current = in[n];
+    bin& b = bins[bin_of[grid::to_fixed(current.angle)]];
+
+    const float deviation = static_cast<float>(current.distance) - b.mean;
+    const float limit = std::max(min_change, sigmas * std::sqrt(b.variance));
+    const bool is_change = learned && b.seen > 0 && std::fabs(deviation) > limit;
+
+    // Plain average until the bin has seen enough, then exponential
+    b.seen = std::min(b.seen + 1, learning_scans);
+    const float rate = 1.0f / b.seen;
+
+    if ( is_change ) {
+      // Drift towards it, but a change must not widen the accepted spread
+      b.mean += rate / change_slowdown * deviation;
+      out[changed++] = current;
+      continue;
+    }
+
+    b.mean += rate * deviation;
+    b.variance = (1 - rate) * (b.variance + rate * deviation * deviation);
+  }
+
+  scans = std::min(scans + 1, learning_scans);
+  return changed;
+}
+
+}  // namespace background
+}  // namespace neo
@@ -0,0 +1,140 @@
+#include "clusters.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace neo {
+namespace clusters {
+
+constexpr int32_t min_distance = 2;  // cm, the device reports 1 for no return
+constexpr float degrees_per_radian = 180 / 3.14159265358979f;
+
+namespace {
+
+// A cluster in the making
+struct run {
+  double sx = 0;
+  double sy = 0;
+  float min_x = 0;
+  float min_y = 0;
+  float max_x = 0;
+  float max_y = 0;
+  int32_t first = -1;
+  int32_t last = -1;
+  int32_t count = 0;
+  float first_x = 0;  // for joining across 0 degrees
+  float first_y = 0;
+  float last_x = 0;   // for the gap to the next sample
+  float last_y = 0;
+
+  void add(int32_t index, float x, float y) {
+    if ( count == 0 ) {
+      min_x = max_x = first_x = x;
+      min_y = max_y = first_y = y;
+      first = index;
+    }
+
+    sx += x;
+    sy += y;
+    min_x = std::min(min_x, x);
+    min_y = std::min(min_y, y);
+    max_x = std::max(max_x, x);
+    max_y = std::max(max_y, y);
+    last = index;
+    last_x = x;
+    last_y = y;
+    ++count;
+  }
+
+  // Appends other, which continues this run past 360 degrees
+  void join(const run& other) {
+    sx += other.sx;
+    sy += other.sy;
+    min_x = std::min(min_x, other.min_x);
+    min_y = std::min(min_y, other.min_y);
+    max_x = std::max(max_x, other.max_x);
+    max_y = std::max(max_y, other.max_y);
+    last = other.last;
+    count += other.count;
+  }
+
+  cluster finish() const {
+    return {static_cast<float>(sx / count), static_cast<float>(sy / count),
+      min_x, min_y, max_x, max_y, first, last, count};
+  }
+};
+
+}  // namespace
+
+static bool within(float ax, float ay, float bx, float by, float gap) {
+  const float dx = ax - bx;
+  const float dy = ay - by;
+  return dx * dx + dy * dy <= gap * gap;
+}
+
+int32_t extract(const sample* samples, int32_t count, const settings& config,
+    cluster* out, int32_t capacity) {
+  NEO_ASSERT(count == 0 || samples);
+  NEO_ASSERT(capacity == 0 || out);
+  NEO_ASSERT(config.max_gap > 0);
+  NEO_ASSERT(config.min_samples >= 1);
+
+  int32_t written = 0;
+
+  const auto emit = [&](const run& r) {
+    if ( r.count >= config.min_samples && written < capacity )
+      out[written++] = r.finish();
+  };
+
+  // The first run may continue the last one across 0 degrees; hold it back
+  run head;
+  run current;
+
+  for ( int32_t n = 0; n < count; ++n ) {
+    if ( samples[n].distance < min_distance )
+      continue;
+
+    const float angle = samples[n].angle / degrees_per_radian;
+    const float x = samples[n].distance * std::cos(angle);
+    const float y = samples[n].distance * std::sin(angle);
+
+    if ( current.count > 0
+        && !within(x, y, current.last_x, current.last_y, config.max_gap) ) {
+      if ( head.count == 0 )
+        head = current;
+      else
+        emit(current);
+
+      current = run{};
+    }
+
+    current.add(n, x, y);
+  }
+
+  if ( head.count == 0 ) {
+    // One run or none: nothing to join
+    emit(current);
+    return written;
+  }
+
+  if ( within(current.last_x, current.last_y, head.first_x, head.first_y,
+        config.max_gap) ) {
+    current.join(head);
+    emit(current);
+    return written;
+  }
+
+  emit(current);
+
+  // The head goes first, making room if it has to
+  if ( head.count >= config.min_samples && capacity > 0 ) {
+    written = std::min(written + 1, capacity);
+    std::copy_backward(out, out + written - 1, out + written);
+    out[0] = head.finish();
+  }
+
+  return written;
+}
+
+}  // namespace clusters
+}  // namespace neo
@@ -0,0 +1,366 @@
+#include "neo.h"
+#include "codec.hpp"
+
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+namespace neo {
+namespace codec {
+
+constexpr uint8_t magic[2] = {'N', 'S'};
+constexpr uint8_t version = 1;
+
+constexpr int32_t header_bound = 4 + 3 * 5 + 5;
+constexpr int32_t sample_bound = 2 * 10;
+
+// Varints
+
+namespace {
+
+class writer {
+ public:
+  writer(uint8_t* out, int32_t capacity) : out(out), capacity(capacity) {}
+
+  void byte(uint8_t v) {
+    if ( size >= capacity )
+      throw error{"encoding buffer too small."};
+    out[size++] = v;
+  }
+
+  void bytes(const uint8_t* from, int32_t len) {
+    if ( len > capacity - size )
+      throw error{"encoding buffer too small."};
+    memcpy(out + size, from, len);
+    size += len;
+  }
+
+  void varint(uint64_t v) {
+    while ( v >= 0x80 ) {
+      byte(static_cast<uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    byte(static_cast<uint8_t>(v));
+  }
+
+  void zigzag(int64_t v) {
+    varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+  }
+
+  uint8_t* out;
+  int32_t capacity;
+  int32_t size = 0;
+};
+
+class reader {
+ public:
+  reader(const uint8_t* in, int32_t size) : in(in), size(size) {}
+
+  uint8_t byte() {
+    if ( position >= size )
+      throw error{"truncated encoded scan."};
+    return in[position++];
+  }
+
+  uint64_t varint() {
+    uint64_t v = 0;
+
+    for ( int32_t shift = 0; shift < 64; shift += 7 ) {
+      const uint8_t b = byte();
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+
+      if ( !(b & 0x80) )
+        return v;
+    }
+
+    throw error{"malformed varint in encoded scan."};
+  }
+
+  int64_t zigzag() {
+    const uint64_t v = varint();
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+
+  int32_t size32(uint64_t max) {
+    const uint64_t v = varint();
+    if ( v > max )
+      throw error{"value out of range in encoded scan."};
+    return static_cast<int32_t>(v);
+  }
+
+  int32_t int32(int64_t min, int64_t max) {
+    const int64_t v = zigzag();
+    if ( v < min || v > max )
+      throw error{"value out of range in encoded scan."};
+    return static_cast<int32_t>(v);
+  }
+
+  const uint8_t* in;
+  int32_t size;
+  int32_t position = 0;
+};
+
+}  // namespace
+
+// LZ77 in the spirit of LZ4: a token with literal and match length nibbles,
+// the literals, a 16 bit offset and extra length bytes for long runs. The
+// last sequence has literals only.
+
+constexpr int32_t min_match = 4;
+constexpr int32_t hash_bits = 12;
+
+static int32_t lz_bound(int32_t size) { return size + size / 255 + 16; }
+
+static uint32_t read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static void lz_length(writer& out, int32_t length) {
+  for ( ; length >= 255; length -= 255 )
+    out.byte(255);
+  out.byte(static_cast<uint8_t>(length));
+}
+
+static void lz_sequence(writer& out, const uint8_t* literals, int32_t literal_length,
+    int32_t offset, int32_t match_length) {
+  const int32_t match_code = match_length > 0 ? match_length - min_match : 0;
+
+  out.byte(static_cast<uint8_t>((std::min(literal_length, 15) << 4)
+        | std::min(match_code, 15)));
+
+  if ( literal_length >= 15 )
+    lz_length(out, literal_length - 15);
+
+  out.bytes(literals, literal_length);
+
+  if ( match_length == 0 )
+    return;
+
+  out.byte(static_cast<uint8_t>(offset));
+  out.byte(static_cast<uint8_t>(offset >> 8));
+
+  if ( match_code >= 15 )
+    lz_length(out, match_code - 15);
+}
+
+static void lz_compress(const uint8_t* in, int32_t size, writer& out) {
+  int32_t table[1 << hash_bits];
+  std::fill(std::begin(table), std::end(table), -1);
+
+  int32_t position = 0;
+  int32_t anchor = 0;
+
+  while ( position + min_match <= size ) {
+    const uint32_t sequence = read32(in + position);
+    const uint32_t hash = (sequence * 2654435761u) >> (32 - hash_bits);
+
+    const int32_t candidate = table[hash];
+    table[hash] = position;
+
+    if ( candidate < 0 || position - candidate > 0xffff
+        || read32(in + candidate) != sequence ) {
+      ++position;
+      continue;
+    }
+
+    int32_t length = min_match;
+    while ( position + length < size && in[candidate + length] == in[position + length] )
+      ++length;
+
+    lz_sequence(out, in + anchor, position - anchor, position - candidate, length);
+
+    position += length;
+    anchor = position;
+  }
+
+  lz_sequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+static int32_t lz_read_length(reader& in, int32_t nibble) {
+  int32_t length = nibble;
+
+  if ( nibble == 15 ) {
+    uint8_t b;
+    do {
+      b = in.byte();
+      length += b;
+      if ( length > (1 << 24) )
+        throw error{"malformed compressed scan."};
+    } while ( b == 255 );
+  }
+
+  return length;
+}
+
+static void lz_decompress(reader& in, uint8_t* out, int32_t size) {
+  int32_t produced = 0;
+
+  // Up to the literals-only sequence closing every block, even one whose
+  // last match already filled the output
+  for ( ;; ) {
+    const uint8_t token = in.byte();
+
+    const int32_t literal_length = lz_read_length(in, token >> 4);
+    if ( literal_length > size - produced || literal_length > in.size - in.position )
+      throw error{"malformed compressed scan."};
+
+    memcpy(out + produced, in.in + in.position, literal_length);
+    in.position += literal_length;
+    produced += literal_length;
+
+    if ( produced == size )
+      break;
+
+    const int32_t low = in.byte();
+    const int32_t offset = low | (in.byte() << 8);
+    const int32_t match_length = lz_read_length(in, token & 0x0f) + min_match;
+
+    if ( offset == 0 || offset > produced || match_length > size - produced )
+      throw error{"malformed compressed scan."};
+
+    // byte by byte: matches may overlap their own output
+    for ( int32_t n = 0; n < match_length; ++n, ++produced )
+      out[produced] = out[produced - offset];
+  }
+}
+
+// Compressed bodies are staged here. Kept per thread, so encoding and
+// decoding only allocate for a scan larger than any before on the thread.
+static uint8_t* scratch(int32_t size) {
+  thread_local std::vector<uint8_t> buffer;
+
+  if ( static_cast<int32_t>(buffer.size()) < size )
+    buffer.resize(size);
+
+  return buffer.data();
+}
+
+// Scan body
+
+static int32_t quantize_angle(float angle) {
+  return static_cast<int32_t>(std::lround(angle * 128));
+}
+
+static void encode_body(const neo_scan& scan, writer& out) {
+  int64_t previous_angle = 0;
+  int64_t previous_step = 0;
+  int64_t previous_distance = 0;
+
+  for ( int32_t n = 0; n < scan.count; ++n ) {
+    const int64_t angle = quantize_angle(scan.samples[n].angle);
+    const int64_t step = angle - previous_angle;
+    const int64_t distance = scan.samples[n].distance;
+
+    out.zigzag(step - previous_step);
+    out.zigzag(distance - previous_distance);
+
+    previous_angle = angle;
+    previous_step = step;
+    previous_distance = distance;
+  }
+}
+
+static void decode_body(reader& in, neo_scan& out) {
+  int64_t angle = 0;
+  int64_t step = 0;
+  int64_t distance = 0;
+
+  for ( int32_t n = 0; n < out.count; ++n ) {
+    step += in.zigzag();
+    angle += step;
+    distance += in.zigzag();
+
+    if ( angle < INT32_MIN || angle > INT32_MAX
+        || distance < INT32_MIN || distance > INT32_MAX )
+      throw error{"value out of range in encoded scan."};
+
+    out.samples[n].angle = static_cast<float>(angle) / 128;
+    out.samples[n].distance = static_cast<int32_t>(distance);
+  }
+}
+
+int32_t encode_bound(int32_t count) {
+  NEO_ASSERT(count >= 0 && count <= NEO_MAX_SAMPLES);
+
+  return header_bound + lz_bound(count * sample_bound);
+}
+
+int32_t encode(const neo_scan& scan, int32_t flags, uint8_t* out,
+    int32_t capacity) {
+  NEO_ASSERT(scan.count >= 0 && scan.count <= NEO_MAX_SAMPLES);
+  NEO_ASSERT(out);
+  NEO_ASSERT(capacity >= 0);
+
+  if ( flags & ~compress )
+    throw error{"unknown scan encoding flags."};
+
+  writer header{out, capacity};
+  header.bytes(magic, sizeof(magic));
+  header.byte(version);
+  header.byte(static_cast<uint8_t>(flags));
+  header.varint(static_cast<uint64_t>(scan.count));
+  header.zigzag(scan.revolution);
+  header.zigzag(scan.sector);
+
+  if ( !(flags & compress) ) {
+    encode_body(scan, header);
+    return header.size;
+  }
+
+  writer body{scratch(scan.count * sample_bound), scan.count * sample_bound};
+  encode_body(scan, body);
+
+  header.varint(static_cast<uint64_t>(body.size));
+
+  writer compressed{out + header.size, capacity - header.size};
+  lz_compress(body.out, body.size, compressed);
+
+  return header.size + compressed.size;
+}
+
+void decode(const uint8_t* in, int32_t size, neo_scan& out) {
+  NEO_ASSERT(in || size == 0);
+  NEO_ASSERT(size >= 0);
+
+  reader header{in, size};
+
+  if ( header.byte() != magic[0] || header.byte() != magic[1] )
+    throw error{"not an encoded scan."};
+
+  if ( header.byte() != version )
+    throw error{"unsupported encoded scan version."};
+
+  const uint8_t flags = header.byte();
+
+  if ( flags & ~compress )
+    throw error{"unknown flags in encoded scan."};
+
+  out.count = header.size32(NEO_MAX_SAMPLES);
+  out.revolution = header.int32(INT32_MIN, INT32_MAX);
+  out.sector = header.int32(INT32_MIN, INT32_MAX);
+  out.timestamp = 0;
+  out.grid.clear();  // derived data; not encoded
+  out.clusters.clear();
+  out.tracks.clear();
+
+  if ( !(flags & compress) ) {
+    decode_body(header, out);
+    return;
+  }
+
+  const int32_t raw_size = header.size32(NEO_MAX_SAMPLES * sample_bound);
+
+  uint8_t* raw = scratch(raw_size);
+  lz_decompress(header, raw, raw_size);
+
+  reader body{raw, raw_size};
+  decode_body(body, out);
+}
+
+}  // namespace codec
+}  // namespace neo
@@ -0,0 +1,64 @@
+#include "density.hpp"
+
+namespace neo {
+namespace density {
+
+// Scan packet size and bits on the wire per byte: start, 8 data, stop
+constexpr int32_t packet_bytes = 5;
+constexpr int32_t bits_per_byte = 10;
+
+constexpr int32_t max_motor_speed = 10;
+
+int32_t sample_rate_to_code(int32_t hz) {
+  for ( int32_t n = 0; n < 3; ++n )
+    if ( sample_rates[n] == hz )
+      return n + 1;
+
+  throw error{"sample rate must be 500, 750 or 1000 Hz."};
+}
+
+int32_t sample_rate_from_code(int32_t code) {
+  if ( code < 1 || code > 3 )
+    throw error{"device reported an unknown sample rate."};
+
+  return sample_rates[code - 1];
+}
+
+int32_t sample_budget(int32_t baudrate) {
+  NEO_ASSERT(baudrate > 0);
+
+  return baudrate / (bits_per_byte * packet_bytes);
+}
+
+setting for_resolution(float degrees, int32_t baudrate) {
+  NEO_ASSERT(degrees > 0);
+
+  const int32_t budget = sample_budget(baudrate);
+
+  for ( int32_t hz = max_motor_speed; hz >= 1; --hz ) {
+    for ( int32_t rate : sample_rates ) {
+      if ( rate > budget )
+        break;
+
+      if ( 360.0f * hz / rate <= degrees )
+        return {hz, rate};
+    }
+  }
+
+  throw error{"no motor speed and sample rate reach this resolution within the link's bandwidth."};
+}
+
+setting for_update_rate(int32_t motor_speed, int32_t baudrate) {
+  NEO_ASSERT(motor_speed >= 1 && motor_speed <= max_motor_speed);
+
+  const int32_t budget = sample_budget(baudrate);
+
+  for ( int32_t n = 2; n >= 0; --n )
+    if ( sample_rates[n] <= budget )
+      return {motor_speed, sample_rates[n]};
+
+  throw error{"the link's bandwidth does not carry the lowest sample rate."};
+}
+
+}  // namespace density
+}  // namespace neo
@@ -0,0 +1,106 @@
+#include "grid.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+namespace neo {
+namespace grid {
+
+std::vector<uint16_t> bin_table(int32_t bins) {
+  NEO_ASSERT(bins >= 1 && bins <= NEO_MAX_GRID_BINS);
+
+  std::vector<uint16_t> out(std::numeric_limits<uint16_t>::max() + 1);
+
+  for ( size_t angle = 0; angle < out.size(); ++angle ) {
+    const int64_t wrapped = angle % steps_per_revolution;
+    out[angle] = static_cast<uint16_t>(wrapped * bins / steps_per_revolution);
+  }
+
+  return out;
+}
+
+accumulator::accumulator(int32_t bins, int32_t reduction)
+    : reduction(reduction), bin_of(bin_table(bins)), value(bins), count(bins),
+    nearest(bins) {
+  NEO_ASSERT(reduction == NEO_GRID_MIN || reduction == NEO_GRID_NEAREST
+      || reduction == NEO_GRID_MEAN);
+}
+
+uint32_t accumulator::offset(uint16_t angle, uint16_t bin) const {
+  const int64_t wrapped = angle % steps_per_revolution;
+  const int64_t center = (2 * static_cast<int64_t>(bin) + 1) * steps_per_revolution;
+  const int64_t scaled = 2 * wrapped * bins();
+
+  return static_cast<uint32_t>(scaled > center ? scaled - center : center - scaled);
+}
+
+void accumulator::add(uint16_t angle, int32_t distance) {
+  const uint16_t bin = bin_of[angle];
+
+  switch ( reduction ) {
+    case NEO_GRID_MIN:
+      value[bin] = count[bin] == 0 ? distance : std::min<int64_t>(value[bin], distance);
+      break;
+
+    case NEO_GRID_NEAREST: {
+      const uint32_t off = offset(angle, bin);
+
+      if ( count[bin] == 0 || off < nearest[bin] ) {
+        value[bin] = distance;
+        nearest[bin] = off;
+      }
+      break;
+    }
+
+    case NEO_GRID_MEAN:
+      value[bin] += distance;
+      break;
+  }
+
+  ++count[bin];
+}
+
+void accumulator::finish(int32_t* out) {
+  NEO_ASSERT(out);
+
+  for ( size_t bin = 0; bin < count.size(); ++bin ) {
+    if ( count[bin] == 0 ) {
+      out[bin] = NEO_GRID_EMPTY;
+      continue;
+    }
+
+    if ( reduction == NEO_GRID_MEAN ) {
+      out[bin] = static_cast<int32_t>((value[bin] + count[bin] / 2) / count[bin]);
+    } else {
+      out[bin] = static_cast<int32_t>(value[bin]);
+    }
+  }
+
+  clear();
+}
+
+void accumulator::clear() {
+  std::fill(value.begin(), value.end(), 0);
+  std::fill(count.begin(), count.end(), 0);
+}
+
+void resample(const neo_scan& scan, int32_t bins, int32_t reduction, int32_t* out) {
+  // Callers resample scan after scan the same way: keep the last grid of
+  // each thread, finish() leaves it cleared for the next call
+  thread_local std::unique_ptr<accumulator> grid;
+  thread_local int32_t grid_reduction = 0;
+
+  if ( !grid || grid->bins() != bins || grid_reduction != reduction ) {
+    grid.reset(new accumulator{bins, reduction});
+    grid_reduction = reduction;
+  }
+
+  for ( int32_t n = 0; n < scan.count; ++n )
+    grid->add(to_fixed(scan.samples[n].angle), scan.samples[n].distance);
+
+  grid->finish(out);
+}
+
+}  // namespace grid
+}  // namespace neo
@@ -0,0 +1,185 @@
+#include "lines.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace neo {
+namespace lines {
+
+constexpr int32_t min_distance = 2;  // cm, the device reports 1 for no return
+constexpr float degrees_per_radian = 180 / 3.14159265358979f;
+
+namespace {
+
+// Running sums of a point set, enough for its total least squares line
+struct moments {
+  double count = 0;
+  double sx = 0;
+  double sy = 0;
+  double sxx = 0;
+  double syy = 0;
+  double sxy = 0;
+
+  void add(double x, double y) {
+    count += 1;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    syy += y * y;
+    sxy += x * y;
+  }
+
+  void merge(const moments& other) {
+    count += other.count;
+    sx += other.sx;
+    sy += other.sy;
+    sxx += other.sxx;
+    syy += other.syy;
+    sxy += other.sxy;
+  }
+};
+
+// Line through the centroid along the major axis
+struct line {
+  double cx;
+  double cy;
+  double nx;  // unit normal
+  double ny;
+  double rms;
+
+  double distance(double x, double y) const {
+    return std::fabs((x - cx) * nx + (y - cy) * ny);
+  }
+};
+
+line fit(const moments& m) {
+  const double cx = m.sx / m.count;
+  const double cy = m.sy / m.count;
+  const double vxx = m.sxx / m.count - cx * cx;
+  const double vyy = m.syy / m.count - cy * cy;
+  const double vxy = m.sxy / m.count - cx * cy;
+
+  const double theta = 0.5 * std::atan2(2 * vxy, vxx - vyy);
+  const double spread = std::hypot(0.5 * (vxx - vyy), vxy);
+  const double minor = 0.5 * (vxx + vyy) - spread;
+
+  return {cx, cy, -std::sin(theta), std::cos(theta), std::sqrt(std::max(minor, 0.0))};
+}
+
+// A segment in the making
+struct run {
+  moments sums;
+  int32_t first;
+  int32_t last;
+  double first_x;
+  double first_y;
+  double last_x;
+  double last_y;
+};
+
+}  // namespace
+
+static segment to_segment(const run& r) {
+  const line l = fit(r.sums);
+
+  // Projects onto the line
+  const auto project = [&l](double x, double y, float& px, float& py) {
+    const double offset = (x - l.cx) * l.nx + (y - l.cy) * l.ny;
+    px = static_cast<float>(x - offset * l.nx);
+    py = static_cast<float>(y - offset * l.ny);
+  };
+
+  segment out;
+  project(r.first_x, r.first_y, out.start_x, out.start_y);
+  project(r.last_x, r.last_y, out.end_x, out.end_y);
+  out.first = r.first;
+  out.last = r.last;
+  out.rms = static_cast<float>(l.rms);
+  return out;
+}
+
+void extract(const neo_scan& scan, const settings& config,
+    std::vector<segment>& out) {
+  NEO_ASSERT(config.max_deviation > 0);
+  NEO_ASSERT(config.max_gap > 0);
+  NEO_ASSERT(config.min_samples >= 2);
+
+  std::vector<run> runs;
+  run current{};
+  current.first = -1;
+
+  const auto close = [&]() {
+    if ( current.first >= 0 && current.sums.count >= config.min_samples )
+      runs.push_back(current);
+    current = run{};
+    current.first = -1;
+  };
+
+  for ( int32_t n = 0; n < scan.count; ++n ) {
+    const sample& s = scan.samples[n];
+
+    if ( s.distance < min_distance )
+      continue;
+
+    const double angle = s.angle / degrees_per_radian;
+    const double x = s.distance * std::cos(angle);
+    const double y = s.distance * std::sin(angle);
+
+    if ( current.first >= 0 ) {
+      const bool gap = std::hypot(x - current.last_x, y - current.last_y)
+        > config.max_gap;
+
+      // Two samples always fit; from three on the line is known
+      const bool off = current.sums.count >= 2
+        && fit(current.sums).distance(x, y) > config.max_deviation;
+
+      if ( gap || off )
+        close();
+    }
+
+    if ( current.first < 0 ) {
+      current.first = n;
+      current.first_x = x;
+      current.first_y = y;
+    }
+
+    current.sums.add(x, y);
+    current.last = n;
+    current.last_x = x;
+    current.last_y = y;
+  }
+
+  close();
+
+  // Merge neighbors that still form one line; half the deviation bounds
+  // the rms of samples spread evenly within it
+  std::vector<run> merged;
+
+  for ( const run& r : runs ) {
+    if ( !merged.empty() ) {
+      run& previous = merged.back();
+
+      moments joint = previous.sums;
+      joint.merge(r.sums);
+
+      const bool adjacent = std::hypot(r.first_x - previous.last_x,
+          r.first_y - previous.last_y) <= config.max_gap;
+
+      if ( adjacent && fit(joint).rms <= config.max_deviation / 2 ) {
+        previous.sums = joint;
+        previous.last = r.last;
+        previous.last_x = r.last_x;
+        previous.last_y = r.last_y;
+        continue;
+      }
+    }
+
+    merged.push_back(r);
+  }
+
+  for ( const run& r : merged )
+    out.push_back(to_segment(r));
+}
+
+}  // namespace lines
+}  // namespace neo
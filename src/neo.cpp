@@ -2,15 +2,37 @@
 #include "neo.h"
 #include "protocol.hpp"
 #include "serial.hpp"
+#include "transport.hpp"
 #include "queue.hpp"
+#include "triple_buffer.hpp"
+#include "thread.hpp"
 #include "error.hpp"
+#include "scan.hpp"
+#include "codec.hpp"
+#include "shm.hpp"
+#include "archive.hpp"
+#include "remote.hpp"
+#include "density.hpp"
+#include "profile.hpp"
+#include "grid.hpp"
+#include "background.hpp"
+#include "temporal.hpp"
+#include "odometry.hpp"
+#include "lines.hpp"
+#include "clusters.hpp"
+#include "tracking.hpp"
+#include "event.hpp"
 
 #include <chrono>
+#include <condition_variable>
+#include <ctime>
 #include <thread>
 #include <algorithm>
 #include <utility>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 int32_t neo_get_version(void) { return NEO_VERSION; }
 bool neo_is_abi_compatible(void) {
@@ -21,8 +43,83 @@ struct neo_error {
   std::string what;
 };
 
+struct neo_device_options {
+  int32_t queue_depth;
+  neo::queue::policy queue_policy;
+  int32_t delivery;  // neo_delivery_mode
+
+  // acquisition thread scheduling
+  uint64_t cpu_affinity;    // CPU bit mask, 0 leaves the thread unpinned
+  int32_t thread_priority;  // SCHED_FIFO priority, 0 keeps default scheduling
+  std::string thread_name;
+  bool lock_memory;         // pre-fault and pin the scan buffers
+
+  neo::serial::profile serial_profile;
+  bool io_uring;
+
+  std::string shm_name;  // shared memory ring for full scans, empty disables
+  int32_t shm_slots;
+
+  std::string archive_path;  // columnar archive of full scans, empty disables
+  int32_t archive_chunk_scans;
+
+  std::string profile_cache;  // bring-up profile cache file, empty disables
+
+  int32_t reconnect_max_backoff;  // ms, reopening failed links, 0 disables
+  neo_status_callback status_callback;
+  void* status_user_data;
+
+  int32_t grid_bins;  // fixed angular grid for full scans, 0 disables
+  int32_t grid_reduction;
+
+  int32_t temporal_window;  // temporal filtering of the grid, 0 disables
+  int32_t temporal_mode;
+  int32_t temporal_tolerance;
+
+  int32_t background_bins;  // background subtraction, 0 disables
+  int32_t background_learning_scans;
+  int32_t background_min_change;
+
+  int32_t cluster_max_gap;  // clustering of full scans, 0 disables
+  int32_t cluster_min_samples;
+
+  int32_t tracking_max_distance;  // tracking of clusters, 0 disables
+  int32_t tracking_max_misses;
+
+  int32_t odometry_max_distance;  // scan matching odometry, 0 disables
+  int32_t odometry_keyframe_distance;
+  int32_t odometry_keyframe_angle;
+  uint64_t odometry_cpu_affinity;  // of the odometry thread, 0 leaves it unpinned
+};
+
+static neo_device_options neo_device_options_default() {
+  return {/*queue_depth=*/20, /*queue_policy=*/neo::queue::policy::drop_oldest,
+    /*delivery=*/NEO_DELIVERY_QUEUE, /*cpu_affinity=*/0, /*thread_priority=*/0,
+    /*thread_name=*/"neo-scan", /*lock_memory=*/false,
+    /*serial_profile=*/neo::serial::profile::standard, /*io_uring=*/false,
+    /*shm_name=*/"", /*shm_slots=*/0, /*archive_path=*/"",
+    /*archive_chunk_scans=*/0, /*profile_cache=*/"",
+    /*reconnect_max_backoff=*/0, /*status_callback=*/nullptr,
+    /*status_user_data=*/nullptr,
+    /*grid_bins=*/0, /*grid_reduction=*/NEO_GRID_MIN,
+    /*temporal_window=*/0, /*temporal_mode=*/NEO_TEMPORAL_MEDIAN,
+    /*temporal_tolerance=*/0,
+    /*background_bins=*/0, /*background_learning_scans=*/0,
+    /*background_min_change=*/0, /*cluster_max_gap=*/0,
+    /*cluster_min_samples=*/0, /*tracking_max_distance=*/0,
+    /*tracking_max_misses=*/0, /*odometry_max_distance=*/0,
+    /*odometry_keyframe_distance=*/0, /*odometry_keyframe_angle=*/0,
+    /*odometry_cpu_affinity=*/0};
+}
+
+struct neo_pose {
+  neo::odometry::estimate estimate;
+};
+
 struct neo_device {
-  neo::serial::device_s serial;  // serial port communication
+  neo::transport::transport_s transport;  // device bytes, nullptr for neo://
+  int32_t baudrate;                       // of the link, bounds the sample rate
+  neo_device_options options;             // as given at construction
   bool is_scanning;
 
   std::atomic<bool> stop_thread;
@@ -31,293 +128,2559 @@ struct neo_device {
     std::exception_ptr error;
   };
 
-  neo::queue::queue<Element> scan_queue;
-};
+  neo::queue::queue<Element> scan_queue;
+
+  int32_t sector_size;  // in degrees, 0 disables sector streaming
+  neo::queue::queue<Element> sector_queue;
+
+  // Set while scan_queue holds scans, once the application asked for it
+  neo::event::flag_s scan_readiness;
+
+  // Full scans go here instead of scan_queue with NEO_DELIVERY_LATEST
+  std::unique_ptr<neo::triple_buffer::triple_buffer<neo_scan>> latest_scan;
+  std::atomic<bool> has_worker_error;
+  std::exception_ptr worker_error;  // written before has_worker_error is set
+
+  // Full scans are additionally published here for other processes
+  neo::shm::publisher_s shm_publisher;
+
+  // And appended to this archive, which writes them out on its own thread
+  std::unique_ptr<neo::archive::writer> archive;
+
+  // neo:// devices receive their scans from neod instead of the serial port
+  std::unique_ptr<neo::remote::endpoint> remote;
+  neo::remote::info remote_info;
+  neo::remote::connection_s connection;  // while scanning
+
+  std::thread worker;  // owned acquisition thread; joined on stop
+
+  // Full scans go to the odometry thread through odometry_queue, never
+  // blocking acquisition; its poses come back through pose_queue
+  struct PoseElement {
+    std::unique_ptr<neo_pose> pose;
+    std::exception_ptr error;
+  };
+
+  neo::queue::queue<Element> odometry_queue;
+  neo::queue::queue<PoseElement> pose_queue;
+  std::thread odometry_worker;  // runs alongside worker while enabled
+
+  // Outlives scanning sessions; only the worker touches it while it runs
+  std::unique_ptr<neo::background::model> background;
+  std::atomic<bool> relearn_background;
+
+  // Reset for every scanning session; only the worker touches it while it runs
+  std::unique_ptr<neo::tracking::tracker> tracker;
+
+  // This unit's entry in options.profile_cache, kept current on motor speed
+  // changes and calibrations; the serial number is empty while disabled
+  neo::profile::profile profile;
+
+  // With options.reconnect_max_backoff the worker replaces a failed
+  // transport by a new one on port; transport is nullptr in between.
+  // The mutex orders the replacement against interrupts from stop.
+  std::string port;
+  std::mutex transport_mutex;
+  std::condition_variable reconnect_wake;  // cuts the backoff short on stop
+  neo::transport::interrupter_s connect_interrupter;  // and a connect
+  std::atomic<int64_t> reconnects;
+  std::atomic<int64_t> downtime;  // us
+
+  // Writes to options.profile_cache that failed
+  std::atomic<int64_t> profile_cache_failures;
+};
+
+struct neo_shm_reader {
+  neo::shm::reader_s reader;
+};
+
+struct neo_archive_writer {
+  std::unique_ptr<neo::archive::writer> writer;
+};
+
+struct neo_archive_reader {
+  std::unique_ptr<neo::archive::reader> reader;
+};
+
+struct neo_lines {
+  std::vector<neo::lines::segment> segments;
+};
+
+struct neo_clusters {
+  std::vector<cluster> clusters;
+};
+
+struct neo_tracks {
+  std::vector<track> tracks;
+};
+
+struct neo_identity {
+  std::string model;
+  std::string serial_number;
+  std::string protocol_version;
+  std::string firmware_version;
+  int32_t hardware_version;
+  int32_t bit_rate;
+  int32_t motor_speed;
+  int32_t sample_rate;
+};
+
+struct neo_discovery {
+  std::vector<std::string> ports;
+  std::vector<neo_identity> identities;
+};
+
+static sample parse_payload(const neo::protocol::response_scan_packet_s &msg) {
+  sample ret;
+  ret.angle = static_cast<float>(msg.angle) / 128; // angle / 128
+  ret.distance = ((int32_t)msg.distance_low)
+    + ((int32_t)msg.distance_high << 5);
+
+  return ret;
+}
+
+// Microseconds on the steady clock, stamped on scans as they complete
+static int64_t neo_scan_timestamp() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void neo_scan_fill(neo_scan& out, const sample* samples,
+    int32_t count, int32_t revolution, int32_t sector, int64_t timestamp) {
+  out.count = count;
+  out.revolution = revolution;
+  out.sector = sector;
+  out.timestamp = timestamp;
+  out.grid.clear();
+  out.clusters.clear();
+  out.tracks.clear();
+  std::copy_n(samples, count, std::begin(out.samples));
+}
+
+// Clusters the scan's samples in place and tracks the clusters, if enabled
+static void neo_device_analyze(neo_device_s device, neo_scan& out) {
+  const auto& options = device->options;
+
+  if ( options.cluster_max_gap <= 0 )
+    return;
+
+  // A cluster takes at least one sample
+  out.clusters.resize(std::min<int32_t>(out.count, NEO_MAX_CLUSTERS));
+  out.clusters.resize(neo::clusters::extract(out.samples, out.count,
+      {static_cast<float>(options.cluster_max_gap), options.cluster_min_samples},
+      out.clusters.data(), static_cast<int32_t>(out.clusters.size())));
+
+  if ( device->tracker ) {
+    out.tracks.resize(NEO_MAX_TRACKS);
+    out.tracks.resize(device->tracker->update(out.clusters.data(),
+        static_cast<int32_t>(out.clusters.size()), out.timestamp,
+        out.tracks.data()));
+  }
+}
+
+// Hands the binned scan over to out and starts binning the next one;
+// with a temporal filter out gets the grid filtered over the last scans
+static void neo_scan_fill_grid(neo_scan& out, neo::grid::accumulator* grid,
+    neo::temporal::filter* denoise) {
+  if ( !grid )
+    return;
+
+  out.grid.resize(grid->bins());
+  grid->finish(out.grid.data());
+
+  if ( denoise )
+    denoise->apply(out.grid.data());
+}
+
+// Copies the samples into a freshly allocated scan and hands it to the queue
+static void neo_device_publish(neo::queue::queue<neo_device::Element>& queue,
+    const sample* samples, int32_t count, int32_t revolution, int32_t sector,
+    int64_t timestamp, neo::grid::accumulator* grid = nullptr,
+    neo::temporal::filter* denoise = nullptr, neo_device_s analyzing = nullptr) {
+  auto out = std::unique_ptr<neo_scan>(new neo_scan);
+  neo_scan_fill(*out, samples, count, revolution, sector, timestamp);
+  neo_scan_fill_grid(*out, grid, denoise);
+
+  if ( analyzing )
+    neo_device_analyze(analyzing, *out);
+
+  queue.enqueue({std::move(out), nullptr});
+}
+
+// Keeps a buffer resident in physical memory while in scope, if asked to
+// and allowed to; otherwise it quietly stays pageable
+class scoped_memory_lock {
+ public:
+  scoped_memory_lock(const void* address, size_t length, bool enable)
+      : address(address), length(length),
+      locked(enable && neo::thread::lock_memory(address, length)) {}
+
+  ~scoped_memory_lock() {
+    if ( locked )
+      neo::thread::unlock_memory(address, length);
+  }
+
+  scoped_memory_lock(const scoped_memory_lock&) = delete;
+  scoped_memory_lock& operator=(const scoped_memory_lock&) = delete;
+
+ private:
+  const void* address;
+  size_t length;
+  bool locked;
+};
+
+// Applies the scheduling options to the calling thread; falls back quietly
+// to default scheduling where the platform or permissions do not allow it
+static void neo_device_configure_worker(const neo_device_options& options) {
+  if ( !options.thread_name.empty() )
+    neo::thread::set_name(options.thread_name.c_str());
+
+  if ( options.cpu_affinity != 0 )
+    neo::thread::set_affinity(options.cpu_affinity);
+
+  if ( options.thread_priority > 0 )
+    neo::thread::set_realtime_priority(options.thread_priority);
+}
+
+static neo::serial::config neo_device_serial_config(
+    const neo_device_options& options) {
+  neo::serial::config out;
+  out.latency_profile = options.serial_profile;
+  out.io_uring = options.io_uring;
+  return out;
+}
+
+// Tells the application about connection changes, if it asked to
+static void neo_device_report_status(neo_device_s device, int32_t status,
+    const char* reason) {
+  if ( device->options.status_callback )
+    device->options.status_callback(status, reason, device->options.status_user_data);
+}
+
+// How long a command waits for the unit's reply: a unit may not answer at
+// all (still booting, motor not ready, hung)
+constexpr auto neo_answer_timeout = std::chrono::seconds(2);
+
+// Runs a command/reply exchange with the unit. A read still waiting for the
+// reply neo_answer_timeout after the start throws a transport error saying
+// `what`; stopping interrupts the transport, which ends the exchange too.
+template <typename Exchange>
+static void neo_device_exchange(neo_device_s device, const char* what,
+    Exchange exchange) {
+  neo::transport::transport_set_deadline(device->transport,
+      std::chrono::steady_clock::now() + neo_answer_timeout);
+
+  const auto finish = [device] {
+    neo::transport::transport_set_deadline(device->transport,
+        neo::transport::deadline::max());
+  };
+
+  try {
+    exchange();
+  } catch (const neo::transport::timed_out&) {
+    finish();
+    throw neo::transport::error{what};
+  } catch (...) {
+    finish();
+    throw;
+  }
+
+  finish();
+}
+
+// A unit that kept streaming through the outage is stopped first: whatever
+// it sends before DS is answered would be taken for the response. Not
+// answering in time counts as an ordinary failed attempt.
+static void neo_device_restart_streaming(neo_device_s device) {
+  neo_device_exchange(device, "device did not answer while reconnecting.",
+      [device] {
+    neo::protocol::write_command(device->transport,
+        neo::protocol::DATA_ACQUISITION_STOP);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(35));
+
+    // Also drops an interrupt from stop, which is seen by then
+    neo::transport::transport_flush(device->transport);
+
+    if ( device->stop_thread )
+      throw neo::transport::interrupted{"scanning stopped while reconnecting."};
+
+    neo::protocol::write_command(device->transport,
+        neo::protocol::DATA_ACQUISITION_START);
+
+    neo::protocol::read_response_header(device->transport,
+        neo::protocol::DATA_ACQUISITION_START);
+  });
+}
+
+static bool neo_device_reconnect(neo_device_s device, const char* reason) {
+  const auto& options = device->options;
+
+  if ( options.reconnect_max_backoff <= 0
+      || !neo::transport::transport_interactive(device->transport) )
+    return false;
+
+  const int64_t lost_at = neo_scan_timestamp();
+
+  neo_device_report_status(device, NEO_STATUS_DISCONNECTED, reason);
+
+  try {
+    int32_t backoff = std::min(50, options.reconnect_max_backoff);
+
+    for ( ;; ) {
+      // Closed before waiting: an adapter coming back needs its old one gone
+      {
+        std::unique_lock<std::mutex> lock(device->transport_mutex);
+
+        if ( device->transport ) {
+          neo::transport::transport_destruct(device->transport);
+          device->transport = nullptr;
+        }
+
+        if ( device->reconnect_wake.wait_for(lock, std::chrono::milliseconds(backoff),
+              [device] { return device->stop_thread.load(); }) )
+          throw neo::transport::interrupted{"scanning stopped while reconnecting."};
+      }
+
+      backoff = std::min(2 * backoff, options.reconnect_max_backoff);
+
+      try {
+        const auto transport = neo::transport::transport_construct(
+            device->port.c_str(), device->baudrate, neo_device_serial_config(options),
+            device->connect_interrupter);
+
+        {
+          std::lock_guard<std::mutex> lock(device->transport_mutex);
+          device->transport = transport;
+        }
+
+        neo_device_restart_streaming(device);
+        break;
+      } catch (const neo::transport::interrupted&) {
+        throw;
+      } catch (const std::exception&) {
+        // still gone, or not answering yet
+      }
+    }
+  } catch (...) {
+    device->downtime += neo_scan_timestamp() - lost_at;
+    throw;
+  }
+
+  device->downtime += neo_scan_timestamp() - lost_at;
+  ++device->reconnects;
+
+  neo_device_report_status(device, NEO_STATUS_RECONNECTED, nullptr);
+  return true;
+}
+
+// Worker thread is dead at this point; tell consumers of either queue
+static void neo_device_worker_failed(neo_device_s device,
+    std::exception_ptr error) {
+  device->worker_error = error;
+  device->has_worker_error = true;
+  device->scan_queue.enqueue_final({nullptr, error});
+  device->sector_queue.enqueue_final({nullptr, error});
+
+  // Passed on to pose_queue by the odometry thread, which then exits
+  if ( device->options.odometry_max_distance > 0 )
+    device->odometry_queue.enqueue_final({nullptr, error});
+}
+
+// Hands a copy of a full scan to the odometry thread, if enabled
+static void neo_device_feed_odometry(neo_device_s device,
+    const sample* samples, int32_t count, int32_t revolution,
+    int64_t timestamp) {
+  if ( device->options.odometry_max_distance > 0 )
+    neo_device_publish(device->odometry_queue, samples, count, revolution,
+        /*sector=*/-1, timestamp);
+}
+
+// Registers the full scans acquisition hands over, off its thread; ends
+// on an empty element
+static void neo_device_track_odometry(neo_device_s device) try {
+  NEO_ASSERT(device);
+
+  neo::thread::set_name("neo-odometry");
+
+  const auto& options = device->options;
+
+  // Best effort, like the acquisition thread's scheduling
+  if ( options.odometry_cpu_affinity != 0 )
+    neo::thread::set_affinity(options.odometry_cpu_affinity);
+
+  neo::odometry::matcher matcher{{
+    static_cast<float>(options.odometry_max_distance),
+    static_cast<float>(options.odometry_keyframe_distance),
+    static_cast<float>(options.odometry_keyframe_angle)}};
+
+  for ( ;; ) {
+    auto in = device->odometry_queue.dequeue();
+
+    if ( !in.scan ) {
+      if ( in.error )
+        device->pose_queue.enqueue_final({nullptr, in.error});
+      return;
+    }
+
+    std::unique_ptr<neo_pose> out{new neo_pose{matcher.add(in.scan->samples,
+        in.scan->count, in.scan->revolution)}};
+    device->pose_queue.enqueue({std::move(out), nullptr});
+  }
+} catch (...) {
+  device->pose_queue.enqueue_final({nullptr, std::current_exception()});
+}
+
+// Keeps the samples of a full scan that differ from the learned background
+static int32_t neo_device_subtract_background(neo_device_s device,
+    const sample* samples, int32_t count, sample* changed) {
+  if ( device->relearn_background.exchange(false) )
+    device->background->relearn();
+
+  return device->background->subtract(samples, count, changed);
+}
+
+static void neo_device_accumulate_scans(neo_device_s device) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(device->is_scanning);
+
+  neo_device_configure_worker(device->options);
+
+  sample buffer[NEO_MAX_SAMPLES];
+  int32_t received = 0;
+  int32_t revolution = 0;
+
+  // Only used when sector streaming is enabled
+  sample sector_buffer[NEO_MAX_SAMPLES];
+  int32_t sector_received = 0;
+  int32_t sector = 0;
+
+  // Only used when grid binning is enabled
+  std::unique_ptr<neo::grid::accumulator> grid;
+
+  // Only used when the grid is filtered over time
+  std::unique_ptr<neo::temporal::filter> denoise;
+
+  // Only used when background subtraction is enabled; owned by the model
+  sample* changed = device->background ? device->background->changes() : nullptr;
+
+  if ( device->options.grid_bins > 0 ) {
+    grid.reset(new neo::grid::accumulator{device->options.grid_bins,
+        device->options.grid_reduction});
+  }
+
+  if ( device->options.temporal_window > 0 ) {
+    denoise.reset(new neo::temporal::filter{device->options.grid_bins,
+        device->options.temporal_window, device->options.temporal_mode,
+        device->options.temporal_tolerance});
+  }
+
+  const bool lock = device->options.lock_memory;
+  const scoped_memory_lock buffer_lock{buffer, sizeof(buffer), lock};
+  const scoped_memory_lock sector_buffer_lock{sector_buffer,
+    sizeof(sector_buffer), lock && device->sector_size > 0};
+  const scoped_memory_lock changed_lock{changed,
+    NEO_MAX_SAMPLES * sizeof(sample), lock && changed};
+
+  while ( !device->stop_thread && received < NEO_MAX_SAMPLES ) {
+    // read_response_scan throws transport::interrupted once stop is requested
+    neo::protocol::response_scan_packet_s response;
+
+    try {
+      response = neo::protocol::read_response_scan(device->transport);
+    } catch (const neo::transport::interrupted&) {
+      throw;
+    } catch (const std::exception& e) {
+      if ( !neo_device_reconnect(device, e.what()) )
+        throw;
+
+      // The revolution in progress is lost with the link
+      received = 0;
+      sector_received = 0;
+
+      if ( grid )
+        grid->clear();
+
+      continue;
+    }
+
+    buffer[received++] = parse_payload(response);
+
+    const bool is_sync = response.s1
+      & neo::protocol::response_scan_packet_sync::sync;
+
+    const bool is_new_revolution = received > 2
+      && (is_sync || (buffer[received-2].angle > buffer[received-1].angle));
+
+    if ( device->sector_size > 0 ) {
+      const sample& latest = buffer[received - 1];
+      const int32_t index = static_cast<int32_t>(latest.angle)
+        / device->sector_size;
+
+      // The sector is complete as soon as the first sample past it arrives
+      if ( sector_received > 0 && (is_new_revolution || index != sector) ) {
+        neo_device_publish(device->sector_queue, sector_buffer,
+            sector_received, revolution, sector, neo_scan_timestamp());
+        sector_received = 0;
+      }
+
+      sector = index;
+      sector_buffer[sector_received++] = latest;
+    }
+
+    if ( is_new_revolution ) {
+      const sample* samples = buffer;
+      int32_t count = received - 1;
+      const int64_t timestamp = neo_scan_timestamp();
+
+      neo_device_feed_odometry(device, samples, count, revolution, timestamp);
+
+      if ( device->background ) {
+        count = neo_device_subtract_background(device, buffer, count, changed);
+        samples = changed;
+      }
+
+      if ( device->latest_scan ) {
+        neo_scan_fill(device->latest_scan->back(), samples, count,
+            revolution, /*sector=*/-1, timestamp);
+        neo_scan_fill_grid(device->latest_scan->back(), grid.get(),
+            denoise.get());
+        neo_device_analyze(device, device->latest_scan->back());
+        device->latest_scan->publish();
+      } else {
+        neo_device_publish(device->scan_queue, samples, count,
+            revolution, /*sector=*/-1, timestamp, grid.get(), denoise.get(),
+            device);
+      }
+
+      if ( device->shm_publisher ) {
+        neo::shm::publisher_publish(device->shm_publisher, samples,
+            count, revolution, /*sector=*/-1, timestamp);
+      }
+
+      if ( device->archive ) {
+        device->archive->append(samples, count, revolution, timestamp);
+      }
+      ++revolution;
+
+      buffer[0] = buffer[received - 1];
+      received = 1;
+    }
+
+    // Binned after the revolution check: this sample may start the next one
+    if ( grid )
+      grid->add(response.angle, buffer[received - 1].distance);
+  }
+} catch (const neo::transport::interrupted&) {
+  // woken up by neo_device_stop_scanning; nothing to report
+} catch (...) {
+  neo_device_worker_failed(device, std::current_exception());
+}
+
+// Worker for neo:// devices: scans and sectors arrive complete from neod
+static void neo_device_receive_scans(neo_device_s device) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(device->connection);
+
+  neo_device_configure_worker(device->options);
+
+  std::unique_ptr<neo_scan> scan{new neo_scan};
+
+  // Scans arrive complete; bin them as a whole
+  std::unique_ptr<neo::grid::accumulator> grid;
+  std::unique_ptr<neo::temporal::filter> denoise;
+
+  if ( device->options.grid_bins > 0 ) {
+    grid.reset(new neo::grid::accumulator{device->options.grid_bins,
+        device->options.grid_reduction});
+  }
+
+  if ( device->options.temporal_window > 0 ) {
+    denoise.reset(new neo::temporal::filter{device->options.grid_bins,
+        device->options.temporal_window, device->options.temporal_mode,
+        device->options.temporal_tolerance});
+  }
+
+  while ( !device->stop_thread ) {
+    neo::remote::connection_read(device->connection, *scan);
+    scan->timestamp = neo_scan_timestamp();
+
+    if ( scan->sector >= 0 ) {
+      device->sector_queue.enqueue({std::move(scan), nullptr});
+      scan.reset(new neo_scan);
+      continue;
+    }
+
+    if ( grid ) {
+      for ( int32_t n = 0; n < scan->count; ++n ) {
+        grid->add(neo::grid::to_fixed(scan->samples[n].angle),
+            scan->samples[n].distance);
+      }
+
+      neo_scan_fill_grid(*scan, grid.get(), denoise.get());
+    }
+
+    neo_device_feed_odometry(device, scan->samples, scan->count,
+        scan->revolution, scan->timestamp);
+
+    if ( device->background ) {
+      scan->count = neo_device_subtract_background(device, scan->samples,
+          scan->count, scan->samples);
+    }
+
+    neo_device_analyze(device, *scan);
+
+    if ( device->shm_publisher ) {
+      neo::shm::publisher_publish(device->shm_publisher, scan->samples,
+          scan->count, scan->revolution, scan->sector, scan->timestamp);
+    }
+
+    if ( device->archive ) {
+      device->archive->append(scan->samples, scan->count, scan->revolution,
+          scan->timestamp);
+    }
+
+    if ( device->latest_scan ) {
+      neo_scan& back = device->latest_scan->back();
+      neo_scan_fill(back, scan->samples, scan->count, scan->revolution,
+          scan->sector, scan->timestamp);
+      back.grid.swap(scan->grid);
+      back.clusters.swap(scan->clusters);
+      back.tracks.swap(scan->tracks);
+      device->latest_scan->publish();
+    } else {
+      device->scan_queue.enqueue({std::move(scan), nullptr});
+      scan.reset(new neo_scan);
+    }
+  }
+} catch (const neo::remote::interrupted&) {
+  // woken up by neo_device_stop_scanning; nothing to report
+} catch (...) {
+  neo_device_worker_failed(device, std::current_exception());
+}
+
+// Device control belongs to the daemon serving a neo:// device, and
+// nothing answers commands on a replayed capture
+static void neo_device_require_local(neo_device_s device) {
+  if ( device->remote )
+    throw neo::remote::error{"neo:// devices are controlled through neod."};
+
+  // Scanning stopped while reconnecting
+  if ( !device->transport )
+    throw neo::transport::error{"device is disconnected; start scanning to reconnect."};
+
+  if ( !neo::transport::transport_interactive(device->transport) )
+    throw neo::transport::error{"replayed captures do not take commands."};
+}
+
+// Wakes the worker up if it is blocked on the transport and waits for it
+static void neo_device_join_worker(neo_device_s device) {
+  NEO_ASSERT(device);
+
+  if ( !device->worker.joinable() )
+    return;
+
+  {
+    // A reconnecting worker either sees the flag or gets the interrupt
+    std::lock_guard<std::mutex> lock(device->transport_mutex);
+    device->stop_thread = true;
+
+    if ( device->remote )
+      neo::remote::connection_interrupt(device->connection);
+    else if ( device->transport )
+      neo::transport::transport_interrupt(device->transport);
+
+    if ( device->connect_interrupter )
+      neo::transport::interrupter_interrupt(device->connect_interrupter);
+  }
+
+  device->reconnect_wake.notify_all();
+
+  device->scan_queue.cancel();
+  device->sector_queue.cancel();
+  device->worker.join();
+
+  // Threads still waiting in get_scan or get_sector, e.g. a daemon shutting
+  // down, get an error rather than waiting for scans that never come
+  if ( !device->has_worker_error ) {
+    const auto stopped = std::make_exception_ptr(
+        neo::error::error{"scanning stopped."});
+    device->scan_queue.enqueue_final({nullptr, stopped});
+    device->sector_queue.enqueue_final({nullptr, stopped});
+  }
+
+  // Nothing feeds the odometry thread anymore; let it finish what it has
+  if ( device->odometry_worker.joinable() ) {
+    device->odometry_queue.enqueue_final({nullptr, nullptr});
+    device->pose_queue.cancel();
+    device->odometry_worker.join();
+  }
+
+  if ( device->remote ) {
+    // A subscription lasts one scanning session
+    neo::remote::connection_destruct(device->connection);
+    device->connection = nullptr;
+    return;
+  }
+
+  // Drop the pending wakeup together with whatever the worker left unread
+  if ( device->transport )
+    neo::transport::transport_flush(device->transport);
+}
+
+// Constructor hidden from users
+static neo_error_s neo_error_construct(const char* what) {
+  NEO_ASSERT(what);
+
+  auto out = new neo_error{what};
+  return out;
+}
+
+const char* neo_error_message(neo_error_s error) {
+  NEO_ASSERT(error);
+
+  return error->what.c_str();
+}
+
+void neo_error_destruct(neo_error_s error) {
+  NEO_ASSERT(error);
+
+  delete error;
+}
+
+neo_device_options_s neo_device_options_construct(neo_error_s* error) try {
+  NEO_ASSERT(error);
+
+  auto out = new neo_device_options(neo_device_options_default());
+  return out;
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_device_options_destruct(neo_device_options_s options) {
+  NEO_ASSERT(options);
+
+  delete options;
+}
+
+void neo_device_options_set_queue_depth(neo_device_options_s options,
+    int32_t depth) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(depth > 0);
+
+  options->queue_depth = depth;
+}
+
+void neo_device_options_set_delivery(neo_device_options_s options,
+    int32_t delivery) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(delivery == NEO_DELIVERY_QUEUE || delivery == NEO_DELIVERY_LATEST);
+
+  options->delivery = delivery;
+}
+
+void neo_device_options_set_thread_affinity(neo_device_options_s options,
+    uint64_t cpu_mask) {
+  NEO_ASSERT(options);
+
+  options->cpu_affinity = cpu_mask;
+}
+
+void neo_device_options_set_thread_priority(neo_device_options_s options,
+    int32_t priority) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(priority >= 0 && priority <= 99);
+
+  options->thread_priority = priority;
+}
+
+void neo_device_options_set_thread_name(neo_device_options_s options,
+    const char* name) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(name);
+
+  options->thread_name = name;
+}
+
+void neo_device_options_set_lock_memory(neo_device_options_s options,
+    bool lock) {
+  NEO_ASSERT(options);
+
+  options->lock_memory = lock;
+}
+
+void neo_device_options_set_serial_profile(neo_device_options_s options,
+    int32_t profile) {
+  NEO_ASSERT(options);
+
+  switch ( profile ) {
+  case NEO_SERIAL_PROFILE_STANDARD:
+    options->serial_profile = neo::serial::profile::standard;
+    break;
+  case NEO_SERIAL_PROFILE_LOW_LATENCY:
+    options->serial_profile = neo::serial::profile::low_latency;
+    break;
+  case NEO_SERIAL_PROFILE_LOW_CPU:
+    options->serial_profile = neo::serial::profile::low_cpu;
+    break;
+  default:
+    NEO_ASSERT(false && "unknown serial profile.");
+  }
+}
+
+void neo_device_options_set_io_uring(neo_device_options_s options,
+    bool enable) {
+  NEO_ASSERT(options);
+
+  options->io_uring = enable;
+}
+
+void neo_device_options_set_grid(neo_device_options_s options, int32_t bins,
+    int32_t reduction) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(bins >= 0 && bins <= NEO_MAX_GRID_BINS);
+  NEO_ASSERT(reduction == NEO_GRID_MIN || reduction == NEO_GRID_NEAREST
+      || reduction == NEO_GRID_MEAN);
+
+  options->grid_bins = bins;
+  options->grid_reduction = reduction;
+}
+
+void neo_device_options_set_temporal_filter(neo_device_options_s options,
+    int32_t window, int32_t mode, int32_t tolerance) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(window >= 0 && window <= NEO_MAX_TEMPORAL_WINDOW);
+  NEO_ASSERT(mode == NEO_TEMPORAL_MEDIAN || mode == NEO_TEMPORAL_VOTE);
+  NEO_ASSERT(tolerance >= 0);
+
+  options->temporal_window = window;
+  options->temporal_mode = mode;
+  options->temporal_tolerance = tolerance;
+}
+
+void neo_device_options_set_background(neo_device_options_s options,
+    int32_t bins, int32_t learning_scans, int32_t min_change) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(bins >= 0 && bins <= NEO_MAX_GRID_BINS);
+  NEO_ASSERT(bins == 0 || learning_scans >= 1);
+  NEO_ASSERT(min_change >= 0);
+
+  options->background_bins = bins;
+  options->background_learning_scans = learning_scans;
+  options->background_min_change = min_change;
+}
+
+void neo_device_options_set_clusters(neo_device_options_s options,
+    int32_t max_gap, int32_t min_samples) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(max_gap >= 0);
+  NEO_ASSERT(max_gap == 0 || min_samples >= 1);
+
+  options->cluster_max_gap = max_gap;
+  options->cluster_min_samples = min_samples;
+}
+
+void neo_device_options_set_tracking(neo_device_options_s options,
+    int32_t max_distance, int32_t max_misses) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(max_distance >= 0);
+  NEO_ASSERT(max_misses >= 0);
+
+  options->tracking_max_distance = max_distance;
+  options->tracking_max_misses = max_misses;
+}
+
+void neo_device_options_set_odometry(neo_device_options_s options,
+    int32_t max_distance, int32_t keyframe_distance, int32_t keyframe_angle) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(max_distance >= 0);
+  NEO_ASSERT(keyframe_distance >= 0);
+  NEO_ASSERT(keyframe_angle >= 0 && keyframe_angle <= 180);
+
+  options->odometry_max_distance = max_distance;
+  options->odometry_keyframe_distance = keyframe_distance;
+  options->odometry_keyframe_angle = keyframe_angle;
+}
+
+void neo_device_options_set_odometry_affinity(neo_device_options_s options,
+    uint64_t cpu_mask) {
+  NEO_ASSERT(options);
+
+  options->odometry_cpu_affinity = cpu_mask;
+}
+
+void neo_device_options_set_profile_cache(neo_device_options_s options,
+    const char* path) {
+  NEO_ASSERT(options);
+
+  options->profile_cache = path ? path : "";
+}
+
+void neo_device_options_set_shm_ring(neo_device_options_s options,
+    const char* name, int32_t slots) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(!name || !*name || slots >= 2);
+
+  options->shm_name = name ? name : "";
+  options->shm_slots = slots;
+}
+
+void neo_device_options_set_archive(neo_device_options_s options,
+    const char* path, int32_t chunk_scans) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(!path || !*path || chunk_scans >= 1);
+
+  options->archive_path = path ? path : "";
+  options->archive_chunk_scans = chunk_scans;
+}
+
+void neo_device_options_set_reconnect(neo_device_options_s options,
+    int32_t max_backoff_ms, neo_status_callback callback, void* user_data) {
+  NEO_ASSERT(options);
+  NEO_ASSERT(max_backoff_ms >= 0);
+
+  options->reconnect_max_backoff = max_backoff_ms;
+  options->status_callback = callback;
+  options->status_user_data = user_data;
+}
+
+void neo_device_options_set_queue_policy(neo_device_options_s options,
+    int32_t policy) {
+  NEO_ASSERT(options);
+
+  switch ( policy ) {
+  case NEO_QUEUE_DROP_OLDEST:
+    options->queue_policy = neo::queue::policy::drop_oldest;
+    break;
+  case NEO_QUEUE_DROP_NEWEST:
+    options->queue_policy = neo::queue::policy::drop_newest;
+    break;
+  case NEO_QUEUE_BLOCK_PRODUCER:
+    options->queue_policy = neo::queue::policy::block_producer;
+    break;
+  case NEO_QUEUE_KEEP_LATEST:
+    options->queue_policy = neo::queue::policy::keep_latest;
+    break;
+  default:
+    NEO_ASSERT(false && "unknown queue policy.");
+  }
+}
+
+neo_device_s neo_device_construct_simple(const char* port,
+    neo_error_s* error) try {
+  NEO_ASSERT(error);
+
+  return neo_device_construct(port, 115200, error);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+neo_device_s neo_device_construct(const char* port, int32_t baudrate,
+    neo_error_s* error) try {
+  NEO_ASSERT(error);
+
+  neo_device_options defaults = neo_device_options_default();
+
+  return neo_device_construct_with_options(port, baudrate, &defaults, error);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+static void neo_device_enable_latest_scan(neo_device_s device) {
+  device->latest_scan.reset(new neo::triple_buffer::triple_buffer<neo_scan>);
+
+  // Unlocked again in neo_device_destruct; stays pageable if not allowed
+  if ( device->options.lock_memory && !neo::thread::lock_memory(
+        device->latest_scan.get(), sizeof(*device->latest_scan)) ) {
+    device->options.lock_memory = false;
+  }
+}
+
+// Fixed-width text fields come padded with spaces or NULs
+static std::string neo_identity_field(const uint8_t* bytes, size_t len) {
+  std::string out{reinterpret_cast<const char*>(bytes), len};
+  out.erase(out.find_last_not_of(std::string(" \0", 2)) + 1);
+  return out;
+}
+
+static std::string neo_identity_version(uint8_t major, uint8_t minor) {
+  return std::string{static_cast<char>(major)} + "." + static_cast<char>(minor);
+}
+
+static neo_identity neo_query_identity(neo::transport::transport_s transport) {
+  neo::protocol::write_command(transport, neo::protocol::VERSION_INFORMATION);
+  const auto version = neo::protocol::read_response_info_version(transport);
+
+  neo::protocol::write_command(transport, neo::protocol::DEVICE_INFORMATION);
+  const auto info = neo::protocol::read_response_info_device(transport);
+
+  using neo::protocol::ascii_field_to_integral;
+
+  return {neo_identity_field(version.model, sizeof(version.model)),
+    neo_identity_field(version.serial_no, sizeof(version.serial_no)),
+    neo_identity_version(version.protocol_major, version.protocol_min),
+    neo_identity_version(version.firmware_major, version.firmware_minor),
+    ascii_field_to_integral(&version.hardware_version, 1),
+    ascii_field_to_integral(info.bit_rate, sizeof(info.bit_rate)),
+    ascii_field_to_integral(info.motor_speed, sizeof(info.motor_speed)),
+    ascii_field_to_integral(info.sample_rate, sizeof(info.sample_rate))};
+}
+
+// The cache only saves time; failing to write it never fails the device,
+// neo_device_get_profile_cache_failures counts it instead
+static void neo_device_save_profile(neo_device_s device) {
+  if ( device->profile.serial_number.empty() )
+    return;
+
+  if ( !neo::profile::store(device->options.profile_cache.c_str(), device->profile) )
+    ++device->profile_cache_failures;
+}
+
+// Speed a unit spins at after power-up, and the default bring-up speed
+constexpr int32_t neo_power_on_motor_speed = 5;
+
+// Identifies the unit and picks up its cached profile. True if the unit was
+// calibrated over this baud rate and still spins at a cached speed other
+// than the power-on one: a power cycle would have reset it, so the motor is
+// settled and the calibration still holds. Units at the power-on speed may
+// just have been switched on and always get the full bring-up, with the
+// cached motor speed. Failing to identify the unit only means the full
+// bring-up, never an error.
+static bool neo_device_restore_profile(neo_device_s device) try {
+  const auto identity = neo_query_identity(device->transport);
+
+  if ( identity.serial_number.empty() )
+    return false;
+
+  device->profile.serial_number = identity.serial_number;
+
+  neo::profile::profile cached;
+
+  if ( !neo::profile::load(device->options.profile_cache.c_str(),
+        identity.serial_number, cached) )
+    return false;
+
+  const bool settled = cached.baudrate == device->baudrate
+    && cached.calibrated_at != 0 && cached.motor_speed > 0
+    && cached.motor_speed != neo_power_on_motor_speed
+    && cached.motor_speed == identity.motor_speed;
+
+  if ( cached.motor_speed > 0 && cached.motor_speed <= 10 )
+    device->profile.motor_speed = cached.motor_speed;
+
+  device->profile.calibrated_at = cached.calibrated_at;
+  return settled;
+} catch ( const std::exception& ) {
+  // Drop whatever part of a reply arrived before bringing the unit up
+  neo::transport::transport_flush(device->transport);
+  return false;
+}
+
+// neod already brought the device up: greet it to check it serves the
+// device, no transport and no multi-second motor and calibration wait
+static neo_device_s neo_device_construct_remote(const char* port,
+    const neo_device_options& options) {
+  std::unique_ptr<neo::remote::endpoint> remote{
+    new neo::remote::endpoint(neo::remote::parse(port))};
+
+  neo::remote::info info;
+  neo::remote::connection_destruct(
+      neo::remote::connection_construct(*remote, info));
+
+  std::unique_ptr<neo::archive::writer> archive;
+
+  if ( !options.archive_path.empty() ) {
+    archive.reset(new neo::archive::writer{options.archive_path.c_str(),
+        options.archive_chunk_scans});
+  }
+
+  neo::shm::publisher_s shm_publisher = nullptr;
+
+  if ( !options.shm_name.empty() ) {
+    shm_publisher = neo::shm::publisher_construct(options.shm_name.c_str(),
+        options.shm_slots);
+  }
+
+  const auto depth = options.queue_depth;
+  const auto policy = options.queue_policy;
+  const int32_t odometry_depth = 2;
+
+  auto out = new neo_device{/*transport=*/nullptr, /*baudrate=*/0, options,
+  /*is_scanning=*/false,
+  /*stop_thread=*/{false}, /*scan_queue=*/{depth, policy},
+  /*sector_size=*/0, /*sector_queue=*/{depth, policy},
+  /*scan_readiness=*/nullptr,
+  /*latest_scan=*/{}, /*has_worker_error=*/{false}, /*worker_error=*/{},
+  shm_publisher, std::move(archive), std::move(remote), info,
+  /*connection=*/nullptr,
+  /*worker=*/{}, /*odometry_queue=*/{odometry_depth, neo::queue::policy::drop_oldest},
+  /*pose_queue=*/{depth, policy}, /*odometry_worker=*/{},
+  /*background=*/{}, /*relearn_background=*/{false}, /*tracker=*/{},
+  /*profile=*/{}, port, /*transport_mutex=*/{}, /*reconnect_wake=*/{},
+  /*connect_interrupter=*/nullptr, /*reconnects=*/{0}, /*downtime=*/{0},
+  /*profile_cache_failures=*/{0}};
+
+  if ( options.delivery == NEO_DELIVERY_LATEST ) {
+    neo_device_enable_latest_scan(out);
+  }
+
+  if ( options.background_bins > 0 ) {
+    out->background.reset(new neo::background::model{options.background_bins,
+        options.background_learning_scans, options.background_min_change});
+  }
+
+  if ( options.tracking_max_distance > 0 ) {
+    out->tracker.reset(new neo::tracking::tracker{{
+        static_cast<float>(options.tracking_max_distance), options.tracking_max_misses}});
+  }
+
+  return out;
+}
+
+neo_device_s neo_device_construct_with_options(const char* port,
+    int32_t baudrate, neo_device_options_s options, neo_error_s* error) try {
+  NEO_ASSERT(port);
+  NEO_ASSERT(baudrate > 0);
+  NEO_ASSERT(options);
+  NEO_ASSERT(options->tracking_max_distance == 0 || options->cluster_max_gap > 0);
+  NEO_ASSERT(options->temporal_window == 0 || options->grid_bins > 0);
+  NEO_ASSERT(error);
+
+  if ( neo::remote::is_remote(port) ) {
+    return neo_device_construct_remote(port, *options);
+  }
+
+  neo::transport::transport_s transport = neo::transport::transport_construct(
+      port, baudrate, neo_device_serial_config(*options));
+
+  std::unique_ptr<neo::archive::writer> archive;
+
+  if ( !options->archive_path.empty() ) {
+    try {
+      archive.reset(new neo::archive::writer{options->archive_path.c_str(),
+          options->archive_chunk_scans});
+    } catch (...) {
+      neo::transport::transport_destruct(transport);
+      throw;
+    }
+  }
+
+  neo::shm::publisher_s shm_publisher = nullptr;
+
+  if ( !options->shm_name.empty() ) {
+    try {
+      shm_publisher = neo::shm::publisher_construct(options->shm_name.c_str(),
+          options->shm_slots);
+    } catch (...) {
+      neo::transport::transport_destruct(transport);
+      throw;
+    }
+  }
+
+  // Reconnects run on the worker, which stop must be able to wake up even
+  // while it is still connecting
+  neo::transport::interrupter_s connect_interrupter = nullptr;
+
+  if ( options->reconnect_max_backoff > 0 ) {
+    try {
+      connect_interrupter = neo::transport::interrupter_construct();
+    } catch (...) {
+      if ( shm_publisher )
+        neo::shm::publisher_destruct(shm_publisher);
+
+      neo::transport::transport_destruct(transport);
+      throw;
+    }
+  }
+
+  const auto depth = options->queue_depth;
+  const auto policy = options->queue_policy;
+  const int32_t odometry_depth = 2;
+
+  // Replays start streaming right away; there is no device to bring up
+  const bool interactive = neo::transport::transport_interactive(transport);
+
+  auto out = new neo_device{transport, baudrate, *options,
+  /*is_scanning=*/interactive,
+  /*stop_thread=*/{false}, /*scan_queue=*/{depth, policy},
+  /*sector_size=*/0, /*sector_queue=*/{depth, policy},
+  /*scan_readiness=*/nullptr,
+  /*latest_scan=*/{}, /*has_worker_error=*/{false}, /*worker_error=*/{},
+  shm_publisher, std::move(archive), /*remote=*/{}, /*remote_info=*/{0, 0},
+  /*connection=*/nullptr,
+  /*worker=*/{}, /*odometry_queue=*/{odometry_depth, neo::queue::policy::drop_oldest},
+  /*pose_queue=*/{depth, policy}, /*odometry_worker=*/{},
+  /*background=*/{}, /*relearn_background=*/{false}, /*tracker=*/{},
+  /*profile=*/{"", baudrate, neo_power_on_motor_speed, /*calibrated_at=*/0},
+  port, /*transport_mutex=*/{}, /*reconnect_wake=*/{}, connect_interrupter,
+  /*reconnects=*/{0}, /*downtime=*/{0}, /*profile_cache_failures=*/{0}};
+
+  if ( options->delivery == NEO_DELIVERY_LATEST ) {
+    neo_device_enable_latest_scan(out);
+  }
+
+  if ( options->background_bins > 0 ) {
+    out->background.reset(new neo::background::model{options->background_bins,
+        options->background_learning_scans, options->background_min_change});
+  }
+
+  if ( options->tracking_max_distance > 0 ) {
+    out->tracker.reset(new neo::tracking::tracker{{
+        static_cast<float>(options->tracking_max_distance), options->tracking_max_misses}});
+  }
+
+  if ( !interactive ) {
+    return out;
+  }
+
+  // Stop all process to recovery
+  neo_device_stop_scanning(out, error);
+
+  // A unit still running the way its cached profile left it needs no
+  // motor settle wait and no calibration
+  if ( !options->profile_cache.empty() && neo_device_restore_profile(out) ) {
+    return out;
+  }
+
+  // Setting motor running
+  neo_device_set_motor_speed(out, out->profile.motor_speed, error);
+
+  // device calibration
+  neo_device_calibrate(out, error);
+
+  // Stop motor
+  // neo_device_set_motor_speed(out, 0, error);
+
+  neo_device_stop_scanning(out, error);
+
+
+  return out;
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_device_destruct(neo_device_s device) {
+  NEO_ASSERT(device);
+
+  try {
+    neo_error_s ignore = nullptr;
+    neo_device_stop_scanning(device, &ignore);
+
+    if ( ignore )
+      neo_error_destruct(ignore);
+
+    // stop may have failed talking to the device; never leave the worker running
+    neo_device_join_worker(device);
+  } catch (...) {
+    // nothing we can do here
+  }
+
+  if ( device->latest_scan && device->options.lock_memory ) {
+    neo::thread::unlock_memory(device->latest_scan.get(),
+        sizeof(*device->latest_scan));
+  }
+
+  if ( device->shm_publisher )
+    neo::shm::publisher_destruct(device->shm_publisher);
+
+  if ( device->scan_readiness ) {
+    device->scan_queue.set_readiness(nullptr);
+    neo::event::flag_destruct(device->scan_readiness);
+  }
+
+  if ( device->transport )
+    neo::transport::transport_destruct(device->transport);
+
+  if ( device->connect_interrupter )
+    neo::transport::interrupter_destruct(device->connect_interrupter);
+
+  delete device;
+}
+
+int64_t neo_device_get_queue_memory_budget(neo_device_s device) {
+  NEO_ASSERT(device);
+
+  const auto& options = device->options;
+
+  const int64_t scans = device->latest_scan ? 3 : device->scan_queue.capacity();
+  int64_t elements = scans;
+
+  if ( device->sector_size > 0 )
+    elements += device->sector_queue.capacity();
+
+  if ( options.odometry_max_distance > 0 )
+    elements += device->odometry_queue.capacity();
+
+  // Full scans also carry what the enabled stages derived from them
+  int64_t derived = 0;
+
+  if ( options.grid_bins > 0 )
+    derived += options.grid_bins * static_cast<int64_t>(sizeof(int32_t));
+
+  if ( options.cluster_max_gap > 0 )
+    derived += NEO_MAX_CLUSTERS * static_cast<int64_t>(sizeof(cluster));
+
+  if ( options.tracking_max_distance > 0 )
+    derived += NEO_MAX_TRACKS * static_cast<int64_t>(sizeof(track));
+
+  return elements * static_cast<int64_t>(sizeof(neo_scan)) + scans * derived;
+}
+
+int64_t neo_device_get_reconnects(neo_device_s device) {
+  NEO_ASSERT(device);
+
+  return device->reconnects;
+}
+
+int64_t neo_device_get_downtime(neo_device_s device) {
+  NEO_ASSERT(device);
+
+  return device->downtime;
+}
+
+int64_t neo_device_get_profile_cache_failures(neo_device_s device) {
+  NEO_ASSERT(device);
+
+  return device->profile_cache_failures;
+}
+
+// Opens a fresh neod connection for a scanning session of a neo:// device
+static void neo_device_subscribe(neo_device_s device) {
+  const auto connection = neo::remote::connection_construct(*device->remote,
+      device->remote_info);
+
+  try {
+    if ( device->sector_size > 0 && device->sector_size != device->remote_info.sector_size ) {
+      throw neo::remote::error{"neod does not stream sectors of this size."};
+    }
+
+    neo::remote::connection_subscribe(connection, device->sector_size > 0,
+        device->remote->decimate);
+  } catch (...) {
+    neo::remote::connection_destruct(connection);
+    throw;
+  }
+
+  device->connection = connection;
+}
+
+void neo_device_start_scanning(neo_device_s device, neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(!device->is_scanning);
+
+  if (device->is_scanning)
+    return;
+
+  if ( !device->remote && !device->transport ) {
+    device->transport = neo::transport::transport_construct(device->port.c_str(),
+        device->baudrate, neo_device_serial_config(device->options));
+  }
+
+  if ( device->remote ) {
+    neo_device_subscribe(device);
+  } else if ( neo::transport::transport_interactive(device->transport) ) {
+    neo::protocol::write_command(device->transport,
+        neo::protocol::DATA_ACQUISITION_START);
+
+    neo::protocol::read_response_header(device->transport,
+        neo::protocol::DATA_ACQUISITION_START);
+  }
+
+  device->scan_queue.clear();
+  device->sector_queue.clear();
+  device->odometry_queue.clear();
+  device->pose_queue.clear();
+
+  if ( device->tracker ) {
+    device->tracker->reset();
+  }
+
+  if ( device->latest_scan ) {
+    device->latest_scan->clear();
+  }
+
+  device->worker_error = nullptr;
+  device->has_worker_error = false;
+  device->is_scanning = true;
+  device->stop_thread = false;
+
+  if ( device->connect_interrupter )
+    neo::transport::interrupter_reset(device->connect_interrupter);
+
+  device->worker = std::thread(device->remote ? neo_device_receive_scans
+      : neo_device_accumulate_scans, device);
+
+  // Each scanning session tracks from its own first scan
+  if ( device->options.odometry_max_distance > 0 )
+    device->odometry_worker = std::thread(neo_device_track_odometry, device);
+} catch (const std::exception& e) {
+  *error = neo_error_construct(e.what());
+}
+
+void neo_device_stop_scanning(neo_device_s device, neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+
+  if (!device->is_scanning)
+    return;
+
+  // The worker is gone after this, so we own the transport from here on
+  neo_device_join_worker(device);
+
+  if ( device->remote || !device->transport
+      || !neo::transport::transport_interactive(device->transport) ) {
+    device->is_scanning = false;
+    return;
+  }
+
+  // A unit that stopped answering must not hang stop or destruct
+  neo_device_exchange(device, "device did not answer the stop command.",
+      [device] {
+    neo::protocol::write_command(device->transport,
+        neo::protocol::DATA_ACQUISITION_STOP);
+
+    // Wait some time for a few reasons: reference to sweep-sdk
+    std::this_thread::sleep_for(std::chrono::milliseconds(35));
+
+    try {
+      neo::protocol::read_response_header(device->transport,
+          neo::protocol::DATA_ACQUISITION_STOP);
+    } catch ( const neo::transport::interrupted& ) {
+      throw;
+    } catch ( const neo::transport::timed_out& ) {
+      throw;
+    } catch ( const std::exception& ignore ) {
+      (void) ignore;
+    }
+
+    // Flush any bytes left over
+    neo::transport::transport_flush(device->transport);
+
+    neo::protocol::write_command(device->transport,
+        neo::protocol::DATA_ACQUISITION_STOP);
+
+    neo::protocol::read_response_header(device->transport,
+        neo::protocol::DATA_ACQUISITION_STOP);
+  });
+
+  device->is_scanning = false;
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+}
+
+neo_scan_s neo_device_get_scan(neo_device_s device, neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(device->is_scanning);
+
+  auto out = device->scan_queue.dequeue();
+
+  if ( out.error != nullptr ) {
+    std::rethrow_exception(out.error);
+  }
+
+  return out.scan.release();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+int32_t neo_device_get_readiness_fd(neo_device_s device,
+    neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(!device->latest_scan && "full scans bypass the queue with NEO_DELIVERY_LATEST.");
+
+  if ( !device->scan_readiness ) {
+    device->scan_readiness = neo::event::flag_construct();
+    device->scan_queue.set_readiness(device->scan_readiness);
+  }
+
+  return neo::event::flag_fd(device->scan_readiness);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return -1;
+}
+
+neo_scan_s neo_device_try_get_scan(neo_device_s device,
+    neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(device->is_scanning);
+
+  neo_device::Element out;
+
+  // A failed worker is reported once queued, and on every call after that
+  if ( !device->scan_queue.try_dequeue(out) ) {
+    if ( !device->has_worker_error ) {
+      return nullptr;
+    }
+
+    out.error = device->worker_error;
+  }
+
+  if ( out.error != nullptr ) {
+    std::rethrow_exception(out.error);
+  }
+
+  return out.scan.release();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+neo_scan_s neo_device_get_latest_scan(neo_device_s device,
+    neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(device->is_scanning);
+  NEO_ASSERT(device->latest_scan && "latest scan delivery is disabled.");
+
+  if ( device->has_worker_error ) {
+    std::rethrow_exception(device->worker_error);
+  }
+
+  return device->latest_scan->latest();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+neo_scan_s neo_device_get_sector(neo_device_s device, neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(device->is_scanning);
+  NEO_ASSERT(device->sector_size > 0 && "sector streaming is disabled.");
+
+  auto out = device->sector_queue.dequeue();
+
+  if ( out.error != nullptr ) {
+    std::rethrow_exception(out.error);
+  }
+
+  return out.scan.release();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+neo_pose_s neo_device_get_pose(neo_device_s device, neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(device->is_scanning);
+  NEO_ASSERT(device->options.odometry_max_distance > 0 && "odometry is disabled.");
+
+  auto out = device->pose_queue.dequeue();
+
+  if ( out.error != nullptr ) {
+    std::rethrow_exception(out.error);
+  }
+
+  return out.pose.release();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_device_set_sector_size(neo_device_s device, int32_t degrees,
+    neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+
+  if ( device->is_scanning )
+    throw neo::error::error{"sector size cannot change while scanning."};
+
+  if ( degrees < 0 || degrees > 360 )
+    throw neo::error::error{"sector size must be between 0 and 360 degrees."};
+
+  if ( degrees != 0 && 360 % degrees != 0 )
+    throw neo::error::error{"sectors must evenly divide a revolution."};
+
+  device->sector_size = degrees;
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+}
+
+int32_t neo_scan_get_number_of_samples(neo_scan_s scan) {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(scan->count >= 0);
+
+  return scan->count;
+}
+
+float neo_scan_get_angle(neo_scan_s scan, int32_t sample) {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(sample >= 0 && sample < scan->count &&
+      "sample index out of bounds.");
+
+  return scan->samples[sample].angle;
+}
+
+int32_t neo_scan_get_distance(neo_scan_s scan, int32_t sample) {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(sample >= 0 && sample < scan->count &&
+      "sample index out of bounds.");
+
+  return scan->samples[sample].distance;
+}
+
+int32_t neo_scan_get_revolution(neo_scan_s scan) {
+  NEO_ASSERT(scan);
+
+  return scan->revolution;
+}
+
+int32_t neo_scan_get_sector_index(neo_scan_s scan) {
+  NEO_ASSERT(scan);
+
+  return scan->sector;
+}
+
+int64_t neo_scan_get_timestamp(neo_scan_s scan) {
+  NEO_ASSERT(scan);
+
+  return scan->timestamp;
+}
+
+void neo_pose_destruct(neo_pose_s pose) {
+  NEO_ASSERT(pose);
+
+  delete pose;
+}
+
+int32_t neo_pose_get_revolution(neo_pose_s pose) {
+  NEO_ASSERT(pose);
+
+  return pose->estimate.revolution;
+}
+
+float neo_pose_get_x(neo_pose_s pose) {
+  NEO_ASSERT(pose);
+
+  return pose->estimate.x;
+}
+
+float neo_pose_get_y(neo_pose_s pose) {
+  NEO_ASSERT(pose);
+
+  return pose->estimate.y;
+}
+
+float neo_pose_get_heading(neo_pose_s pose) {
+  NEO_ASSERT(pose);
+
+  return pose->estimate.heading;
+}
+
+void neo_pose_get_covariance(neo_pose_s pose, float* covariance) {
+  NEO_ASSERT(pose);
+  NEO_ASSERT(covariance);
+
+  std::copy_n(pose->estimate.covariance, 9, covariance);
+}
+
+int32_t neo_pose_get_correspondences(neo_pose_s pose) {
+  NEO_ASSERT(pose);
+
+  return pose->estimate.correspondences;
+}
+
+int32_t neo_scan_get_grid_bins(neo_scan_s scan) {
+  NEO_ASSERT(scan);
+
+  return static_cast<int32_t>(scan->grid.size());
+}
+
+int32_t neo_scan_get_grid(neo_scan_s scan, int32_t* ranges, int32_t capacity) {
+  NEO_ASSERT(scan);
+
+  const auto bins = static_cast<int32_t>(scan->grid.size());
+  NEO_ASSERT(bins == 0 || ranges);
+  NEO_ASSERT(capacity >= bins && "grid does not fit into ranges.");
+
+  std::copy(scan->grid.begin(), scan->grid.end(), ranges);
+  return bins;
+}
+
+void neo_scan_resample(neo_scan_s scan, int32_t bins, int32_t reduction,
+    int32_t* ranges, neo_error_s* error) try {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(bins >= 1 && bins <= NEO_MAX_GRID_BINS);
+  NEO_ASSERT(ranges);
+  NEO_ASSERT(error);
+
+  neo::grid::resample(*scan, bins, reduction, ranges);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+}
+
+neo_lines_s neo_scan_extract_lines(neo_scan_s scan, int32_t max_deviation,
+    int32_t max_gap, int32_t min_samples, neo_error_s* error) try {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(max_deviation > 0);
+  NEO_ASSERT(max_gap > 0);
+  NEO_ASSERT(min_samples >= 2);
+  NEO_ASSERT(error);
+
+  std::unique_ptr<neo_lines> out{new neo_lines};
+  neo::lines::extract(*scan, {static_cast<float>(max_deviation),
+      static_cast<float>(max_gap), min_samples}, out->segments);
+
+  return out.release();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_lines_destruct(neo_lines_s lines) {
+  NEO_ASSERT(lines);
+
+  delete lines;
+}
+
+int32_t neo_lines_get_count(neo_lines_s lines) {
+  NEO_ASSERT(lines);
+
+  return static_cast<int32_t>(lines->segments.size());
+}
+
+static const neo::lines::segment& neo_lines_at(neo_lines_s lines, int32_t line) {
+  NEO_ASSERT(lines);
+  NEO_ASSERT(line >= 0 && line < static_cast<int32_t>(lines->segments.size()) &&
+      "line index out of bounds.");
+
+  return lines->segments[line];
+}
+
+float neo_lines_get_start_x(neo_lines_s lines, int32_t line) {
+  return neo_lines_at(lines, line).start_x;
+}
+
+float neo_lines_get_start_y(neo_lines_s lines, int32_t line) {
+  return neo_lines_at(lines, line).start_y;
+}
+
+float neo_lines_get_end_x(neo_lines_s lines, int32_t line) {
+  return neo_lines_at(lines, line).end_x;
+}
+
+float neo_lines_get_end_y(neo_lines_s lines, int32_t line) {
+  return neo_lines_at(lines, line).end_y;
+}
+
+int32_t neo_lines_get_first_sample(neo_lines_s lines, int32_t line) {
+  return neo_lines_at(lines, line).first;
+}
+
+int32_t neo_lines_get_last_sample(neo_lines_s lines, int32_t line) {
+  return neo_lines_at(lines, line).last;
+}
+
+float neo_lines_get_rms(neo_lines_s lines, int32_t line) {
+  return neo_lines_at(lines, line).rms;
+}
+
+neo_clusters_s neo_scan_extract_clusters(neo_scan_s scan, int32_t max_gap,
+    int32_t min_samples, neo_error_s* error) try {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(max_gap > 0);
+  NEO_ASSERT(min_samples >= 1);
+  NEO_ASSERT(error);
+
+  std::unique_ptr<neo_clusters> out{new neo_clusters};
+  out->clusters.resize(scan->count);
+  out->clusters.resize(neo::clusters::extract(scan->samples, scan->count,
+      {static_cast<float>(max_gap), min_samples}, out->clusters.data(),
+      scan->count));
+
+  return out.release();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+neo_clusters_s neo_scan_get_clusters(neo_scan_s scan, neo_error_s* error) try {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(error);
+
+  return new neo_clusters{scan->clusters};
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_clusters_destruct(neo_clusters_s clusters) {
+  NEO_ASSERT(clusters);
+
+  delete clusters;
+}
+
+int32_t neo_clusters_get_count(neo_clusters_s clusters) {
+  NEO_ASSERT(clusters);
+
+  return static_cast<int32_t>(clusters->clusters.size());
+}
+
+static const cluster& neo_clusters_at(neo_clusters_s clusters, int32_t index) {
+  NEO_ASSERT(clusters);
+  NEO_ASSERT(index >= 0 && index < static_cast<int32_t>(clusters->clusters.size()) &&
+      "cluster index out of bounds.");
+
+  return clusters->clusters[index];
+}
+
+float neo_clusters_get_centroid_x(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).centroid_x;
+}
+
+float neo_clusters_get_centroid_y(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).centroid_y;
+}
+
+float neo_clusters_get_min_x(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).min_x;
+}
+
+float neo_clusters_get_min_y(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).min_y;
+}
+
+float neo_clusters_get_max_x(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).max_x;
+}
+
+float neo_clusters_get_max_y(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).max_y;
+}
+
+int32_t neo_clusters_get_first_sample(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).first;
+}
+
+int32_t neo_clusters_get_last_sample(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).last;
+}
+
+int32_t neo_clusters_get_sample_count(neo_clusters_s clusters, int32_t cluster) {
+  return neo_clusters_at(clusters, cluster).count;
+}
+
+neo_tracks_s neo_scan_get_tracks(neo_scan_s scan, neo_error_s* error) try {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(error);
+
+  return new neo_tracks{scan->tracks};
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_tracks_destruct(neo_tracks_s tracks) {
+  NEO_ASSERT(tracks);
+
+  delete tracks;
+}
+
+int32_t neo_tracks_get_count(neo_tracks_s tracks) {
+  NEO_ASSERT(tracks);
+
+  return static_cast<int32_t>(tracks->tracks.size());
+}
+
+static const track& neo_tracks_at(neo_tracks_s tracks, int32_t index) {
+  NEO_ASSERT(tracks);
+  NEO_ASSERT(index >= 0 && index < static_cast<int32_t>(tracks->tracks.size()) &&
+      "track index out of bounds.");
+
+  return tracks->tracks[index];
+}
+
+int32_t neo_tracks_get_id(neo_tracks_s tracks, int32_t track) {
+  return neo_tracks_at(tracks, track).id;
+}
+
+float neo_tracks_get_x(neo_tracks_s tracks, int32_t track) {
+  return neo_tracks_at(tracks, track).x;
+}
+
+float neo_tracks_get_y(neo_tracks_s tracks, int32_t track) {
+  return neo_tracks_at(tracks, track).y;
+}
+
+float neo_tracks_get_velocity_x(neo_tracks_s tracks, int32_t track) {
+  return neo_tracks_at(tracks, track).velocity_x;
+}
+
+float neo_tracks_get_velocity_y(neo_tracks_s tracks, int32_t track) {
+  return neo_tracks_at(tracks, track).velocity_y;
+}
+
+int32_t neo_tracks_get_age(neo_tracks_s tracks, int32_t track) {
+  return neo_tracks_at(tracks, track).age;
+}
+
+int32_t neo_tracks_get_misses(neo_tracks_s tracks, int32_t track) {
+  return neo_tracks_at(tracks, track).misses;
+}
+
+neo_scan_s neo_scan_construct(const float* angles, const int32_t* distances,
+    int32_t count, int32_t revolution, int32_t sector, neo_error_s* error) try {
+  NEO_ASSERT(count >= 0 && count <= NEO_MAX_SAMPLES);
+  NEO_ASSERT(count == 0 || (angles && distances));
+  NEO_ASSERT(error);
+
+  std::unique_ptr<neo_scan> out{new neo_scan};
+
+  out->count = count;
+  out->revolution = revolution;
+  out->sector = sector;
+  out->timestamp = 0;
+
+  for ( int32_t n = 0; n < count; ++n ) {
+    out->samples[n].angle = angles[n];
+    out->samples[n].distance = distances[n];
+  }
+
+  return out.release();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_scan_set_timestamp(neo_scan_s scan, int64_t timestamp) {
+  NEO_ASSERT(scan);
+
+  scan->timestamp = timestamp;
+}
+
+int32_t neo_scan_encode_bound(neo_scan_s scan) {
+  NEO_ASSERT(scan);
+
+  return neo::codec::encode_bound(scan->count);
+}
+
+int32_t neo_scan_encode(neo_scan_s scan, int32_t flags, uint8_t* buffer,
+    int32_t capacity, neo_error_s* error) try {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(buffer);
+  NEO_ASSERT(error);
+
+  return neo::codec::encode(*scan, flags, buffer, capacity);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return 0;
+}
+
+neo_scan_s neo_scan_decode(const uint8_t* buffer, int32_t size,
+    neo_error_s* error) try {
+  NEO_ASSERT(buffer || size == 0);  // empty input is merely truncated
+  NEO_ASSERT(error);
+
+  std::unique_ptr<neo_scan> out{new neo_scan};
+  neo::codec::decode(buffer, size, *out);
+
+  return out.release();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+neo_shm_reader_s neo_shm_reader_construct(const char* name,
+    neo_error_s* error) try {
+  NEO_ASSERT(name);
+  NEO_ASSERT(error);
+
+  const auto reader = neo::shm::reader_construct(name);
+
+  auto out = new neo_shm_reader{reader};
+  return out;
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_shm_reader_destruct(neo_shm_reader_s reader) {
+  NEO_ASSERT(reader);
+
+  neo::shm::reader_destruct(reader->reader);
+  delete reader;
+}
+
+neo_archive_writer_s neo_archive_writer_construct(const char* path,
+    int32_t chunk_scans, neo_error_s* error) try {
+  NEO_ASSERT(path);
+  NEO_ASSERT(chunk_scans >= 1);
+  NEO_ASSERT(error);
+
+  std::unique_ptr<neo::archive::writer> writer{
+    new neo::archive::writer{path, chunk_scans}};
+
+  return new neo_archive_writer{std::move(writer)};
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_archive_writer_destruct(neo_archive_writer_s writer) {
+  NEO_ASSERT(writer);
+
+  delete writer;
+}
+
+void neo_archive_writer_append(neo_archive_writer_s writer, neo_scan_s scan,
+    neo_error_s* error) try {
+  NEO_ASSERT(writer);
+  NEO_ASSERT(scan);
+  NEO_ASSERT(error);
+
+  writer->writer->append(scan->samples, scan->count, scan->revolution,
+      scan->timestamp);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+}
+
+void neo_archive_writer_flush(neo_archive_writer_s writer,
+    neo_error_s* error) try {
+  NEO_ASSERT(writer);
+  NEO_ASSERT(error);
+
+  writer->writer->flush();
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+}
+
+uint64_t neo_archive_writer_get_dropped(neo_archive_writer_s writer) {
+  NEO_ASSERT(writer);
+
+  return writer->writer->dropped();
+}
+
+neo_archive_reader_s neo_archive_reader_construct(const char* path,
+    neo_error_s* error) try {
+  NEO_ASSERT(path);
+  NEO_ASSERT(error);
+
+  std::unique_ptr<neo::archive::reader> reader{new neo::archive::reader{path}};
+
+  return new neo_archive_reader{std::move(reader)};
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
+}
+
+void neo_archive_reader_destruct(neo_archive_reader_s reader) {
+  NEO_ASSERT(reader);
+
+  delete reader;
+}
+
+int64_t neo_archive_reader_get_count(neo_archive_reader_s reader) {
+  NEO_ASSERT(reader);
+
+  return static_cast<int64_t>(reader->reader->count());
+}
+
+int64_t neo_archive_reader_find(neo_archive_reader_s reader, int64_t timestamp) {
+  NEO_ASSERT(reader);
+
+  return static_cast<int64_t>(reader->reader->find(timestamp));
+}
+
+static neo::archive::view neo_archive_reader_at(neo_archive_reader_s reader,
+    int64_t scan) {
+  NEO_ASSERT(reader);
+  NEO_ASSERT(scan >= 0 && "archived scan index out of bounds.");
+
+  return reader->reader->at(static_cast<uint64_t>(scan));
+}
+
+int64_t neo_archive_reader_get_timestamp(neo_archive_reader_s reader,
+    int64_t scan) {
+  return neo_archive_reader_at(reader, scan).timestamp;
+}
+
+int32_t neo_archive_reader_get_revolution(neo_archive_reader_s reader,
+    int64_t scan) {
+  return neo_archive_reader_at(reader, scan).revolution;
+}
+
+int32_t neo_archive_reader_get_number_of_samples(neo_archive_reader_s reader,
+    int64_t scan) {
+  return neo_archive_reader_at(reader, scan).count;
+}
+
+const float* neo_archive_reader_get_angles(neo_archive_reader_s reader,
+    int64_t scan) {
+  return neo_archive_reader_at(reader, scan).angles;
+}
+
+const int32_t* neo_archive_reader_get_distances(neo_archive_reader_s reader,
+    int64_t scan) {
+  return neo_archive_reader_at(reader, scan).distances;
+}
+
+bool neo_shm_reader_read(neo_shm_reader_s reader, neo_scan_s scan,
+    int32_t timeout_ms, neo_error_s* error) try {
+  NEO_ASSERT(reader);
+  NEO_ASSERT(scan);
+  NEO_ASSERT(error);
+
+  return neo::shm::reader_read(reader->reader, timeout_ms, *scan);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return false;
+}
+
+uint64_t neo_shm_reader_get_sequence(neo_shm_reader_s reader) {
+  NEO_ASSERT(reader);
 
-#define NEO_MAX_SAMPLES 4096
+  return neo::shm::reader_sequence(reader->reader);
+}
 
-struct sample {
-  float angle;             // in degrees
-  int32_t distance;        // in cm
-  // int32_t signal_strength[NEO_MAX_SAMPLES]; // range 0:255
-};
+uint64_t neo_shm_reader_get_dropped(neo_shm_reader_s reader) {
+  NEO_ASSERT(reader);
 
-struct neo_scan {
-  sample samples[NEO_MAX_SAMPLES];
-  int32_t count;
-};
+  return neo::shm::reader_dropped(reader->reader);
+}
 
-static sample parse_payload(const neo::protocol::response_scan_packet_s &msg) {
-  sample ret;
-  ret.angle = static_cast<float>(msg.angle) / 128; // angle / 128
-  ret.distance = ((int32_t)msg.distance_low)
-    + ((int32_t)msg.distance_high << 5);
+/*
+int32_t neo_scan_get_signal_strength(neo_scan_s scan, int32_t sample) {
+  NEO_ASSERT(scan);
+  NEO_ASSERT(sample >= 0 && sample < scan->count &&
+      "sample index out of bounds.");
 
-  return ret;
+  return scan->samples[sample].signal_strength;
 }
+*/
 
-static void neo_device_accumulate_scans(neo_device_s device) try {
-  NEO_ASSERT(device);
-  NEO_ASSERT(device->is_scanning);
+void neo_scan_destruct(neo_scan_s scan) {
+  NEO_ASSERT(scan);
 
-  sample buffer[NEO_MAX_SAMPLES];
-  int32_t received = 0;
+  delete scan;
+}
 
-  while ( !device->stop_thread && received < NEO_MAX_SAMPLES ) {
-    const auto response = neo::protocol::read_response_scan(device->serial);
+static int32_t neo_device_query_motor_speed(neo_device_s device) {
+  neo::protocol::write_command(device->transport, neo::protocol::MOTOR_INFORMATION);
 
-    buffer[received++] = parse_payload(response);
+  const auto response = neo::protocol::read_response_info_motor(device->transport);
 
-    const bool is_sync = response.s1
-      & neo::protocol::response_scan_packet_sync::sync;
+  int32_t speed = neo::protocol::ascii_bytes_to_integral(response.motor_speed);
+  NEO_ASSERT(speed >= 0);
 
-     if ( received > 2
-         && (is_sync || (buffer[received-2].angle > buffer[received-1].angle)) ) {
-      auto out = std::unique_ptr<neo_scan>(new neo_scan);
-      out->count = received - 1;
-      std::copy_n(std::begin(buffer), received - 1, std::begin(out->samples));
+  return speed;
+}
+
+static void neo_device_adjust_motor_speed(neo_device_s device, int32_t hz) {
+  uint8_t args[2] = {0};
+  neo::protocol::integral_to_ascii_bytes(hz, args);
 
-      device ->scan_queue.enqueue({std::move(out), nullptr});
+  neo::protocol::write_command_with_arguments(device->transport,
+      neo::protocol::MOTOR_SPEED_ADJUST, args);
+  neo::protocol::read_response_param(device->transport,
+      neo::protocol::MOTOR_SPEED_ADJUST);
 
-      buffer[0] = buffer[received - 1];
-      received = 1;
-    }
+  if ( 0 != hz ) {
+    printf("Wait the motor speed stabilizes...\n");
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+
+    // A stopped motor is no speed to bring the unit up with next time
+    device->profile.motor_speed = hz;
+    neo_device_save_profile(device);
   }
-} catch (...) {
-  // worker thread is dead at this point
-  device->scan_queue.enqueue({nullptr, std::current_exception()});
 }
 
-// Constructor hidden from users
-static neo_error_s neo_error_construct(const char* what) {
-  NEO_ASSERT(what);
+static int32_t neo_device_query_sample_rate(neo_device_s device) {
+  neo::protocol::write_command(device->transport,
+      neo::protocol::SAMPLE_RATE_INFORMATION);
 
-  auto out = new neo_error{what};
-  return out;
+  const auto response = neo::protocol::read_response_info_sample_rate(
+      device->transport);
+
+  return neo::density::sample_rate_from_code(
+      neo::protocol::ascii_bytes_to_integral(response.sample_rate));
 }
 
-const char* neo_error_message(neo_error_s error) {
-  NEO_ASSERT(error);
+static void neo_device_adjust_sample_rate(neo_device_s device, int32_t hz) {
+  uint8_t args[2] = {0};
+  neo::protocol::integral_to_ascii_bytes(
+      neo::density::sample_rate_to_code(hz), args);
 
-  return error->what.c_str();
+  neo::protocol::write_command_with_arguments(device->transport,
+      neo::protocol::SAMPLE_RATE_ADJUST, args);
+  neo::protocol::read_response_param(device->transport,
+      neo::protocol::SAMPLE_RATE_ADJUST);
 }
 
-void neo_error_destruct(neo_error_s error) {
-  NEO_ASSERT(error);
+// Every motor speed change costs seconds of spin-up; only touch what differs
+static void neo_device_apply_density(neo_device_s device,
+    const neo::density::setting& setting) {
+  if ( neo_device_query_sample_rate(device) != setting.sample_rate )
+    neo_device_adjust_sample_rate(device, setting.sample_rate);
 
-  delete error;
+  if ( neo_device_query_motor_speed(device) != setting.motor_speed )
+    neo_device_adjust_motor_speed(device, setting.motor_speed);
 }
 
-neo_device_s neo_device_construct_simple(const char* port,
+int32_t neo_device_get_motor_speed(neo_device_s device,
     neo_error_s* error) try {
+  NEO_ASSERT(device);
   NEO_ASSERT(error);
+  NEO_ASSERT(!device->is_scanning);
 
-  return neo_device_construct(port, 115200, error);
+  if ( device->remote ) {
+    return device->remote_info.motor_speed;
+  }
+
+  neo_device_require_local(device);
+
+  return neo_device_query_motor_speed(device);
 } catch ( const std::exception& e ) {
   *error = neo_error_construct(e.what());
-  return nullptr;
+  return -1;
 }
 
-neo_device_s neo_device_construct(const char* port, int32_t baudrate,
+void neo_device_set_motor_speed(neo_device_s device, int32_t hz,
     neo_error_s* error) try {
-  NEO_ASSERT(port);
-  NEO_ASSERT(baudrate > 0);
+  NEO_ASSERT(device);
+  NEO_ASSERT(hz >= 0 && hz <= 10);
   NEO_ASSERT(error);
+  NEO_ASSERT(!device->is_scanning);
 
-  neo::serial::device_s serial = neo::serial::device_construct(port, baudrate);
-
-  auto out = new neo_device{serial, /*is_scanning=*/true,
-  /*stop_thread=*/{false}, /*scan_queue=*/{20}};
+  neo_device_require_local(device);
 
-  // Stop all process to recovery
-  neo_device_stop_scanning(out, error);
+  neo_device_adjust_motor_speed(device, hz);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+}
 
-  // Setting motor running
-  neo_device_set_motor_speed(out, 5, error);
+void neo_device_relearn_background(neo_device_s device,
+    neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
 
-  // device calibration
-  neo_device_calibrate(out, error);
+  if ( !device->background )
+    throw neo::error::error{"background subtraction is disabled."};
 
-  // Stop motor
-  // neo_device_set_motor_speed(out, 0, error);
+  device->relearn_background = true;
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+}
 
-  neo_device_stop_scanning(out, error);
+neo_identity_s neo_device_get_identity(neo_device_s device,
+    neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(!device->is_scanning);
 
+  neo_device_require_local(device);
 
-  return out;
+  return new neo_identity(neo_query_identity(device->transport));
 } catch ( const std::exception& e ) {
   *error = neo_error_construct(e.what());
   return nullptr;
 }
 
-void neo_device_destruct(neo_device_s device) {
-  NEO_ASSERT(device);
+void neo_identity_destruct(neo_identity_s identity) {
+  NEO_ASSERT(identity);
 
-  try {
-    neo_error_s ignore = nullptr;
-    neo_device_stop_scanning(device, &ignore);
-  } catch (...) {
-    // nothing we can do here
-  }
+  delete identity;
+}
 
-  neo::serial::device_destruct(device->serial);
-  delete device;
+const char* neo_identity_get_model(neo_identity_s identity) {
+  NEO_ASSERT(identity);
+
+  return identity->model.c_str();
 }
 
-void neo_device_start_scanning(neo_device_s device, neo_error_s* error) try {
-  NEO_ASSERT(device);
-  NEO_ASSERT(error);
-  NEO_ASSERT(!device->is_scanning);
+const char* neo_identity_get_serial_number(neo_identity_s identity) {
+  NEO_ASSERT(identity);
 
-  if (device->is_scanning)
-    return;
+  return identity->serial_number.c_str();
+}
 
-  neo::protocol::write_command(device->serial,
-      neo::protocol::DATA_ACQUISITION_START);
+const char* neo_identity_get_protocol_version(neo_identity_s identity) {
+  NEO_ASSERT(identity);
 
-  neo::protocol::read_response_header(device->serial,
-      neo::protocol::DATA_ACQUISITION_START);
+  return identity->protocol_version.c_str();
+}
 
-  device->scan_queue.clear();
-  device->is_scanning = true;
-  device->stop_thread = false;
+const char* neo_identity_get_firmware_version(neo_identity_s identity) {
+  NEO_ASSERT(identity);
 
-  std::thread th = std::thread(neo_device_accumulate_scans, device);
-  th.detach();
-} catch (const std::exception& e) {
-  *error = neo_error_construct(e.what());
+  return identity->firmware_version.c_str();
 }
 
-void neo_device_stop_scanning(neo_device_s device, neo_error_s* error) try {
-  NEO_ASSERT(device);
-  NEO_ASSERT(error);
+int32_t neo_identity_get_hardware_version(neo_identity_s identity) {
+  NEO_ASSERT(identity);
 
-  if (!device->is_scanning)
-    return;
-  device->stop_thread = true;
+  return identity->hardware_version;
+}
+
+int32_t neo_identity_get_bit_rate(neo_identity_s identity) {
+  NEO_ASSERT(identity);
+
+  return identity->bit_rate;
+}
+
+int32_t neo_identity_get_motor_speed(neo_identity_s identity) {
+  NEO_ASSERT(identity);
+
+  return identity->motor_speed;
+}
+
+int32_t neo_identity_get_sample_rate(neo_identity_s identity) {
+  NEO_ASSERT(identity);
+
+  return identity->sample_rate;
+}
+
+// A port under probe by its own thread during discovery
+struct neo_probe {
+  std::string port;
+  neo::transport::transport_s transport;  // once open; set under the mutex
+  bool done;
+  bool found;
+  neo_identity identity;
+};
+
+// What the probing threads share with the discovering one
+struct neo_probing {
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool cancelled;  // the discovery stopped waiting; set under the mutex
+};
+
+// Stops a stream the unit may have been left running and asks for its
+// identity; throws transport::interrupted once the discovery gives up
+static void neo_probe_port(neo_probing& probing, neo_probe& probe,
+    int32_t baudrate) {
+  const auto transport = neo::transport::transport_construct(probe.port.c_str(),
+      baudrate, neo::serial::config{neo::serial::profile::standard, false});
 
-  neo::protocol::write_command(device->serial,
-      neo::protocol::DATA_ACQUISITION_STOP);
+  {
+    std::lock_guard<std::mutex> lock(probing.mutex);
+    probe.transport = transport;
+
+    if ( probing.cancelled )
+      throw neo::transport::interrupted{"discovery timed out."};
+  }
+
+  neo::protocol::write_command(transport, neo::protocol::DATA_ACQUISITION_STOP);
 
-  // Wait some time for a few reasons: reference to sweep-sdk
   std::this_thread::sleep_for(std::chrono::milliseconds(35));
 
-  try {
-    neo::protocol::read_response_header(device->serial,
-        neo::protocol::DATA_ACQUISITION_STOP);
-  } catch ( const std::exception& ignore ) {
-    (void) ignore;
+  // Also drops an interrupt from the discovery, which is seen by then
+  neo::transport::transport_flush(transport);
+
+  {
+    std::lock_guard<std::mutex> lock(probing.mutex);
+
+    if ( probing.cancelled )
+      throw neo::transport::interrupted{"discovery timed out."};
   }
 
-  // Flush any bytes left over
-  neo::serial::device_flush(device->serial);
+  probe.identity = neo_query_identity(transport);
+  probe.found = true;
+}
+
+neo_discovery_s neo_discover(int32_t baudrate, int32_t timeout_ms,
+    neo_error_s* error) try {
+  NEO_ASSERT(error);
 
-  neo::protocol::write_command(device->serial,
-      neo::protocol::DATA_ACQUISITION_STOP);
+  const auto ports = neo::serial::list_ports();
 
-  neo::protocol::read_response_header(device->serial,
-      neo::protocol::DATA_ACQUISITION_STOP);
+  std::vector<const char*> names;
 
-  device->is_scanning = false;
+  for ( const auto& port : ports )
+    names.push_back(port.c_str());
+
+  return neo_discover_ports(names.data(), static_cast<int32_t>(names.size()),
+      baudrate, timeout_ms, error);
 } catch ( const std::exception& e ) {
   *error = neo_error_construct(e.what());
+  return nullptr;
 }
 
-neo_scan_s neo_device_get_scan(neo_device_s device, neo_error_s* error) try {
-  NEO_ASSERT(device);
+// One thread per port, so the slowest port bounds the whole discovery;
+// ports still busy at the deadline are woken up by interrupting them
+neo_discovery_s neo_discover_ports(const char* const* ports, int32_t count,
+    int32_t baudrate, int32_t timeout_ms, neo_error_s* error) try {
+  NEO_ASSERT(count >= 0);
+  NEO_ASSERT(count == 0 || ports);
+  NEO_ASSERT(baudrate > 0);
+  NEO_ASSERT(timeout_ms > 0);
   NEO_ASSERT(error);
-  NEO_ASSERT(device->is_scanning);
 
-  auto out = device->scan_queue.dequeue();
+  neo_probing probing;
+  probing.cancelled = false;
 
-  if ( out.error != nullptr ) {
-    std::rethrow_exception(out.error);
+  // Never resized from here on: the threads hold on to their entries
+  std::vector<neo_probe> probes(count);
+
+  for ( int32_t n = 0; n < count; ++n ) {
+    NEO_ASSERT(ports[n]);
+
+    probes[n] = {ports[n], /*transport=*/nullptr, /*done=*/false,
+      /*found=*/false, /*identity=*/{}};
   }
 
-  return out.scan.release();
+  std::vector<std::thread> threads;
+
+  const auto cancel = [&] {
+    {
+      std::lock_guard<std::mutex> lock(probing.mutex);
+      probing.cancelled = true;
+
+      for ( auto& probe : probes )
+        if ( !probe.done && probe.transport )
+          neo::transport::transport_interrupt(probe.transport);
+    }
+
+    for ( auto& thread : threads )
+      thread.join();
+
+    for ( auto& probe : probes )
+      if ( probe.transport )
+        neo::transport::transport_destruct(probe.transport);
+  };
+
+  try {
+    for ( auto& probe : probes ) {
+      threads.emplace_back([&probing, &probe, baudrate] {
+        try {
+          neo_probe_port(probing, probe, baudrate);
+        } catch (...) {
+          // no device there, busy, or too slow
+        }
+
+        std::lock_guard<std::mutex> lock(probing.mutex);
+        probe.done = true;
+        probing.finished.notify_all();
+      });
+    }
+  } catch (...) {
+    cancel();
+    throw;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(probing.mutex);
+
+    probing.finished.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&] {
+      return std::all_of(probes.begin(), probes.end(),
+          [](const neo_probe& probe) { return probe.done; });
+    });
+  }
+
+  cancel();
+
+  std::unique_ptr<neo_discovery> out{new neo_discovery};
+
+  for ( const auto& probe : probes ) {
+    if ( probe.found ) {
+      out->ports.push_back(probe.port);
+      out->identities.push_back(probe.identity);
+    }
+  }
+
+  return out.release();
 } catch ( const std::exception& e ) {
   *error = neo_error_construct(e.what());
   return nullptr;
 }
 
-int32_t neo_scan_get_number_of_samples(neo_scan_s scan) {
-  NEO_ASSERT(scan);
-  NEO_ASSERT(scan->count >= 0);
+void neo_discovery_destruct(neo_discovery_s discovery) {
+  NEO_ASSERT(discovery);
 
-  return scan->count;
+  delete discovery;
 }
 
-float neo_scan_get_angle(neo_scan_s scan, int32_t sample) {
-  NEO_ASSERT(scan);
-  NEO_ASSERT(sample >= 0 && sample < scan->count &&
-      "sample index out of bounds.");
+int32_t neo_discovery_get_count(neo_discovery_s discovery) {
+  NEO_ASSERT(discovery);
 
-  return scan->samples[sample].angle;
+  return static_cast<int32_t>(discovery->ports.size());
 }
 
-int32_t neo_scan_get_distance(neo_scan_s scan, int32_t sample) {
-  NEO_ASSERT(scan);
-  NEO_ASSERT(sample >= 0 && sample < scan->count &&
-      "sample index out of bounds.");
+const char* neo_discovery_get_port(neo_discovery_s discovery, int32_t index) {
+  NEO_ASSERT(discovery);
+  NEO_ASSERT(index >= 0 && index < neo_discovery_get_count(discovery)
+      && "discovered device index out of bounds.");
 
-  return scan->samples[sample].distance;
+  return discovery->ports[index].c_str();
 }
 
-/*
-int32_t neo_scan_get_signal_strength(neo_scan_s scan, int32_t sample) {
-  NEO_ASSERT(scan);
-  NEO_ASSERT(sample >= 0 && sample < scan->count &&
-      "sample index out of bounds.");
+neo_identity_s neo_discovery_get_identity(neo_discovery_s discovery,
+    int32_t index, neo_error_s* error) try {
+  NEO_ASSERT(discovery);
+  NEO_ASSERT(index >= 0 && index < neo_discovery_get_count(discovery)
+      && "discovered device index out of bounds.");
+  NEO_ASSERT(error);
 
-  return scan->samples[sample].signal_strength;
+  return new neo_identity(discovery->identities[index]);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return nullptr;
 }
-*/
 
-void neo_scan_destruct(neo_scan_s scan) {
-  NEO_ASSERT(scan);
+int32_t neo_device_get_sample_rate(neo_device_s device,
+    neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(error);
+  NEO_ASSERT(!device->is_scanning);
 
-  delete scan;
+  neo_device_require_local(device);
+
+  return neo_device_query_sample_rate(device);
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+  return -1;
 }
 
-int32_t neo_device_get_motor_speed(neo_device_s device,
+void neo_device_set_sample_rate(neo_device_s device, int32_t hz,
     neo_error_s* error) try {
   NEO_ASSERT(device);
+  NEO_ASSERT(hz == 500 || hz == 750 || hz == 1000);
   NEO_ASSERT(error);
   NEO_ASSERT(!device->is_scanning);
 
-  neo::protocol::write_command(device->serial, neo::protocol::MOTOR_INFORMATION);
-
-  const auto response = neo::protocol::read_response_info_motor(device->serial);
-
-  int32_t speed = neo::protocol::ascii_bytes_to_integral(response.motor_speed);
-  NEO_ASSERT(speed >= 0);
+  neo_device_require_local(device);
 
-  return speed;
+  neo_device_adjust_sample_rate(device, hz);
 } catch ( const std::exception& e ) {
   *error = neo_error_construct(e.what());
-  return -1;
 }
 
-void neo_device_set_motor_speed(neo_device_s device, int32_t hz,
+void neo_device_set_target_resolution(neo_device_s device, float degrees,
     neo_error_s* error) try {
   NEO_ASSERT(device);
-  NEO_ASSERT(hz >= 0 && hz <= 10);
+  NEO_ASSERT(degrees > 0);
   NEO_ASSERT(error);
   NEO_ASSERT(!device->is_scanning);
 
-  uint8_t args[2] = {0};
-  neo::protocol::integral_to_ascii_bytes(hz, args);
+  neo_device_require_local(device);
 
-  neo::protocol::write_command_with_arguments(device->serial,
-      neo::protocol::MOTOR_SPEED_ADJUST, args);
-  neo::protocol::read_response_param(device->serial,
-      neo::protocol::MOTOR_SPEED_ADJUST);
+  neo_device_apply_density(device,
+      neo::density::for_resolution(degrees, device->baudrate));
+} catch ( const std::exception& e ) {
+  *error = neo_error_construct(e.what());
+}
 
-  if ( 0 != hz ) {
-    printf("Wait the motor speed stabilizes...\n");
-    std::this_thread::sleep_for(std::chrono::seconds(5));
-  }
+void neo_device_set_target_update_rate(neo_device_s device, int32_t hz,
+    neo_error_s* error) try {
+  NEO_ASSERT(device);
+  NEO_ASSERT(hz >= 1 && hz <= 10);
+  NEO_ASSERT(error);
+  NEO_ASSERT(!device->is_scanning);
 
+  neo_device_require_local(device);
+
+  neo_device_apply_density(device,
+      neo::density::for_update_rate(hz, device->baudrate));
 } catch ( const std::exception& e ) {
   *error = neo_error_construct(e.what());
 }
@@ -327,7 +2690,9 @@ void neo_device_reset(neo_device_s device, neo_error_s* error) try {
   NEO_ASSERT(error);
   NEO_ASSERT(!device->is_scanning);
 
-  neo::protocol::write_command(device->serial, neo::protocol::RESET_DEVICE);
+  neo_device_require_local(device);
+
+  neo::protocol::write_command(device->transport, neo::protocol::RESET_DEVICE);
 } catch ( const std::exception& e ) {
   *error = neo_error_construct(e.what());
 }
@@ -337,14 +2702,19 @@ void neo_device_calibrate(neo_device_s device, neo_error_s* error) try {
   NEO_ASSERT(error);
   NEO_ASSERT(!device->is_scanning);
 
-  neo::protocol::write_command(device->serial,
+  neo_device_require_local(device);
+
+  neo::protocol::write_command(device->transport,
       neo::protocol::DEVICE_CALIBRATION);
 
   printf("wait device calibration...  \n");
 
 
-  neo::protocol::read_response_header(device->serial,
+  neo::protocol::read_response_header(device->transport,
       neo::protocol::DEVICE_CALIBRATION);
+
+  device->profile.calibrated_at = static_cast<int64_t>(std::time(nullptr));
+  neo_device_save_profile(device);
 } catch ( const std::exception& e ) {
   *error = neo_error_construct(e.what());
 }
@@ -0,0 +1,337 @@
+#include "odometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace neo {
+namespace odometry {
+
+constexpr float pi = 3.14159265358979f;
+constexpr float degrees_per_radian = 180 / pi;
+
+constexpr int32_t min_distance = 2;      // cm, the device reports 1 for no return
+constexpr float huber = 5;               // cm, residuals beyond count linearly
+constexpr int32_t max_iterations = 30;
+constexpr float converged_shift = 0.01f;  // cm
+constexpr float converged_turn = 1e-5f;   // radians
+constexpr int32_t min_correspondences = 16;
+
+// Accumulator lanes of the normal equations: independent partial sums the
+// compiler keeps in vector registers without reassociating float additions
+constexpr int32_t lanes = 8;
+
+matcher::pose matcher::compose(const pose& a, const pose& b) {
+  const double c = std::cos(a.theta);
+  const double s = std::sin(a.theta);
+
+  return {a.x + c * b.x - s * b.y, a.y + s * b.x + c * b.y, a.theta + b.theta};
+}
+
+matcher::pose matcher::inverse(const pose& a) {
+  const double c = std::cos(a.theta);
+  const double s = std::sin(a.theta);
+
+  return {-c * a.x - s * a.y, s * a.x - c * a.y, -a.theta};
+}
+
+matcher::matcher(const settings& config)
+    : config(config), bucket_mask(0), has_reference(false),
+    keyframe{0, 0, 0}, relative{0, 0, 0}, motion{0, 0, 0} {
+  NEO_ASSERT(config.max_distance > 0);
+  NEO_ASSERT(config.keyframe_distance >= 0);
+  NEO_ASSERT(config.keyframe_angle >= 0);
+}
+
+void matcher::to_cloud(const sample* samples, int32_t count, cloud& out) {
+  out.x.clear();
+  out.y.clear();
+
+  for ( int32_t n = 0; n < count; ++n ) {
+    if ( samples[n].distance < min_distance )
+      continue;
+
+    const float angle = samples[n].angle / degrees_per_radian;
+    const float distance = static_cast<float>(samples[n].distance);
+
+    out.x.push_back(distance * std::cos(angle));
+    out.y.push_back(distance * std::sin(angle));
+  }
+}
+
+static uint32_t bucket_of(int32_t cell_x, int32_t cell_y, uint32_t mask) {
+  return ((static_cast<uint32_t>(cell_x) * 73856093u)
+      ^ (static_cast<uint32_t>(cell_y) * 19349663u)) & mask;
+}
+
+static int32_t cell_of(float coordinate, float size) {
+  return static_cast<int32_t>(std::floor(coordinate / size));
+}
+
+void matcher::set_reference() {
+  std::swap(reference, current);
+
+  const int32_t count = static_cast<int32_t>(reference.x.size());
+  const float gate = config.max_distance * config.max_distance;
+
+  // Line normals from the neighbors in scan order, which wraps around
+  normal_x.assign(count, 0);
+  normal_y.assign(count, 0);
+
+  for ( int32_t n = 0; count >= 3 && n < count; ++n ) {
+    const int32_t prev = n == 0 ? count - 1 : n - 1;
+    const int32_t next = n == count - 1 ? 0 : n + 1;
+
+    const float px = reference.x[prev] - reference.x[n];
+    const float py = reference.y[prev] - reference.y[n];
+    const float nx = reference.x[next] - reference.x[n];
+    const float ny = reference.y[next] - reference.y[n];
+
+    // Neighbors across a depth discontinuity do not span a line
+    if ( px * px + py * py > gate || nx * nx + ny * ny > gate )
+      continue;
+
+    const float tx = nx - px;
+    const float ty = ny - py;
+    const float length = std::sqrt(tx * tx + ty * ty);
+
+    if ( length == 0 )
+      continue;
+
+    normal_x[n] = -ty / length;
+    normal_y[n] = tx / length;
+  }
+
+  // Counting sort of the points by bucket
+  uint32_t buckets = 64;
+
+  while ( buckets < 2u * static_cast<uint32_t>(count) )
+    buckets *= 2;
+
+  bucket_mask = buckets - 1;
+  start.assign(buckets + 1, 0);
+  order.resize(count);
+
+  std::vector<uint32_t> bucket(count);
+
+  for ( int32_t n = 0; n < count; ++n ) {
+    bucket[n] = bucket_of(cell_of(reference.x[n], config.max_distance),
+        cell_of(reference.y[n], config.max_distance), bucket_mask);
+    ++start[bucket[n] + 1];
+  }
+
+  for ( uint32_t b = 0; b < buckets; ++b )
+    start[b + 1] += start[b];
+
+  std::vector<int32_t> cursor(start.begin(), start.end() - 1);
+
+  for ( int32_t n = 0; n < count; ++n )
+    order[cursor[bucket[n]]++] = n;
+}
+
+int32_t matcher::closest(float x, float y) const {
+  const int32_t cell_x = cell_of(x, config.max_distance);
+  const int32_t cell_y = cell_of(y, config.max_distance);
+
+  float best = config.max_distance * config.max_distance;
+  int32_t found = -1;
+
+  for ( int32_t dy = -1; dy <= 1; ++dy ) {
+    for ( int32_t dx = -1; dx <= 1; ++dx ) {
+      const uint32_t b = bucket_of(cell_x + dx, cell_y + dy, bucket_mask);
+
+      for ( int32_t k = start[b]; k < start[b + 1]; ++k ) {
+        const int32_t n = order[k];
+
+        if ( normal_x[n] == 0 && normal_y[n] == 0 )
+          continue;
+
+        const float ex = reference.x[n] - x;
+        const float ey = reference.y[n] - y;
+        const float squared = ex * ex + ey * ey;
+
+        if ( squared < best ) {
+          best = squared;
+          found = n;
+        }
+      }
+    }
+  }
+
+  return found;
+}
+
+bool matcher::register_current(pose& guess, float* covariance,
+    int32_t& matched) {
+  const int32_t count = static_cast<int32_t>(current.x.size());
+
+  pair_x.resize(count);
+  pair_y.resize(count);
+  pair_nx.resize(count);
+  pair_ny.resize(count);
+  pair_d.resize(count);
+
+  // Normal equations J^T W J and J^T W r, upper triangle, plus W r^2
+  double h[10];
+
+  for ( int32_t iteration = 0; iteration < max_iterations; ++iteration ) {
+    const float c = static_cast<float>(std::cos(guess.theta));
+    const float s = static_cast<float>(std::sin(guess.theta));
+    const float tx = static_cast<float>(guess.x);
+    const float ty = static_cast<float>(guess.y);
+
+    matched = 0;
+
+    for ( int32_t n = 0; n < count; ++n ) {
+      const float x = c * current.x[n] - s * current.y[n] + tx;
+      const float y = s * current.x[n] + c * current.y[n] + ty;
+      const int32_t found = closest(x, y);
+
+      if ( found < 0 )
+        continue;
+
+      pair_x[matched] = x;
+      pair_y[matched] = y;
+      pair_nx[matched] = normal_x[found];
+      pair_ny[matched] = normal_y[found];
+      pair_d[matched] = normal_x[found] * reference.x[found]
+        + normal_y[found] * reference.y[found];
+      ++matched;
+    }
+
+    if ( matched < min_correspondences )
+      return false;
+
+    float acc[10][lanes] = {};
+
+    const auto accumulate = [&](int32_t k, int32_t l) {
+      const float nx = pair_nx[k];
+      const float ny = pair_ny[k];
+      const float j2 = ny * pair_x[k] - nx * pair_y[k];
+      const float r = nx * pair_x[k] + ny * pair_y[k] - pair_d[k];
+      const float w = std::min(1.0f, huber / (std::fabs(r) + 1e-6f));
+
+      acc[0][l] += w * nx * nx;
+      acc[1][l] += w * nx * ny;
+      acc[2][l] += w * nx * j2;
+      acc[3][l] += w * ny * ny;
+      acc[4][l] += w * ny * j2;
+      acc[5][l] += w * j2 * j2;
+      acc[6][l] += w * nx * r;
+      acc[7][l] += w * ny * r;
+      acc[8][l] += w * j2 * r;
+      acc[9][l] += w * r * r;
+    };
+
+    int32_t k = 0;
+
+    for ( ; k + lanes <= matched; k += lanes )
+      for ( int32_t l = 0; l < lanes; ++l )
+        accumulate(k + l, l);
+
+    for ( int32_t l = 0; k < matched; ++k, ++l )
+      accumulate(k, l);
+
+    for ( int32_t e = 0; e < 10; ++e ) {
+      h[e] = 0;
+
+      for ( int32_t l = 0; l < lanes; ++l )
+        h[e] += acc[e][l];
+    }
+
+    // Inverse of the symmetric 3x3 system by cofactors
+    const double a00 = h[3] * h[5] - h[4] * h[4];
+    const double a01 = h[2] * h[4] - h[1] * h[5];
+    const double a02 = h[1] * h[4] - h[2] * h[3];
+    const double a11 = h[0] * h[5] - h[2] * h[2];
+    const double a12 = h[1] * h[2] - h[0] * h[4];
+    const double a22 = h[0] * h[3] - h[1] * h[1];
+    const double determinant = h[0] * a00 + h[1] * a01 + h[2] * a02;
+
+    // A corridor or a single wall leaves a direction unconstrained
+    if ( !(determinant > 1e-9 * h[0] * h[3] * h[5]) )
+      return false;
+
+    const double dx = -(a00 * h[6] + a01 * h[7] + a02 * h[8]) / determinant;
+    const double dy = -(a01 * h[6] + a11 * h[7] + a12 * h[8]) / determinant;
+    const double dtheta = -(a02 * h[6] + a12 * h[7] + a22 * h[8]) / determinant;
+
+    // The increment moves the transformed points: apply it on the left
+    guess = compose({dx, dy, dtheta}, guess);
+
+    const bool converged = std::hypot(dx, dy) < converged_shift
+      && std::fabs(dtheta) < converged_turn;
+
+    if ( converged || iteration == max_iterations - 1 ) {
+      const double variance = h[9] / std::max(matched - 3, 1);
+      const double inverse[9] = {a00, a01, a02, a01, a11, a12, a02, a12, a22};
+      const float scale[3] = {1, 1, degrees_per_radian};
+
+      for ( int32_t e = 0; e < 9; ++e ) {
+        covariance[e] = static_cast<float>(variance * inverse[e] / determinant)
+          * scale[e / 3] * scale[e % 3];
+      }
+
+      break;
+    }
+  }
+
+  return true;
+}
+
+estimate matcher::add(const sample* samples, int32_t count,
+    int32_t revolution) {
+  NEO_ASSERT(count == 0 || samples);
+
+  to_cloud(samples, count, current);
+
+  estimate out{revolution, 0, 0, 0, {}, 0};
+
+  if ( !has_reference ) {
+    set_reference();
+    has_reference = true;
+    return out;
+  }
+
+  // Constant velocity prediction; without a registration it is the pose
+  pose guess = compose(relative, motion);
+  int32_t matched = 0;
+
+  if ( register_current(guess, out.covariance, matched) ) {
+    out.correspondences = matched;
+    motion = compose(inverse(relative), guess);
+  } else {
+    std::fill(std::begin(out.covariance), std::end(out.covariance), 0.0f);
+  }
+
+  relative = guess;
+
+  const pose world = compose(keyframe, relative);
+  const double heading = std::remainder(world.theta, 2 * static_cast<double>(pi));
+
+  out.x = static_cast<float>(world.x);
+  out.y = static_cast<float>(world.y);
+  out.heading = static_cast<float>(heading) * degrees_per_radian;
+
+  const float distance = config.keyframe_distance;
+  const float angle = config.keyframe_angle;
+
+  const bool moved = (distance == 0 && angle == 0)
+    || (distance > 0 && std::hypot(relative.x, relative.y) >= distance)
+    || (angle > 0 && std::fabs(relative.theta) * degrees_per_radian >= angle);
+
+  // Poor overlap only gets worse from here: match against this scan next
+  const bool overlapping = out.correspondences * 2
+    >= static_cast<int32_t>(current.x.size());
+
+  if ( moved || !overlapping ) {
+    keyframe = {world.x, world.y, heading};
+    relative = {0, 0, 0};
+    set_reference();
+  }
+
+  return out;
+}
+
+}  // namespace odometry
+}  // namespace neo
@@ -0,0 +1,80 @@
+#include "profile.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace neo {
+namespace profile {
+
+constexpr char header[] = "# neo device profiles v1";
+
+static bool parse(const std::string& line, profile& out) {
+  if ( line.empty() || line[0] == '#' )
+    return false;
+
+  std::istringstream fields{line};
+  profile parsed;
+
+  if ( !(fields >> parsed.serial_number >> parsed.baudrate >> parsed.motor_speed
+        >> parsed.calibrated_at) )
+    return false;
+
+  out = parsed;
+  return true;
+}
+
+bool load(const char* path, const std::string& serial_number, profile& out) {
+  NEO_ASSERT(path);
+
+  std::ifstream file{path};
+  std::string line;
+
+  while ( std::getline(file, line) ) {
+    profile parsed;
+
+    if ( parse(line, parsed) && parsed.serial_number == serial_number ) {
+      out = parsed;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool store(const char* path, const profile& in) {
+  NEO_ASSERT(path);
+  NEO_ASSERT(!in.serial_number.empty());
+
+  // Without the lock a concurrent update could drop this unit's line or ours
+  update_lock_s lock = lock_for_update(path);
+
+  if ( !lock )
+    return false;
+
+  std::ostringstream contents;
+  contents << header << '\n';
+
+  {
+    std::ifstream file{path};
+    std::string line;
+
+    while ( std::getline(file, line) ) {
+      profile parsed;
+
+      if ( parse(line, parsed) && parsed.serial_number != in.serial_number )
+        contents << line << '\n';
+    }
+  }
+
+  contents << in.serial_number << ' ' << in.baudrate << ' ' << in.motor_speed
+    << ' ' << in.calibrated_at << '\n';
+
+  // Readers never see a half written file
+  const bool stored = replace(path, contents.str());
+
+  unlock_for_update(lock);
+  return stored;
+}
+
+}  // namespace profile
+}  // namespace neo
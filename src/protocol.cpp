@@ -26,8 +26,8 @@ static uint8_t checksum_response_scan_packet(const response_scan_packet_s& v) {
   return checksum % 15;
 }
 
-void write_command(serial::device_s serial, const uint8_t cmd[2]) {
-  NEO_ASSERT(serial);
+void write_command(transport::transport_s transport, const uint8_t cmd[2]) {
+  NEO_ASSERT(transport);
   NEO_ASSERT(cmd);
 
   cmd_packet_s packet;
@@ -37,12 +37,12 @@ void write_command(serial::device_s serial, const uint8_t cmd[2]) {
 
   std::this_thread::sleep_for(std::chrono::milliseconds(2));
 
-  serial::device_write(serial, &packet, sizeof(cmd_packet_s));
+  transport::transport_write(transport, &packet, sizeof(cmd_packet_s));
 }
 
-void write_command_with_arguments(serial::device_s serial,
+void write_command_with_arguments(transport::transport_s transport,
     const uint8_t cmd[2], const uint8_t arg[2]) {
-  NEO_ASSERT(serial);
+  NEO_ASSERT(transport);
   NEO_ASSERT(cmd);
   NEO_ASSERT(arg);
 
@@ -53,17 +53,17 @@ void write_command_with_arguments(serial::device_s serial,
   packet.cmdParamByte2 = arg[1];
   packet.cmdParamTerm = '\n';
 
-  serial::device_write(serial, &packet, sizeof(cmd_param_packet_s));
+  transport::transport_write(transport, &packet, sizeof(cmd_param_packet_s));
 }
 
-response_header_s read_response_header(serial::device_s serial,
+response_header_s read_response_header(transport::transport_s transport,
     const uint8_t cmd[2]) {
-  NEO_ASSERT(serial);
+  NEO_ASSERT(transport);
   NEO_ASSERT(cmd);
 
   response_header_s header;
 
-  serial::device_read(serial, &header, sizeof(response_header_s));
+  transport::transport_read(transport, &header, sizeof(response_header_s));
 
   uint8_t checksum = checksum_response_header(header);
 
@@ -80,13 +80,13 @@ response_header_s read_response_header(serial::device_s serial,
   return header;
 }
 
-response_param_s read_response_param(serial::device_s serial,
+response_param_s read_response_param(transport::transport_s transport,
     const uint8_t cmd[2]) {
-  NEO_ASSERT(serial);
+  NEO_ASSERT(transport);
   NEO_ASSERT(cmd);
 
   response_param_s param;
-  serial::device_read(serial, &param, sizeof(response_param_s));
+  transport::transport_read(transport, &param, sizeof(response_param_s));
 
   uint8_t checksum = checksum_response_param(param);
 
@@ -102,11 +102,11 @@ response_param_s read_response_param(serial::device_s serial,
   return param;
 }
 
-response_scan_packet_s read_response_scan(serial::device_s serial) {
-  NEO_ASSERT(serial);
+response_scan_packet_s read_response_scan(transport::transport_s transport) {
+  NEO_ASSERT(transport);
 
   response_scan_packet_s scan;
-  serial::device_read(serial, &scan, sizeof(response_scan_packet_s));
+  transport::transport_read(transport, &scan, sizeof(response_scan_packet_s));
 
   uint8_t checksum = checksum_response_scan_packet(scan);
 
@@ -120,12 +120,12 @@ response_scan_packet_s read_response_scan(serial::device_s serial) {
         p2scan[i] = p2scan[i+1];
     }
     error_count++;
-    serial::device_read(serial, (void *) p2scan_back, 1);
+    transport::transport_read(transport, (void *) p2scan_back, 1);
     checksum = checksum_response_scan_packet(scan);
     if(checksum == scan.checksum)
     {
       error_count += 5;
-      serial::device_read(serial, &scan, sizeof(response_scan_packet_s));
+      transport::transport_read(transport, &scan, sizeof(response_scan_packet_s));
       checksum = checksum_response_scan_packet(scan);
     }
   }
@@ -137,11 +137,11 @@ response_scan_packet_s read_response_scan(serial::device_s serial) {
   return scan;
 }
 
-response_info_motor_s read_response_info_motor(serial::device_s serial) {
-  NEO_ASSERT(serial);
+response_info_motor_s read_response_info_motor(transport::transport_s transport) {
+  NEO_ASSERT(transport);
 
   response_info_motor_s info;
-  serial::device_read(serial, &info, sizeof(response_info_motor_s));
+  transport::transport_read(transport, &info, sizeof(response_info_motor_s));
 
   bool ok = info.cmdByte1 == MOTOR_INFORMATION[0] &&
     info.cmdByte2 == MOTOR_INFORMATION[1];
@@ -152,5 +152,70 @@ response_info_motor_s read_response_info_motor(serial::device_s serial) {
   return info;
 }
 
+response_info_device_s read_response_info_device(
+    transport::transport_s transport) {
+  NEO_ASSERT(transport);
+
+  response_info_device_s info;
+  transport::transport_read(transport, &info, sizeof(response_info_device_s));
+
+  bool ok = info.cmdByte1 == DEVICE_INFORMATION[0] &&
+    info.cmdByte2 == DEVICE_INFORMATION[1];
+
+  if ( !ok ) {
+    throw error{"invalid device info response commands."};
+  }
+  return info;
+}
+
+response_info_version_s read_response_info_version(
+    transport::transport_s transport) {
+  NEO_ASSERT(transport);
+
+  response_info_version_s info;
+  transport::transport_read(transport, &info, sizeof(response_info_version_s));
+
+  bool ok = info.cmdByte1 == VERSION_INFORMATION[0] &&
+    info.cmdByte2 == VERSION_INFORMATION[1];
+
+  if ( !ok ) {
+    throw error{"invalid version info response commands."};
+  }
+  return info;
+}
+
+int32_t ascii_field_to_integral(const uint8_t* bytes, int32_t len) {
+  NEO_ASSERT(bytes);
+  NEO_ASSERT(len > 0 && len <= 9);
+
+  int32_t integral = 0;
+
+  for ( int32_t n = 0; n < len; ++n ) {
+    if ( bytes[n] < '0' || bytes[n] > '9' ) {
+      throw error{"invalid digits in info response."};
+    }
+
+    integral = integral * 10 + (bytes[n] - '0');
+  }
+
+  return integral;
+}
+
+response_info_sample_rate_s read_response_info_sample_rate(
+    transport::transport_s transport) {
+  NEO_ASSERT(transport);
+
+  response_info_sample_rate_s info;
+  transport::transport_read(transport, &info, sizeof(response_info_sample_rate_s));
+
+  bool ok = info.cmdByte1 == SAMPLE_RATE_INFORMATION[0] &&
+    info.cmdByte2 == SAMPLE_RATE_INFORMATION[1];
+
+  if ( !ok ) {
+    throw error{"invalid sample rate info response commands."};
+  }
+  return info;
+}
+
 }  // namespace protocol
 }  // namespace neo
@@ -0,0 +1,77 @@
+#include "remote.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace neo {
+namespace remote {
+
+constexpr char scheme[] = "neo://";
+
+bool is_remote(const char* port) {
+  NEO_ASSERT(port);
+
+  return strncmp(port, scheme, sizeof(scheme) - 1) == 0;
+}
+
+static int32_t parse_positive(const std::string& value) {
+  char* end = nullptr;
+  const long v = strtol(value.c_str(), &end, 10);
+
+  if ( value.empty() || *end != '\0' || v < 1 || v > 65535 )
+    throw error{"invalid number in neo:// port string."};
+
+  return static_cast<int32_t>(v);
+}
+
+endpoint parse(const char* port) {
+  NEO_ASSERT(is_remote(port));
+
+  const std::string url{port + sizeof(scheme) - 1};
+  const auto question = url.find('?');
+  const std::string target = url.substr(0, question);
+
+  endpoint out{/*path=*/"", /*host=*/"", /*port=*/"", /*device=*/"",
+    /*decimate=*/1};
+
+  if ( !target.empty() && target[0] == '/' ) {
+    out.path = target;
+  } else {
+    const auto colon = target.rfind(':');
+
+    if ( colon == std::string::npos || colon == 0 || colon + 1 == target.size() )
+      throw error{"neo:// port string needs a socket path or host:port."};
+
+    out.host = target.substr(0, colon);
+    out.port = target.substr(colon + 1);
+    parse_positive(out.port);
+
+    // [::1]:7001
+    if ( out.host.size() > 2 && out.host.front() == '[' && out.host.back() == ']' )
+      out.host = out.host.substr(1, out.host.size() - 2);
+  }
+
+  std::string query = question == std::string::npos ? "" : url.substr(question + 1);
+
+  while ( !query.empty() ) {
+    const auto amp = query.find('&');
+    const std::string pair = query.substr(0, amp);
+    query = amp == std::string::npos ? "" : query.substr(amp + 1);
+
+    const auto equals = pair.find('=');
+    const std::string key = pair.substr(0, equals);
+    const std::string value = equals == std::string::npos ? "" : pair.substr(equals + 1);
+
+    if ( key == "device" )
+      out.device = value;
+    else if ( key == "decimate" )
+      out.decimate = parse_positive(value);
+    else
+      throw error{"unknown option in neo:// port string."};
+  }
+
+  return out;
+}
+
+}  // namespace remote
+}  // namespace neo
@@ -0,0 +1,69 @@
+#include "temporal.hpp"
+
+#include <algorithm>
+
+namespace neo {
+namespace temporal {
+
+filter::filter(int32_t bins, int32_t window, int32_t mode, int32_t tolerance)
+    : bins(bins), window(window), mode(mode), tolerance(tolerance),
+    history(bins * window), sorted(bins * window), filled(0), oldest(0) {
+  NEO_ASSERT(bins >= 1 && bins <= NEO_MAX_GRID_BINS);
+  NEO_ASSERT(window >= 1 && window <= NEO_MAX_TEMPORAL_WINDOW);
+  NEO_ASSERT(mode == NEO_TEMPORAL_MEDIAN || mode == NEO_TEMPORAL_VOTE);
+  NEO_ASSERT(tolerance >= 0);
+}
+
+void filter::apply(int32_t* ranges) {
+  NEO_ASSERT(ranges);
+
+  const bool full = filled == window;
+  const int32_t slot = full ? oldest : filled;
+  const int32_t count = full ? window : filled + 1;
+
+  for ( int32_t b = 0; b < bins; ++b ) {
+    int32_t* ring = &history[b * window];
+    int32_t* order = &sorted[b * window];
+    int32_t* end = order + filled;
+
+    const int32_t distance = ranges[b];
+
+    // The newest distance takes the oldest one's place in the sorted window
+    if ( full ) {
+      int32_t* gone = std::lower_bound(order, end, ring[slot]);
+      std::copy(gone + 1, end, gone);
+      --end;
+    }
+
+    int32_t* at = std::upper_bound(order, end, distance);
+    std::copy_backward(at, end, end + 1);
+    *at = distance;
+
+    ring[slot] = distance;
+
+    if ( mode == NEO_TEMPORAL_MEDIAN ) {
+      ranges[b] = order[(count - 1) / 2];
+      continue;
+    }
+
+    if ( distance == NEO_GRID_EMPTY )
+      continue;
+
+    // Empty bins sort below every distance and never agree with one
+    const int32_t* low = std::lower_bound(order, order + count,
+        std::max(distance - tolerance, 0));
+    const int32_t* high = std::upper_bound(order, order + count,
+        distance + tolerance);
+
+    if ( 2 * (high - low) <= count )
+      ranges[b] = NEO_GRID_EMPTY;
+  }
+
+  if ( full )
+    oldest = (oldest + 1) % window;
+  else
+    ++filled;
+}
+
+}  // namespace temporal
+}  // namespace neo
@@ -0,0 +1,153 @@
+#include "tracking.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace neo {
+namespace tracking {
+
+constexpr float measurement_variance = 10 * 10;  // cm^2, of a cluster centroid
+constexpr float acceleration = 200;              // cm/s^2, white noise
+constexpr float initial_speed = 200;             // cm/s, one sigma
+constexpr int32_t confirm_hits = 3;
+
+tracker::tracker(const settings& config)
+    : config(config), tracks(NEO_MAX_TRACKS),
+    taken(NEO_MAX_CLUSTERS), last_timestamp(0), next_id(0) {
+  NEO_ASSERT(config.max_distance > 0);
+  NEO_ASSERT(config.max_misses >= 0);
+
+  candidates.reserve(NEO_MAX_TRACKS * NEO_MAX_CLUSTERS);
+  reset();
+}
+
+void tracker::reset() {
+  for ( state& s : tracks )
+    s.used = false;
+
+  last_timestamp = 0;
+  next_id = 0;
+}
+
+void tracker::predict(state& s, float dt) const {
+  const float q = acceleration * acceleration;
+
+  s.x += s.vx * dt;
+  s.y += s.vy * dt;
+
+  s.pp += dt * (2 * s.pv + dt * s.vv) + q * dt * dt * dt * dt / 4;
+  s.pv += dt * s.vv + q * dt * dt * dt / 2;
+  s.vv += q * dt * dt;
+}
+
+void tracker::correct(state& s, float x, float y) const {
+  const float innovation_variance = s.pp + measurement_variance;
+  const float kp = s.pp / innovation_variance;
+  const float kv = s.pv / innovation_variance;
+
+  const float ex = x - s.x;
+  const float ey = y - s.y;
+
+  s.x += kp * ex;
+  s.y += kp * ey;
+  s.vx += kv * ex;
+  s.vy += kv * ey;
+
+  s.vv -= kv * s.pv;
+  s.pv *= 1 - kp;
+  s.pp *= 1 - kp;
+}
+
+int32_t tracker::update(const cluster* clusters, int32_t count,
+    int64_t timestamp, track* out) {
+  NEO_ASSERT(count == 0 || clusters);
+  NEO_ASSERT(count <= NEO_MAX_CLUSTERS);
+  NEO_ASSERT(out);
+
+  const float dt = last_timestamp > 0 && timestamp > last_timestamp
+    ? static_cast<float>(timestamp - last_timestamp) / 1e6f : 0;
+  last_timestamp = timestamp;
+
+  candidates.clear();
+
+  for ( int32_t t = 0; t < NEO_MAX_TRACKS; ++t ) {
+    state& s = tracks[t];
+
+    if ( !s.used )
+      continue;
+
+    predict(s, dt);
+    s.assigned = false;
+
+    for ( int32_t c = 0; c < count; ++c ) {
+      const float distance = std::hypot(clusters[c].centroid_x - s.x,
+          clusters[c].centroid_y - s.y);
+
+      if ( distance <= config.max_distance )
+        candidates.push_back({distance, t, c});
+    }
+  }
+
+  // Global nearest neighbor: closest pairs first
+  std::sort(candidates.begin(), candidates.end(),
+      [](const candidate& a, const candidate& b) { return a.distance < b.distance; });
+
+  std::fill_n(taken.begin(), count, 0);
+
+  for ( const candidate& pair : candidates ) {
+    state& s = tracks[pair.track];
+
+    if ( s.assigned || taken[pair.cluster] )
+      continue;
+
+    correct(s, clusters[pair.cluster].centroid_x, clusters[pair.cluster].centroid_y);
+    s.assigned = true;
+    taken[pair.cluster] = 1;
+  }
+
+  for ( state& s : tracks ) {
+    if ( !s.used )
+      continue;
+
+    ++s.age;
+
+    if ( s.assigned ) {
+      s.misses = 0;
+      s.hits = std::min(s.hits + 1, confirm_hits);
+      s.confirmed = s.confirmed || s.hits >= confirm_hits;
+    } else if ( ++s.misses > config.max_misses ) {
+      s.used = false;
+    } else {
+      s.hits = 0;
+    }
+  }
+
+  // Whatever no track claimed may be a new object; ignored once full
+  auto slot = tracks.begin();
+
+  for ( int32_t c = 0; c < count; ++c ) {
+    if ( taken[c] )
+      continue;
+
+    slot = std::find_if(slot, tracks.end(), [](const state& s) { return !s.used; });
+
+    if ( slot == tracks.end() )
+      break;
+
+    *slot = state{true, next_id++, clusters[c].centroid_x, clusters[c].centroid_y,
+      0, 0, measurement_variance, 0, initial_speed * initial_speed,
+      /*age=*/1, /*hits=*/1, /*misses=*/0, confirm_hits <= 1, /*assigned=*/true};
+  }
+
+  int32_t written = 0;
+
+  for ( const state& s : tracks ) {
+    if ( s.used && s.confirmed )
+      out[written++] = {s.id, s.x, s.y, s.vx, s.vy, s.age, s.misses};
+  }
+
+  return written;
+}
+
+}  // namespace tracking
+}  // namespace neo
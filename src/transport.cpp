@@ -0,0 +1,245 @@
+#include "transport.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace neo {
+namespace transport {
+
+// Serial ports
+
+class tty_transport final : public transport {
+ public:
+  explicit tty_transport(serial::device_s serial) : serial(serial) {}
+  ~tty_transport() { serial::device_destruct(serial); }
+
+  void read(void* to, int32_t len) override {
+    try {
+      serial::device_read(serial, to, len);
+    } catch (const serial::interrupted& e) {
+      throw interrupted{e.what()};
+    } catch (const serial::timed_out& e) {
+      throw timed_out{e.what()};
+    }
+  }
+
+  void write(const void* from, int32_t len) override {
+    serial::device_write(serial, from, len);
+  }
+
+  void flush() override { serial::device_flush(serial); }
+  void interrupt() override { serial::device_interrupt(serial); }
+  void set_deadline(deadline until) override {
+    serial::device_set_deadline(serial, until);
+  }
+
+  int32_t readiness_fd() override { return serial::device_fd(serial); }
+  bool interactive() override { return true; }
+
+ private:
+  serial::device_s serial;
+};
+
+// Replays
+
+class file_transport final : public transport {
+ public:
+  explicit file_transport(FILE* file) : file(file), interrupted_flag{false} {
+    // Reads are a handful of bytes each; let stdio fetch large blocks
+    setvbuf(file, nullptr, _IOFBF, 1 << 16);
+  }
+
+  ~file_transport() { fclose(file); }
+
+  void read(void* to, int32_t len) override {
+    if ( interrupted_flag.load(std::memory_order_relaxed) )
+      throw interrupted{"reading from capture file interrupted."};
+
+    if ( fread(to, 1, static_cast<size_t>(len), file) != static_cast<size_t>(len) )
+      throw error{feof(file) ? "reached the end of the capture file."
+        : "reading from capture file failed."};
+  }
+
+  // Nobody listens on a replay
+  void write(const void*, int32_t) override {}
+
+  // A replay has no stale bytes: the next session continues where this ended
+  void flush() override { interrupted_flag = false; }
+  void interrupt() override { interrupted_flag = true; }
+  // Recorded bytes never keep a read waiting
+  void set_deadline(deadline) override {}
+
+  int32_t readiness_fd() override { return -1; }
+  bool interactive() override { return false; }
+
+ private:
+  FILE* file;
+  std::atomic<bool> interrupted_flag;
+};
+
+class memory_transport final : public transport {
+ public:
+  explicit memory_transport(std::vector<uint8_t> bytes)
+      : bytes(std::move(bytes)), position(0), interrupted_flag{false} {}
+
+  void read(void* to, int32_t len) override {
+    if ( interrupted_flag.load(std::memory_order_relaxed) )
+      throw interrupted{"reading from memory interrupted."};
+
+    auto out = static_cast<uint8_t*>(to);
+
+    while ( len > 0 ) {
+      const size_t chunk = std::min(static_cast<size_t>(len), bytes.size() - position);
+      memcpy(out, bytes.data() + position, chunk);
+
+      out += chunk;
+      len -= static_cast<int32_t>(chunk);
+      position = (position + chunk) % bytes.size();
+    }
+  }
+
+  void write(const void*, int32_t) override {}
+
+  void flush() override { interrupted_flag = false; }
+  void interrupt() override { interrupted_flag = true; }
+  void set_deadline(deadline) override {}
+
+  int32_t readiness_fd() override { return -1; }
+  bool interactive() override { return false; }
+
+ private:
+  std::vector<uint8_t> bytes;
+  size_t position;
+  std::atomic<bool> interrupted_flag;
+};
+
+transport_s memory_construct(std::vector<uint8_t> bytes) {
+  if ( bytes.empty() )
+    throw error{"cannot replay an empty capture."};
+
+  return new memory_transport{std::move(bytes)};
+}
+
+static FILE* open_capture(const char* path) {
+  FILE* file = fopen(path, "rb");
+
+  if ( !file )
+    throw error{"opening capture file failed."};
+
+  return file;
+}
+
+static transport_s file_construct(const char* path) {
+  return new file_transport{open_capture(path)};
+}
+
+static transport_s memory_construct_from_file(const char* path) {
+  FILE* file = open_capture(path);
+
+  std::vector<uint8_t> bytes;
+  uint8_t chunk[1 << 16];
+  size_t read;
+
+  while ( (read = fread(chunk, 1, sizeof(chunk), file)) > 0 )
+    bytes.insert(bytes.end(), chunk, chunk + read);
+
+  const bool failed = ferror(file) != 0;
+  fclose(file);
+
+  if ( failed )
+    throw error{"reading capture file failed."};
+
+  return memory_construct(std::move(bytes));
+}
+
+// Selection by port string
+
+static bool has_scheme(const char* port, const char* scheme, const char** rest) {
+  const size_t len = strlen(scheme);
+
+  if ( strncmp(port, scheme, len) != 0 )
+    return false;
+
+  *rest = port + len;
+  return true;
+}
+
+transport_s transport_construct(const char* port, int32_t baudrate,
+    const serial::config& cfg, interrupter_s interrupter) {
+  NEO_ASSERT(port);
+
+  const char* rest = nullptr;
+
+  if ( has_scheme(port, "file:", &rest) )
+    return file_construct(rest);
+
+  if ( has_scheme(port, "mem:", &rest) )
+    return memory_construct_from_file(rest);
+
+  if ( has_scheme(port, "unix:", &rest) )
+    return unix_socket_construct(rest);
+
+  if ( has_scheme(port, "tcp://", &rest) )
+    return tcp_socket_construct(rest, interrupter);
+
+  return new tty_transport{serial::device_construct(port, baudrate, cfg)};
+}
+
+void transport_destruct(transport_s transport) {
+  NEO_ASSERT(transport);
+
+  delete transport;
+}
+
+void transport_read(transport_s transport, void* to, int32_t len) {
+  NEO_ASSERT(transport);
+  NEO_ASSERT(to);
+  NEO_ASSERT(len >= 0);
+
+  transport->read(to, len);
+}
+
+void transport_write(transport_s transport, const void* from, int32_t len) {
+  NEO_ASSERT(transport);
+  NEO_ASSERT(from);
+  NEO_ASSERT(len >= 0);
+
+  transport->write(from, len);
+}
+
+void transport_flush(transport_s transport) {
+  NEO_ASSERT(transport);
+
+  transport->flush();
+}
+
+void transport_interrupt(transport_s transport) {
+  NEO_ASSERT(transport);
+
+  transport->interrupt();
+}
+
+void transport_set_deadline(transport_s transport, deadline until) {
+  NEO_ASSERT(transport);
+
+  transport->set_deadline(until);
+}
+
+int32_t transport_readiness_fd(transport_s transport) {
+  NEO_ASSERT(transport);
+
+  return transport->readiness_fd();
+}
+
+bool transport_interactive(transport_s transport) {
+  NEO_ASSERT(transport);
+
+  return transport->interactive();
+}
+
+}  // namespace transport
+}  // namespace neo
@@ -0,0 +1,50 @@
+#include "archive.hpp"
+
+#include <fcntl.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace neo {
+namespace archive {
+
+mapping map_file(const char* path) {
+  NEO_ASSERT(path);
+
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+  if ( fd == -1 )
+    throw error{"opening scan archive failed."};
+
+  struct stat info;
+
+  if ( fstat(fd, &info) == -1 ) {
+    close(fd);
+    throw error{"opening scan archive failed."};
+  }
+
+  const size_t size = static_cast<size_t>(info.st_size);
+
+  // Nothing to map; the reader rejects it as too short
+  if ( size == 0 ) {
+    close(fd);
+    return {nullptr, 0};
+  }
+
+  void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if ( base == MAP_FAILED )
+    throw error{"mapping scan archive failed."};
+
+  return {static_cast<const uint8_t*>(base), size};
+}
+
+void unmap_file(const mapping& m) {
+  if ( m.size > 0 )
+    munmap(const_cast<uint8_t*>(m.data), m.size);
+}
+
+}  // namespace archive
+}  // namespace neo
@@ -0,0 +1,99 @@
+#include "event.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
+namespace neo {
+namespace event {
+
+struct flag {
+  int32_t read_end;
+  int32_t write_end;  // the same eventfd on Linux
+  bool is_set;
+};
+
+flag_s flag_construct() {
+#if defined(__linux__)
+  const int32_t fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+  if ( fd == -1 ) {
+    throw error{"creating readiness descriptor failed."};
+  }
+
+  return new flag{fd, fd, false};
+#else
+  int32_t ends[2];
+
+  if ( pipe(ends) == -1 ) {
+    throw error{"creating readiness descriptor failed."};
+  }
+
+  for ( const int32_t end : ends ) {
+    if ( fcntl(end, F_SETFL, O_NONBLOCK) == -1 || fcntl(end, F_SETFD, FD_CLOEXEC) == -1 ) {
+      close(ends[0]);
+      close(ends[1]);
+      throw error{"creating readiness descriptor failed."};
+    }
+  }
+
+  return new flag{ends[0], ends[1], false};
+#endif
+}
+
+void flag_destruct(flag_s flag) {
+  NEO_ASSERT(flag);
+
+  close(flag->read_end);
+
+  if ( flag->write_end != flag->read_end )
+    close(flag->write_end);
+
+  delete flag;
+}
+
+void flag_set(flag_s flag) {
+  NEO_ASSERT(flag);
+
+  if ( flag->is_set )
+    return;
+
+  // Eight bytes is what an eventfd takes, and fits any pipe
+  const uint64_t one = 1;
+  ssize_t written;
+
+  do {
+    written = write(flag->write_end, &one, sizeof(one));
+  } while ( written == -1 && errno == EINTR );
+
+  flag->is_set = true;
+}
+
+void flag_clear(flag_s flag) {
+  NEO_ASSERT(flag);
+
+  if ( !flag->is_set )
+    return;
+
+  uint64_t drained;
+  ssize_t got;
+
+  do {
+    got = read(flag->read_end, &drained, sizeof(drained));
+  } while ( got == -1 && errno == EINTR );
+
+  flag->is_set = false;
+}
+
+int32_t flag_fd(flag_s flag) {
+  NEO_ASSERT(flag);
+
+  return flag->read_end;
+}
+
+}  // namespace event
+}  // namespace neo
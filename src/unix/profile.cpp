@@ -0,0 +1,88 @@
+#include "profile.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace neo {
+namespace profile {
+
+struct update_lock {
+  int fd;
+};
+
+update_lock_s lock_for_update(const char* path) {
+  NEO_ASSERT(path);
+
+  const std::string name = std::string{path} + ".lock";
+  const int fd = open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+  if ( fd == -1 )
+    return nullptr;
+
+  // Held only for the few file operations of one update
+  while ( flock(fd, LOCK_EX) == -1 ) {
+    if ( errno != EINTR ) {
+      close(fd);
+      return nullptr;
+    }
+  }
+
+  return new update_lock{fd};
+}
+
+void unlock_for_update(update_lock_s lock) {
+  NEO_ASSERT(lock);
+
+  close(lock->fd);  // releases the flock
+  delete lock;
+}
+
+bool replace(const char* path, const std::string& contents) {
+  NEO_ASSERT(path);
+
+  std::string name = std::string{path} + ".XXXXXX";
+  std::vector<char> templ{name.begin(), name.end()};
+  templ.push_back('\0');
+
+  const int fd = mkstemp(templ.data());
+
+  if ( fd == -1 )
+    return false;
+
+  name = templ.data();
+
+  // mkstemp creates 0600; keep the cache as readable as a plain file
+  bool written = fchmod(fd, 0644) == 0;
+
+  for ( size_t done = 0; written && done < contents.size(); ) {
+    const ssize_t n = write(fd, contents.data() + done, contents.size() - done);
+
+    if ( n == -1 && errno == EINTR )
+      continue;
+
+    written = n > 0;
+    done += written ? static_cast<size_t>(n) : 0;
+  }
+
+  written = written && fsync(fd) == 0;
+
+  if ( close(fd) == -1 )
+    written = false;
+
+  if ( !written || rename(name.c_str(), path) == -1 ) {
+    unlink(name.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace profile
+}  // namespace neo
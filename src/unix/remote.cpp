@@ -0,0 +1,303 @@
+#include "remote.hpp"
+#include "neod.hpp"
+#include "codec.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <string.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+// macOS lacks the flag; SIGPIPE is the embedding application's business there
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace neo {
+namespace remote {
+
+struct connection {
+  int32_t fd;
+  int32_t wake[2];  // self-pipe for connection_interrupt
+
+  // received bytes not yet consumed; frames are parsed from here
+  std::vector<uint8_t> buffer;
+  size_t head;
+};
+
+constexpr size_t chunk_size = 64 * 1024;
+
+static void close_all(int32_t fd, const int32_t wake[2]) {
+  close(fd);
+  close(wake[0]);
+  close(wake[1]);
+}
+
+static int32_t connect_unix(const std::string& path) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if ( path.size() >= sizeof(address.sun_path) )
+    throw error{"neod socket path is too long."};
+
+  memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  const int32_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if ( fd == -1 )
+    throw error{"creating socket failed."};
+
+  if ( connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 ) {
+    close(fd);
+    throw error{"connecting to neod failed; is the daemon running?"};
+  }
+
+  return fd;
+}
+
+static int32_t connect_tcp(const std::string& host, const std::string& port) {
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* addresses = nullptr;
+
+  if ( getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0 )
+    throw error{"resolving neod host failed."};
+
+  int32_t fd = -1;
+
+  for ( addrinfo* it = addresses; it && fd == -1; it = it->ai_next ) {
+    fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+
+    if ( fd != -1 && connect(fd, it->ai_addr, it->ai_addrlen) == -1 ) {
+      close(fd);
+      fd = -1;
+    }
+  }
+
+  freeaddrinfo(addresses);
+
+  if ( fd == -1 )
+    throw error{"connecting to neod failed; is the daemon running?"};
+
+  // Frames are small and latency matters more than packet count
+  const int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  return fd;
+}
+
+static void send_all(connection_s connection, const uint8_t* data, size_t len) {
+  while ( len > 0 ) {
+    const ssize_t sent = send(connection->fd, data, len, MSG_NOSIGNAL);
+
+    if ( sent == -1 ) {
+      if ( errno == EINTR )
+        continue;
+
+      throw error{"sending to neod failed."};
+    }
+
+    data += sent;
+    len -= static_cast<size_t>(sent);
+  }
+}
+
+// Blocks until more bytes arrived; throws on wakeups and a closed connection
+static void receive(connection_s connection) {
+  fd_set readfds;
+  FD_ZERO(&readfds);
+  FD_SET(connection->fd, &readfds);
+  FD_SET(connection->wake[0], &readfds);
+
+  const int32_t nfds = std::max(connection->fd, connection->wake[0]) + 1;
+
+  if ( select(nfds, &readfds, nullptr, nullptr, nullptr) == -1 ) {
+    if ( errno == EINTR )
+      return;
+
+    throw error{"blocking on data from neod failed."};
+  }
+
+  // Leave the pipe filled: the interrupt is sticky
+  if ( FD_ISSET(connection->wake[0], &readfds) )
+    throw interrupted{"reading from neod interrupted."};
+
+  if ( !FD_ISSET(connection->fd, &readfds) )
+    return;
+
+  // Compact once the consumed prefix dominates
+  if ( connection->head > 0 && connection->head * 2 >= connection->buffer.size() ) {
+    connection->buffer.erase(connection->buffer.begin(),
+        connection->buffer.begin() + connection->head);
+    connection->head = 0;
+  }
+
+  const size_t size = connection->buffer.size();
+  connection->buffer.resize(size + chunk_size);
+
+  const ssize_t received = recv(connection->fd, connection->buffer.data() + size,
+      chunk_size, 0);
+
+  connection->buffer.resize(size + std::max<ssize_t>(received, 0));
+
+  if ( received == 0 )
+    throw error{"neod closed the connection."};
+
+  if ( received == -1 && errno != EINTR && errno != EAGAIN )
+    throw error{"reading from neod failed."};
+}
+
+// Returns the payload of the next frame, valid until the next call
+static const uint8_t* read_frame(connection_s connection, neod::frame& type,
+    uint32_t& length) {
+  for ( ;; ) {
+    const size_t available = connection->buffer.size() - connection->head;
+    const uint8_t* at = connection->buffer.data() + connection->head;
+
+    if ( available >= neod::header_size ) {
+      length = neod::get_u32(at);
+
+      if ( length > neod::max_payload )
+        throw error{"malformed frame from neod."};
+
+      if ( available >= neod::header_size + length ) {
+        type = static_cast<neod::frame>(at[4]);
+        connection->head += neod::header_size + length;
+        return at + neod::header_size;
+      }
+    }
+
+    receive(connection);
+  }
+}
+
+[[noreturn]] static void throw_daemon_error(const uint8_t* payload, uint32_t length) {
+  throw error{std::string{reinterpret_cast<const char*>(payload), length}};
+}
+
+connection_s connection_construct(const endpoint& to, info& out) {
+  int32_t wake[2];
+
+  if ( pipe(wake) == -1 )
+    throw error{"creating wakeup pipe failed."};
+
+  for ( int32_t end : wake ) {
+    if ( fcntl(end, F_SETFL, O_NONBLOCK) == -1 ||
+         fcntl(end, F_SETFD, FD_CLOEXEC) == -1 ) {
+      close(wake[0]);
+      close(wake[1]);
+      throw error{"configuring wakeup pipe failed."};
+    }
+  }
+
+  int32_t fd = -1;
+
+  try {
+    fd = to.path.empty() ? connect_tcp(to.host, to.port) : connect_unix(to.path);
+  } catch (...) {
+    close(wake[0]);
+    close(wake[1]);
+    throw;
+  }
+
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+  auto connection = new neo::remote::connection{fd, {wake[0], wake[1]},
+    /*buffer=*/{}, /*head=*/0};
+
+  try {
+    std::vector<uint8_t> hello(neod::header_size + 1 + to.device.size());
+    neod::put_header(hello.data(), neod::frame::hello,
+        static_cast<uint32_t>(hello.size() - neod::header_size));
+    hello[neod::header_size] = neod::version;
+    std::copy(to.device.begin(), to.device.end(), hello.begin() + neod::header_size + 1);
+
+    send_all(connection, hello.data(), hello.size());
+
+    neod::frame type;
+    uint32_t length;
+    const uint8_t* payload = read_frame(connection, type, length);
+
+    if ( type == neod::frame::error )
+      throw_daemon_error(payload, length);
+
+    if ( type != neod::frame::welcome || length < 9 || payload[0] != neod::version )
+      throw error{"unexpected greeting from neod; version mismatch?"};
+
+    out.motor_speed = static_cast<int32_t>(neod::get_u32(payload + 1));
+    out.sector_size = static_cast<int32_t>(neod::get_u32(payload + 5));
+  } catch (...) {
+    connection_destruct(connection);
+    throw;
+  }
+
+  return connection;
+}
+
+void connection_destruct(connection_s connection) {
+  NEO_ASSERT(connection);
+
+  close_all(connection->fd, connection->wake);
+  delete connection;
+}
+
+void connection_subscribe(connection_s connection, bool sectors,
+    int32_t decimate) {
+  NEO_ASSERT(connection);
+  NEO_ASSERT(decimate >= 1 && decimate <= 65535);
+
+  uint8_t subscribe[neod::header_size + 3];
+  neod::put_header(subscribe, neod::frame::subscribe, 3);
+  subscribe[neod::header_size] = neod::full_scans | (sectors ? neod::sectors : 0);
+  neod::put_u16(subscribe + neod::header_size + 1, static_cast<uint16_t>(decimate));
+
+  send_all(connection, subscribe, sizeof(subscribe));
+}
+
+void connection_read(connection_s connection, neo_scan& out) {
+  NEO_ASSERT(connection);
+
+  for ( ;; ) {
+    neod::frame type;
+    uint32_t length;
+    const uint8_t* payload = read_frame(connection, type, length);
+
+    switch ( type ) {
+    case neod::frame::scan:
+      codec::decode(payload, static_cast<int32_t>(length), out);
+      return;
+    case neod::frame::error:
+      throw_daemon_error(payload, length);
+    default:
+      // newer daemons may send frames we do not know about
+      break;
+    }
+  }
+}
+
+void connection_interrupt(connection_s connection) {
+  NEO_ASSERT(connection);
+
+  const uint8_t wake = 1;
+
+  // A full pipe already holds a pending wakeup
+  if ( write(connection->wake[1], &wake, sizeof(wake)) == -1 && errno != EAGAIN ) {
+    NEO_ASSERT(false && "writing to wakeup pipe failed.");
+  }
+}
+
+}  // namespace remote
+}  // namespace neo
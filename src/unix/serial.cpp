@@ -1,6 +1,8 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include "serial.hpp"
+#include "termios2.hpp"
+#include "uring.hpp"
 
 #include <errno.h>
 #include <stdbool.h>
@@ -8,7 +10,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <chrono>
+
+#include <dirent.h>
 #include <fcntl.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
 #include <sys/select.h>
 #include <sys/types.h>
 #include <termios.h>
@@ -19,12 +27,25 @@ namespace serial {
 
 struct device {
   int32_t fd;
+  int32_t wake[2];  // self-pipe: device_interrupt writes, wait_readable polls
+  profile latency_profile;
+
+  uring::reader_s reader;  // nullptr: select() and read() into buffer
+
+  // bytes read ahead from fd; data[head, tail) is not handed out yet
+  uint8_t buffer[4096];
+  const uint8_t* data;  // buffer or a chunk owned by reader
+  int32_t head;
+  int32_t tail;
+
+  deadline until;  // reads waiting past it throw timed_out
 };
 
-static speed_t get_baud(int32_t baudrate) {
-  NEO_ASSERT(baudrate > 0);
+// With VMIN batching, give up waiting for a full batch after this long
+constexpr int32_t batch_timeout_millis = 20;
 
-  speed_t baud;
+static bool lookup_baud(int32_t baudrate, speed_t& baud) {
+  NEO_ASSERT(baudrate > 0);
 
   switch ( baudrate ) {
 #ifdef B0
@@ -213,22 +234,47 @@ static speed_t get_baud(int32_t baudrate) {
     break;
 #endif
   default:
-    throw error{"The input baudrate is not supported at this time."};
-    baud = -1;
+    return false;
   }
 
-  return baud;
+  return true;
 }
 
 static bool wait_readable(device_s serial) {
   NEO_ASSERT(serial);
 
-  // Setup a select call to block for serial data
+  // Setup a select call to block for serial data or a wakeup
   fd_set readfds;
   FD_ZERO(&readfds);
   FD_SET(serial->fd, &readfds);
+  FD_SET(serial->wake[0], &readfds);
+
+  const int32_t nfds = std::max(serial->fd, serial->wake[0]) + 1;
 
-  int32_t ret = select(serial->fd + 1, &readfds, nullptr, nullptr, nullptr);
+  // The tty only reports readable once VMIN bytes arrived; the timeout
+  // covers responses shorter than a batch and the tail of a stream
+  const bool batching = serial->latency_profile == profile::low_cpu;
+  int64_t timeout_micros = batching ? batch_timeout_millis * 1000 : -1;
+
+  // A deadline cuts the wait short; the next call after it passed throws
+  if ( serial->until != deadline::max() ) {
+    const int64_t left = std::chrono::duration_cast<std::chrono::microseconds>(
+        serial->until - std::chrono::steady_clock::now()).count();
+
+    if ( left <= 0 ) {
+      throw timed_out{"reading from serial device timed out."};
+    }
+
+    if ( timeout_micros < 0 || left < timeout_micros ) {
+      timeout_micros = left;
+    }
+  }
+
+  struct timeval timeout = {static_cast<time_t>(timeout_micros / 1000000),
+    static_cast<suseconds_t>(timeout_micros % 1000000)};
+
+  int32_t ret = select(nfds, &readfds, nullptr, nullptr,
+      timeout_micros >= 0 ? &timeout : nullptr);
 
   if ( ret == -1 ) {
     // Select was interrupted
@@ -239,32 +285,87 @@ static bool wait_readable(device_s serial) {
     // Otherwise there was some error
     throw error{"blocking on data to read failed."};
   } else if ( ret ) {
+    // Somebody asked us to stop reading; leave the pipe filled
+    if ( FD_ISSET(serial->wake[0], &readfds) ) {
+      throw interrupted{"reading from serial device interrupted."};
+    }
+
     // Data Available
     return true;
   } else {
-    return false;
+    // Timed out waiting for a batch; take whatever arrived so far
+    return batching;
   }
 
   return false;
 }
 
-device_s device_construct(const char* port, int32_t baudrate) {
+static void drain_wakeups(device_s serial) {
+  NEO_ASSERT(serial);
+
+  char discard[64];
+
+  while ( read(serial->wake[0], discard, sizeof(discard)) > 0 ) {
+    // keep draining until the non-blocking pipe reports EAGAIN
+  }
+}
+
+static void close_wakeups(int32_t wake[2]) {
+  if ( close(wake[0]) == -1 || close(wake[1]) == -1 ) {
+    NEO_ASSERT(false && "closing wakeup pipe failed.");
+  }
+}
+
+// Bytes arriving in ~10 ms at the given rate (8N1), as far as VMIN allows
+static cc_t batch_size(int32_t baudrate) {
+  const int32_t bytes = baudrate / 10 / 100;
+  return static_cast<cc_t>(std::min(std::max(bytes, 1), 255));
+}
+
+device_s device_construct(const char* port, int32_t baudrate,
+    const config& cfg) {
   NEO_ASSERT(port);
   NEO_ASSERT(baudrate > 0);
 
   int32_t fd = open(port, O_RDWR | O_NOCTTY | O_NONBLOCK);
 
+  // EBUSY: another process holds it with TIOCEXCL
+  if ( fd == -1 && errno == EBUSY ) {
+    throw error{"serial port is busy; another process has it open."};
+  }
+
   if ( fd == -1 ) {
     throw error{"openning serial port failed."};
   }
 
   if ( !isatty(fd) ) {
+    close(fd);
     throw error{"serial port is not a TTY."};
   }
 
+  // One owner per port: never talk over another process' device, e.g. neod
+  // or a discovery sending DX. flock keeps out other libneo users, TIOCEXCL
+  // any other unprivileged program opening the port after us.
+  if ( flock(fd, LOCK_EX | LOCK_NB) == -1 ) {
+    const bool busy = errno == EWOULDBLOCK;
+    close(fd);
+
+    if ( busy ) {
+      throw error{"serial port is busy; another process has it open."};
+    }
+
+    throw error{"locking serial port failed."};
+  }
+
+  if ( ioctl(fd, TIOCEXCL) == -1 ) {
+    close(fd);
+    throw error{"locking serial port failed."};
+  }
+
   struct termios options;
 
   if ( tcgetattr(fd, &options) == -1 ) {
+    close(fd);
     throw error{"querying terminal options failed."};
   }
 
@@ -286,14 +387,33 @@ device_s device_construct(const char* port, int32_t baudrate) {
   options.c_cflag &= ~(PARENB | CSTOPB | CSIZE);
   options.c_cflag |= (CLOCAL | CREAD | CS8);
 
+  // Reads never block (O_NONBLOCK) but select honors VMIN if VTIME is 0
+  options.c_cc[VTIME] = 0;
+  options.c_cc[VMIN] = cfg.latency_profile == profile::low_cpu
+    ? batch_size(baudrate) : 1;
+
   // setup baud rate
-  speed_t baud = get_baud(baudrate);
+  speed_t baud;
+  const bool standard_baud = lookup_baud(baudrate, baud);
+
+#ifdef __linux__
+  // Anything else goes through termios2 once the attributes are set
+  if ( !standard_baud ) {
+    baud = B38400;
+  }
+#else
+  if ( !standard_baud ) {
+    close(fd);
+    throw error{"The input baudrate is not supported at this time."};
+  }
+#endif
 
   cfsetispeed(&options, baud);
   cfsetospeed(&options, baud);
 
   // flush the port
   if ( tcflush(fd, TCIFLUSH) == -1 ) {
+    close(fd);
     throw error{"flushing the serial port failed."};
   }
 
@@ -306,7 +426,41 @@ device_s device_construct(const char* port, int32_t baudrate) {
     throw error{"setting terminal options failed."};
   }
 
-  auto out = new device{fd};
+#ifdef __linux__
+  if ( !standard_baud && !termios2::set_custom_baudrate(fd, baudrate) ) {
+    close(fd);
+    throw error{"The input baudrate is not supported at this time."};
+  }
+
+  // Best effort: drivers without a latency timer do not support the flag.
+  // Other profiles leave it as the driver or udev rules set it.
+  if ( cfg.latency_profile == profile::low_latency )
+    termios2::set_low_latency(fd, true);
+#endif
+
+  int32_t wake[2];
+
+  if ( pipe(wake) == -1 ) {
+    close(fd);
+    throw error{"creating wakeup pipe failed."};
+  }
+
+  for ( int32_t end : wake ) {
+    if ( fcntl(end, F_SETFL, O_NONBLOCK) == -1 ||
+         fcntl(end, F_SETFD, FD_CLOEXEC) == -1 ) {
+      close(fd);
+      close_wakeups(wake);
+      throw error{"configuring wakeup pipe failed."};
+    }
+  }
+
+  // Falls back to select() if the kernel or its policy lacks io_uring
+  const auto reader = cfg.io_uring ? uring::reader_construct(fd, wake[0]) : nullptr;
+
+  auto out = new device{fd, {wake[0], wake[1]}, cfg.latency_profile, reader,
+    /*buffer=*/{}, /*data=*/nullptr, /*head=*/0, /*tail=*/0,
+    /*until=*/deadline::max()};
+  out->data = out->buffer;
   return out;
 }
 
@@ -319,13 +473,51 @@ void device_destruct(device_s serial) {
     // do nothing
   }
 
+  if ( serial->reader ) {
+    uring::reader_destruct(serial->reader);
+  }
+
   if ( close(serial->fd) == -1 ) {
       NEO_ASSERT(false && "closing file descriptor during destruct failed.");
   }
 
+  close_wakeups(serial->wake);
+
   delete serial;
 }
 
+// Reads as much as the driver has ready into the read-ahead buffer
+static void fill_buffer(device_s serial) {
+  NEO_ASSERT(serial);
+  NEO_ASSERT(serial->head == serial->tail);
+
+  if ( serial->reader ) {
+    serial->tail = uring::reader_read(serial->reader, serial->until, &serial->data);
+    serial->head = 0;
+    return;
+  }
+
+  if ( !wait_readable(serial) ) {
+    return;
+  }
+
+  int ret = read(serial->fd, serial->buffer, sizeof(serial->buffer));
+
+  if ( ret == -1 ) {
+    if (errno == EAGAIN || errno == EINTR) {
+      return;
+    } else {
+      throw error{"reading from serial device failed."};
+    }
+  } else if ( 0 == ret ) {
+    throw error{"encountered EOF on serial device."};
+  }
+
+  serial->data = serial->buffer;
+  serial->head = 0;
+  serial->tail = ret;
+}
+
 void device_read(device_s serial, void* to, int32_t len) {
   NEO_ASSERT(serial);
   NEO_ASSERT(to);
@@ -335,21 +527,17 @@ void device_read(device_s serial, void* to, int32_t len) {
   int32_t bytes_read = 0;
 
   while ( bytes_read < len ) {
-    if ( wait_readable(serial) ) {
-      int ret = read(serial->fd, (char*)to + bytes_read, len - bytes_read);
-
-      if ( ret == -1 ) {
-        if (errno == EAGAIN || errno == EINTR) {
-          continue;
-        } else {
-          throw error{"reading from serial device failed."};
-        }
-      } else if ( 0 == ret ) {
-        throw error{"encountered EOF on serial device."};
-      } else {
-        bytes_read += ret;
-      }
+    if ( serial->head == serial->tail ) {
+      fill_buffer(serial);
+      continue;
     }
+
+    const int32_t chunk = std::min(len - bytes_read,
+        serial->tail - serial->head);
+
+    memcpy((char*)to + bytes_read, serial->data + serial->head, chunk);
+    serial->head += chunk;
+    bytes_read += chunk;
   }
 
   NEO_ASSERT(bytes_read == len &&
@@ -386,10 +574,71 @@ void device_write(device_s serial, const void* from, int32_t len) {
 void device_flush(device_s serial) {
   NEO_ASSERT(serial);
 
+  drain_wakeups(serial);
+
+  if ( serial->reader ) {
+    uring::reader_flush(serial->reader);
+  }
+
+  // read-ahead bytes are as stale as the ones still in the driver
+  serial->head = 0;
+  serial->tail = 0;
+
   if ( tcflush(serial->fd, TCIFLUSH) == -1 ) {
     throw error("flushing the serial port failed.");
   }
 }
 
+void device_interrupt(device_s serial) {
+  NEO_ASSERT(serial);
+
+  const char wakeup = 1;
+
+  // A full pipe already holds a pending wakeup; nothing else to do
+  if ( write(serial->wake[1], &wakeup, 1) == -1 && errno != EAGAIN ) {
+    throw error{"interrupting serial device failed."};
+  }
+}
+
+void device_set_deadline(device_s serial, deadline until) {
+  NEO_ASSERT(serial);
+
+  serial->until = until;
+}
+
+int32_t device_fd(device_s serial) {
+  NEO_ASSERT(serial);
+
+  return serial->fd;
+}
+
+std::vector<std::string> list_ports() {
+  // Linux USB serial and CDC ACM drivers, macOS callout devices
+  static const char* const prefixes[] = {"ttyUSB", "ttyACM", "cu.usbserial",
+    "cu.usbmodem", "cu.SLAB_USBtoUART"};
+
+  DIR* dir = opendir("/dev");
+
+  if ( !dir ) {
+    throw error{"listing serial ports failed."};
+  }
+
+  std::vector<std::string> out;
+
+  while ( const struct dirent* entry = readdir(dir) ) {
+    for ( const char* prefix : prefixes ) {
+      if ( strncmp(entry->d_name, prefix, strlen(prefix)) == 0 ) {
+        out.push_back(std::string{"/dev/"} + entry->d_name);
+        break;
+      }
+    }
+  }
+
+  closedir(dir);
+
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
 }  // namespace serial
 }  // namespace neo
@@ -0,0 +1,445 @@
+#include "shm.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// The ring is shared between processes: its atomics must not fall back to
+// process-local locks.
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+    "shared memory scan rings need lock-free atomics.");
+
+namespace neo {
+namespace shm {
+
+constexpr uint32_t magic = 0x4e454f52;  // "NEOR"
+constexpr uint32_t version = 6;
+
+struct header {
+  std::atomic<uint32_t> magic;  // stored last, once the ring is set up
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t slot_size;
+  std::atomic<uint64_t> published;  // number of the newest scan, 0 if none
+  std::atomic<uint32_t> wake;       // futex word: bumped on publish and close
+  std::atomic<uint32_t> closed;
+  int32_t owner;                    // publisher's pid, to tell stale rings
+};
+
+struct slot {
+  std::atomic<uint64_t> sequence;  // number << 1, odd while being written
+  frame scan;
+};
+
+constexpr size_t header_size = 64;  // keeps the slots cache line aligned
+static_assert(sizeof(header) <= header_size, "ring header outgrew its space.");
+
+static size_t ring_size(uint32_t slots) {
+  return header_size + static_cast<size_t>(slots) * sizeof(slot);
+}
+
+static slot* ring_slots(void* base) {
+  return reinterpret_cast<slot*>(static_cast<uint8_t*>(base) + header_size);
+}
+
+// Futex helpers; elsewhere readers fall back to polling
+
+static void wake_all(std::atomic<uint32_t>& word) {
+  word.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX,
+      nullptr, nullptr, 0);
+#endif
+}
+
+static void wait_changed(const std::atomic<uint32_t>& word, uint32_t seen,
+    std::chrono::milliseconds timeout) {
+#if defined(__linux__)
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec ts;
+  ts.tv_sec = static_cast<time_t>(seconds.count());
+  ts.tv_nsec = static_cast<long>((timeout - seconds).count() * 1000000);
+
+  // Shared (not FUTEX_PRIVATE) since publisher and readers are processes
+  syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&word), FUTEX_WAIT, seen,
+      &ts, nullptr, 0);
+#else
+  (void)word;
+  (void)seen;
+  std::this_thread::sleep_for(std::min(timeout, std::chrono::milliseconds{1}));
+#endif
+}
+
+// Publisher
+
+struct publisher {
+  std::string name;
+  void* base;
+  size_t size;
+  header* head;
+  slot* slots;
+  uint64_t count;  // scans published so far
+};
+
+enum class existing { live, stale, gone };
+
+// Judges the segment already at `name` and notes which one it was. A ring
+// never finishing its setup, closed, of another version or whose owner no
+// longer runs is stale.
+static existing inspect(const char* name, ino_t& inode) {
+  for ( int32_t attempt = 0; ; ++attempt ) {
+    const int fd = shm_open(name, O_RDONLY, 0);
+
+    // EACCES and the like: someone else's, leave it alone
+    if ( fd == -1 )
+      return errno == ENOENT ? existing::gone : existing::live;
+
+    struct stat info;
+
+    if ( fstat(fd, &info) == -1 ) {
+      close(fd);
+      return existing::live;
+    }
+
+    inode = info.st_ino;
+
+    void* base = MAP_FAILED;
+
+    if ( static_cast<size_t>(info.st_size) >= header_size )
+      base = mmap(nullptr, header_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    bool set_up = false;
+    existing out = existing::stale;
+
+    if ( base != MAP_FAILED ) {
+      const auto head = static_cast<const header*>(base);
+      set_up = head->magic.load(std::memory_order_acquire) == magic;
+
+      if ( set_up && head->version == version
+          && !head->closed.load(std::memory_order_acquire)
+          && (kill(head->owner, 0) == 0 || errno == EPERM) )
+        out = existing::live;
+
+      munmap(base, header_size);
+    }
+
+    // Give a publisher creating it right now ~100 ms to finish the setup
+    if ( set_up || attempt == 10 )
+      return out;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+}
+
+// Removes `name` only if it still is the stale segment inspected
+static void unlink_stale(const char* name, ino_t inode) {
+  const int fd = shm_open(name, O_RDONLY, 0);
+
+  if ( fd == -1 )
+    return;
+
+  struct stat info;
+  const bool same = fstat(fd, &info) == 0 && info.st_ino == inode;
+  close(fd);
+
+  if ( same )
+    shm_unlink(name);
+}
+
+publisher_s publisher_construct(const char* name, int32_t slots) {
+  NEO_ASSERT(name);
+  NEO_ASSERT(slots >= 2);
+
+  int fd = -1;
+
+  // A segment left behind by a crashed publisher is replaced, not reused:
+  // readers still mapping it would otherwise see the ring restart. One of
+  // a running publisher is never touched.
+  for ( int32_t attempt = 0; attempt < 3; ++attempt ) {
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+
+    if ( fd != -1 || errno != EEXIST )
+      break;
+
+    ino_t inode = 0;
+    const existing found = inspect(name, inode);
+
+    if ( found == existing::live )
+      throw error{"shared memory scan ring name is taken by a running publisher."};
+
+    if ( found == existing::stale )
+      unlink_stale(name, inode);
+  }
+
+  if ( fd == -1 )
+    throw error{"creating shared memory scan ring failed."};
+
+  const size_t size = ring_size(static_cast<uint32_t>(slots));
+
+  if ( ftruncate(fd, static_cast<off_t>(size)) == -1 ) {
+    close(fd);
+    shm_unlink(name);
+    throw error{"sizing shared memory scan ring failed."};
+  }
+
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if ( base == MAP_FAILED ) {
+    shm_unlink(name);
+    throw error{"mapping shared memory scan ring failed."};
+  }
+
+  // ftruncate zero-filled the segment: no scans, all slots empty
+  auto head = static_cast<header*>(base);
+  head->version = version;
+  head->slot_count = static_cast<uint32_t>(slots);
+  head->slot_size = sizeof(slot);
+  head->owner = static_cast<int32_t>(getpid());
+  head->magic.store(magic, std::memory_order_release);
+
+  return new publisher{name, base, size, head, ring_slots(base), /*count=*/0};
+}
+
+void publisher_destruct(publisher_s publisher) {
+  NEO_ASSERT(publisher);
+
+  publisher->head->closed.store(1, std::memory_order_release);
+  wake_all(publisher->head->wake);
+
+  munmap(publisher->base, publisher->size);
+  shm_unlink(publisher->name.c_str());
+
+  delete publisher;
+}
+
+void publisher_publish(publisher_s publisher, const sample* samples,
+    int32_t count, int32_t revolution, int32_t sector, int64_t timestamp) {
+  NEO_ASSERT(publisher);
+  NEO_ASSERT(count >= 0 && count <= NEO_MAX_SAMPLES);
+
+  const uint64_t number = ++publisher->count;
+  slot& to = publisher->slots[number % publisher->head->slot_count];
+
+  to.sequence.store((number << 1) | 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  to.scan.count = count;
+  to.scan.revolution = revolution;
+  to.scan.sector = sector;
+  to.scan.timestamp = timestamp;
+  std::copy_n(samples, count, to.scan.samples);
+
+  to.sequence.store(number << 1, std::memory_order_release);
+
+  publisher->head->published.store(number, std::memory_order_release);
+  wake_all(publisher->head->wake);
+}
+
+// Reader
+
+struct reader {
+  void* base;
+  size_t size;
+  const header* head;
+  const slot* slots;
+  uint64_t next;     // number of the next scan to hand out
+  uint64_t current;  // number of the last scan handed out, 0 if none
+  bool borrowed;
+  uint64_t dropped;
+};
+
+reader_s reader_construct(const char* name) {
+  NEO_ASSERT(name);
+
+  const int fd = shm_open(name, O_RDONLY, 0);
+
+  if ( fd == -1 )
+    throw error{"opening shared memory scan ring failed; is the publisher running?"};
+
+  struct stat info;
+
+  if ( fstat(fd, &info) == -1 || static_cast<size_t>(info.st_size) < header_size ) {
+    close(fd);
+    throw error{"shared memory scan ring is not initialized."};
+  }
+
+  const size_t size = static_cast<size_t>(info.st_size);
+  void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if ( base == MAP_FAILED )
+    throw error{"mapping shared memory scan ring failed."};
+
+  const auto head = static_cast<const header*>(base);
+
+  const char* problem = nullptr;
+
+  if ( head->magic.load(std::memory_order_acquire) != magic )
+    problem = "shared memory scan ring is not initialized.";
+  else if ( head->version != version || head->slot_size != sizeof(slot) )
+    problem = "shared memory scan ring was created by an incompatible version.";
+  else if ( head->slot_count < 2 || size < ring_size(head->slot_count) )
+    problem = "shared memory scan ring is truncated.";
+
+  if ( problem ) {
+    munmap(base, size);
+    throw error{problem};
+  }
+
+  const uint64_t newest = head->published.load(std::memory_order_acquire);
+
+  return new reader{base, size, head, ring_slots(base),
+    /*next=*/std::max<uint64_t>(newest, 1), /*current=*/0, /*borrowed=*/false,
+    /*dropped=*/0};
+}
+
+void reader_destruct(reader_s reader) {
+  NEO_ASSERT(reader);
+
+  munmap(reader->base, reader->size);
+  delete reader;
+}
+
+const frame* reader_acquire(reader_s reader, int32_t timeout_ms) {
+  NEO_ASSERT(reader);
+  NEO_ASSERT(!reader->borrowed && "release the borrowed scan first.");
+
+  const header& head = *reader->head;
+  const uint64_t slots = head.slot_count;
+
+  using clock = std::chrono::steady_clock;
+  const auto deadline = clock::now() + std::chrono::milliseconds{timeout_ms};
+
+  for ( ;; ) {
+    const uint64_t newest = head.published.load(std::memory_order_acquire);
+
+    if ( newest >= reader->next ) {
+      // The slot after the newest one may be mid-write: skip what is older
+      const uint64_t oldest = newest + 2 > slots ? newest + 2 - slots : 1;
+
+      if ( reader->next < oldest ) {
+        reader->dropped += oldest - reader->next;
+        reader->next = oldest;
+      }
+
+      const uint64_t number = reader->next++;
+      const slot& from = reader->slots[number % slots];
+
+      if ( from.sequence.load(std::memory_order_acquire) == number << 1 ) {
+        reader->current = number;
+        reader->borrowed = true;
+        return &from.scan;
+      }
+
+      // Lapped between reading newest and the slot; try the next one
+      ++reader->dropped;
+      continue;
+    }
+
+    if ( head.closed.load(std::memory_order_acquire) )
+      throw error{"scan publisher closed the shared memory ring."};
+
+    if ( timeout_ms == 0 )
+      return nullptr;
+
+    const uint32_t seen = head.wake.load(std::memory_order_acquire);
+
+    // Re-check after sampling the futex word so a publish in between is
+    // either seen here or makes the wait return immediately
+    if ( head.published.load(std::memory_order_acquire) >= reader->next
+        || head.closed.load(std::memory_order_acquire) )
+      continue;
+
+    auto remaining = std::chrono::milliseconds{1000};
+
+    if ( timeout_ms > 0 ) {
+      const auto now = clock::now();
+
+      if ( now >= deadline )
+        return nullptr;
+
+      remaining = std::min(remaining,
+          std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now)
+          + std::chrono::milliseconds{1});
+    }
+
+    wait_changed(head.wake, seen, remaining);
+  }
+}
+
+bool reader_release(reader_s reader) {
+  NEO_ASSERT(reader);
+  NEO_ASSERT(reader->borrowed && "no scan borrowed.");
+
+  const uint64_t number = reader->current;
+  reader->borrowed = false;
+
+  // Seqlock validation: the reads of the scan happen before this load
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  const slot& from = reader->slots[number % reader->head->slot_count];
+  return from.sequence.load(std::memory_order_relaxed) == number << 1;
+}
+
+bool reader_read(reader_s reader, int32_t timeout_ms, neo_scan& out) {
+  for ( ;; ) {
+    const frame* from = reader_acquire(reader, timeout_ms);
+
+    if ( !from )
+      return false;
+
+    // A torn count must not overrun the copy; release tells it was torn
+    const int32_t count = std::min(std::max(from->count, 0), NEO_MAX_SAMPLES);
+
+    out.count = count;
+    out.revolution = from->revolution;
+    out.sector = from->sector;
+    out.timestamp = from->timestamp;
+    out.grid.clear();  // rings carry samples only
+    out.clusters.clear();
+    out.tracks.clear();
+    std::copy_n(from->samples, count, out.samples);
+
+    if ( reader_release(reader) )
+      return true;
+
+    // Lost like a scan skipped for lagging behind
+    ++reader->dropped;
+  }
+}
+
+uint64_t reader_sequence(reader_s reader) {
+  NEO_ASSERT(reader);
+
+  return reader->current;
+}
+
+uint64_t reader_dropped(reader_s reader) {
+  NEO_ASSERT(reader);
+
+  return reader->dropped;
+}
+
+}  // namespace shm
+}  // namespace neo
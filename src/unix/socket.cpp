@@ -0,0 +1,391 @@
+#include "transport.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <string.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace neo {
+namespace transport {
+
+// Device bytes over a connected stream socket
+class socket_transport final : public transport {
+ public:
+  socket_transport(int32_t fd, const int32_t wake[2])
+      : fd(fd), wake{wake[0], wake[1]}, head(0), tail(0),
+        until(deadline::max()) {}
+
+  ~socket_transport() {
+    close(fd);
+    close(wake[0]);
+    close(wake[1]);
+  }
+
+  void read(void* to, int32_t len) override {
+    auto out = static_cast<uint8_t*>(to);
+
+    while ( len > 0 ) {
+      if ( head == tail ) {
+        fill();
+        continue;
+      }
+
+      const int32_t chunk = std::min(len, tail - head);
+      memcpy(out, buffer + head, chunk);
+
+      head += chunk;
+      out += chunk;
+      len -= chunk;
+    }
+  }
+
+  void write(const void* from, int32_t len) override {
+    auto data = static_cast<const uint8_t*>(from);
+
+    while ( len > 0 ) {
+      const ssize_t sent = send(fd, data, static_cast<size_t>(len), MSG_NOSIGNAL);
+
+      if ( sent == -1 ) {
+        if ( errno == EINTR || errno == EAGAIN )
+          continue;
+
+        throw error{"writing to socket failed."};
+      }
+
+      data += sent;
+      len -= static_cast<int32_t>(sent);
+    }
+  }
+
+  void flush() override {
+    char discard[4096];
+
+    while ( ::read(wake[0], discard, sizeof(discard)) > 0 ) {
+    }
+
+    // Like tcflush: whatever arrived so far is stale
+    while ( recv(fd, discard, sizeof(discard), MSG_DONTWAIT) > 0 ) {
+    }
+
+    head = 0;
+    tail = 0;
+  }
+
+  void interrupt() override {
+    const char wakeup = 1;
+
+    // A full pipe already holds a pending wakeup
+    if ( ::write(wake[1], &wakeup, 1) == -1 && errno != EAGAIN )
+      throw error{"interrupting socket failed."};
+  }
+
+  void set_deadline(deadline until) override { this->until = until; }
+
+  int32_t readiness_fd() override { return fd; }
+  bool interactive() override { return true; }
+
+ private:
+  void fill() {
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(fd, &readfds);
+    FD_SET(wake[0], &readfds);
+
+    timeval timeout;
+    timeval* bound = nullptr;
+
+    if ( until != deadline::max() ) {
+      const int64_t left = std::chrono::duration_cast<std::chrono::microseconds>(
+          until - std::chrono::steady_clock::now()).count();
+
+      if ( left <= 0 )
+        throw timed_out{"reading from socket timed out."};
+
+      timeout.tv_sec = static_cast<time_t>(left / 1000000);
+      timeout.tv_usec = static_cast<suseconds_t>(left % 1000000);
+      bound = &timeout;
+    }
+
+    const int32_t ready = select(std::max(fd, wake[0]) + 1, &readfds, nullptr,
+        nullptr, bound);
+
+    if ( ready == -1 ) {
+      if ( errno == EINTR )
+        return;
+
+      throw error{"blocking on data to read failed."};
+    }
+
+    // Out of time; the next call throws
+    if ( ready == 0 )
+      return;
+
+    // Leave the pipe filled: the interrupt is sticky
+    if ( FD_ISSET(wake[0], &readfds) )
+      throw interrupted{"reading from socket interrupted."};
+
+    const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+
+    if ( received == 0 )
+      throw error{"the other end closed the socket."};
+
+    if ( received == -1 ) {
+      if ( errno == EINTR || errno == EAGAIN )
+        return;
+
+      throw error{"reading from socket failed."};
+    }
+
+    head = 0;
+    tail = static_cast<int32_t>(received);
+  }
+
+  int32_t fd;
+  int32_t wake[2];  // self-pipe for interrupt
+
+  // bytes read ahead; buffer[head, tail) is not handed out yet. Sized for
+  // many scan packets per recv when a network bridge delivers bursts.
+  uint8_t buffer[64 * 1024];
+  int32_t head;
+  int32_t tail;
+
+  deadline until;  // fill throws timed_out once it passed
+};
+
+// Self-pipe both ends of which never block
+static bool open_wake_pipe(int32_t wake[2]) {
+  if ( pipe(wake) == -1 )
+    return false;
+
+  for ( int32_t end : {wake[0], wake[1]} ) {
+    if ( fcntl(end, F_SETFL, O_NONBLOCK) == -1 || fcntl(end, F_SETFD, FD_CLOEXEC) == -1 ) {
+      close(wake[0]);
+      close(wake[1]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static transport_s socket_construct(int32_t fd) {
+  int32_t wake[2];
+
+  if ( !open_wake_pipe(wake) ) {
+    close(fd);
+    throw error{"creating wakeup pipe failed."};
+  }
+
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+  return new socket_transport{fd, wake};
+}
+
+// Interrupting connects
+
+struct interrupter {
+  int32_t wake[2];
+};
+
+interrupter_s interrupter_construct() {
+  auto out = new interrupter;
+
+  if ( !open_wake_pipe(out->wake) ) {
+    delete out;
+    throw error{"creating wakeup pipe failed."};
+  }
+
+  return out;
+}
+
+void interrupter_destruct(interrupter_s interrupter) {
+  NEO_ASSERT(interrupter);
+
+  close(interrupter->wake[0]);
+  close(interrupter->wake[1]);
+  delete interrupter;
+}
+
+void interrupter_interrupt(interrupter_s interrupter) {
+  NEO_ASSERT(interrupter);
+
+  const char wakeup = 1;
+
+  if ( ::write(interrupter->wake[1], &wakeup, 1) == -1 && errno != EAGAIN )
+    throw error{"interrupting connect failed."};
+}
+
+void interrupter_reset(interrupter_s interrupter) {
+  NEO_ASSERT(interrupter);
+
+  char discard[64];
+
+  while ( ::read(interrupter->wake[0], discard, sizeof(discard)) > 0 ) {
+  }
+}
+
+transport_s unix_socket_construct(const char* path) {
+  NEO_ASSERT(path);
+
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if ( strlen(path) >= sizeof(address.sun_path) )
+    throw error{"socket path is too long."};
+
+  strcpy(address.sun_path, path);
+
+  const int32_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if ( fd == -1 )
+    throw error{"creating socket failed."};
+
+  if ( connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 ) {
+    close(fd);
+    throw error{"connecting to socket failed."};
+  }
+
+  return socket_construct(fd);
+}
+
+// A bridge on the local network accepts at once; without a bound a dead
+// one keeps connect busy for minutes of SYN retries
+constexpr int32_t connect_timeout_millis = 3000;
+
+// Connects without blocking, so the attempt ends at the deadline or once
+// the interrupter fires, then puts the socket back into blocking mode
+static bool connect_until(int32_t fd, const sockaddr* address, socklen_t length,
+    deadline until, interrupter_s interrupter) {
+  const int flags = fcntl(fd, F_GETFL);
+
+  if ( flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 )
+    return false;
+
+  if ( connect(fd, address, length) == -1 ) {
+    if ( errno != EINPROGRESS )
+      return false;
+
+    for ( ;; ) {
+      const int64_t left = std::chrono::duration_cast<std::chrono::milliseconds>(
+          until - std::chrono::steady_clock::now()).count();
+
+      if ( left <= 0 )
+        return false;
+
+      pollfd fds[2] = {{fd, POLLOUT, 0}, {interrupter ? interrupter->wake[0] : -1, POLLIN, 0}};
+
+      const int ready = poll(fds, 2, static_cast<int>(left));
+
+      if ( ready == -1 ) {
+        if ( errno == EINTR )
+          continue;
+
+        return false;
+      }
+
+      // Leave the pipe filled: the interrupt is sticky
+      if ( fds[1].revents & POLLIN )
+        throw interrupted{"connecting to serial server interrupted."};
+
+      if ( ready > 0 )
+        break;
+    }
+
+    int failure = 0;
+    socklen_t size = sizeof(failure);
+
+    if ( getsockopt(fd, SOL_SOCKET, SO_ERROR, &failure, &size) == -1 || failure != 0 )
+      return false;
+  }
+
+  return fcntl(fd, F_SETFL, flags) != -1;
+}
+
+transport_s tcp_socket_construct(const char* address, interrupter_s interrupter) {
+  NEO_ASSERT(address);
+
+  const std::string target{address};
+  const auto colon = target.rfind(':');
+
+  if ( colon == std::string::npos || colon == 0 || colon + 1 == target.size() )
+    throw error{"tcp:// port string needs host:port."};
+
+  std::string host = target.substr(0, colon);
+  const std::string port = target.substr(colon + 1);
+
+  // [::1]:4001
+  if ( host.size() > 2 && host.front() == '[' && host.back() == ']' )
+    host = host.substr(1, host.size() - 2);
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo* addresses = nullptr;
+
+  if ( getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0 )
+    throw error{"resolving serial server host failed."};
+
+  const auto until = std::chrono::steady_clock::now()
+    + std::chrono::milliseconds(connect_timeout_millis);
+
+  int32_t fd = -1;
+
+  for ( addrinfo* it = addresses; it && fd == -1; it = it->ai_next ) {
+    fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+
+    if ( fd == -1 )
+      continue;
+
+    // Set before connecting so the window scale is negotiated for it
+    const int receive_buffer = 1 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+
+    bool connected = false;
+
+    try {
+      connected = connect_until(fd, it->ai_addr, it->ai_addrlen, until, interrupter);
+    } catch (...) {
+      close(fd);
+      freeaddrinfo(addresses);
+      throw;
+    }
+
+    if ( !connected ) {
+      close(fd);
+      fd = -1;
+    }
+  }
+
+  freeaddrinfo(addresses);
+
+  if ( fd == -1 )
+    throw error{"connecting to serial server failed."};
+
+  // Commands are a few bytes each and wait for their response
+  const int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  return socket_construct(fd);
+}
+
+}  // namespace transport
+}  // namespace neo
@@ -0,0 +1,49 @@
+#ifdef __linux__
+
+#include "termios2.hpp"
+
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+
+namespace neo {
+namespace serial {
+namespace termios2 {
+
+bool set_custom_baudrate(int32_t fd, int32_t baudrate) {
+  struct ::termios2 options;
+
+  if ( ioctl(fd, TCGETS2, &options) == -1 ) {
+    return false;
+  }
+
+  options.c_cflag &= ~CBAUD;
+  options.c_cflag |= BOTHER;
+  options.c_ispeed = baudrate;
+  options.c_ospeed = baudrate;
+
+  return ioctl(fd, TCSETS2, &options) != -1;
+}
+
+bool set_low_latency(int32_t fd, bool enable) {
+  struct serial_struct info;
+
+  // Not every tty driver implements these, e.g. ptys and cdc_acm do not
+  if ( ioctl(fd, TIOCGSERIAL, &info) == -1 ) {
+    return false;
+  }
+
+  if ( enable ) {
+    info.flags |= ASYNC_LOW_LATENCY;
+  } else {
+    info.flags &= ~ASYNC_LOW_LATENCY;
+  }
+
+  return ioctl(fd, TIOCSSERIAL, &info) != -1;
+}
+
+}  // namespace termios2
+}  // namespace serial
+}  // namespace neo
+
+#endif  // __linux__
@@ -0,0 +1,82 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // pthread_setaffinity_np, pthread_setname_np
+#endif
+
+#include "thread.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+
+namespace neo {
+namespace thread {
+
+bool set_affinity(uint64_t cpu_mask) {
+#ifdef __linux__
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+
+  for ( int32_t cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu ) {
+    if ( cpu_mask & (uint64_t{1} << cpu) )
+      CPU_SET(cpu, &cpus);
+  }
+
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+  // Darwin only offers affinity hints, not pinning
+  (void)cpu_mask;
+  return false;
+#endif
+}
+
+bool set_realtime_priority(int32_t priority) {
+  const int32_t min = sched_get_priority_min(SCHED_FIFO);
+  const int32_t max = sched_get_priority_max(SCHED_FIFO);
+
+  if ( min == -1 || max == -1 )
+    return false;
+
+  sched_param param;
+  memset(&param, 0, sizeof(param));
+  param.sched_priority = std::min(std::max(priority, min), max);
+
+  // Fails with EPERM without CAP_SYS_NICE or an RLIMIT_RTPRIO allowance
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+bool set_name(const char* name) {
+  NEO_ASSERT(name);
+
+#if defined(__linux__)
+  // Linux limits names to 15 characters plus terminator
+  char truncated[16];
+  strncpy(truncated, name, sizeof(truncated) - 1);
+  truncated[sizeof(truncated) - 1] = '\0';
+
+  return pthread_setname_np(pthread_self(), truncated) == 0;
+#elif defined(__APPLE__)
+  return pthread_setname_np(name) == 0;
+#else
+  (void)name;
+  return false;
+#endif
+}
+
+bool lock_memory(const void* address, size_t length) {
+  NEO_ASSERT(address);
+
+  // mlock faults the pages in before pinning them; fails beyond RLIMIT_MEMLOCK
+  return mlock(address, length) == 0;
+}
+
+void unlock_memory(const void* address, size_t length) {
+  NEO_ASSERT(address);
+
+  munlock(address, length);
+}
+
+}  // namespace thread
+}  // namespace neo
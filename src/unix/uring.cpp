@@ -0,0 +1,717 @@
+#include "uring.hpp"
+#include "serial.hpp"
+#include "thread.hpp"
+
+#if defined(__linux__) && defined(NEO_HAVE_IO_URING)
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace neo {
+namespace serial {
+namespace uring {
+
+// Devices per process on the ring, reads each keeps posted, bytes per read.
+// The registered buffers are pinned: 16 * 3 * 1 KiB stays below the usual
+// 64 KiB memlock limit. A serial chunk is rarely more than a few hundred bytes.
+constexpr int32_t max_readers = 16;
+constexpr int32_t depth = 3;
+constexpr int32_t buffer_size = 1024;
+
+// The queue cannot fill up between two io_uring_enter calls: per reader a
+// chain, a wakeup and a round of cancels, plus the doorbell
+constexpr uint32_t ring_entries = 256;
+
+// user_data: reader slot, request kind and buffer
+enum : uint64_t { kind_read = 0, kind_poll = 1, kind_wake = 2, kind_cancel = 3,
+  kind_bell = 4 };
+
+static uint64_t tag(int32_t slot, uint64_t kind, int32_t buffer) {
+  return (static_cast<uint64_t>(slot) << 16) | (kind << 8)
+    | static_cast<uint64_t>(buffer);
+}
+
+enum class slot_state : uint8_t { free, posted, done, handed_out };
+
+struct shared;
+
+struct reader {
+  shared* ring;
+  int32_t slot;
+  int32_t fd;       // the serial port
+  int32_t wake_fd;  // read end of the device's wakeup pipe
+
+  slot_state buffers[depth];
+  int32_t results[depth];  // bytes or -errno of done buffers
+
+  // done buffers in byte order
+  int32_t done[depth];
+  int32_t done_head;
+  int32_t done_count;
+
+  int32_t handed_out;   // buffer the caller parses, -1 if none
+  int32_t chain_reads;  // reads of the posted chain not completed yet
+  int32_t cancels;      // cancel requests not completed yet
+  int32_t pending;      // reads, wakeups and cancels not completed yet
+  bool wake_armed;
+  bool interrupted;
+  bool cancelling;      // flush or destruct under way: post no new chain
+
+  // Signalled when one of this reader's requests completed
+  std::condition_variable ready;
+};
+
+// Requests belong to the thread that submitted them and are torn down when
+// it exits, while acquisition threads come and go with every start and stop.
+// So the ring has a thread of its own, the only one to enter the kernel: it
+// submits what readers queued and waits in the same io_uring_enter, harvests
+// the completions of every reader at once and posts a reader's next chain
+// right away. Readers ring the doorbell only when they queued requests while
+// it sleeps in the kernel.
+struct shared {
+  int32_t ring_fd;
+
+  // mmap'ed rings
+  void* sq_ptr;
+  size_t sq_size;
+  void* cq_ptr;
+  size_t cq_size;
+  io_uring_sqe* sqes;
+  size_t sqes_size;
+
+  uint32_t* sq_head;
+  uint32_t* sq_tail;
+  uint32_t* sq_mask;
+  uint32_t* sq_entries;
+  uint32_t* sq_array;
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t* cq_mask;
+  io_uring_cqe* cqes;
+
+  // The polls in front of reads post no completion unless they fail (5.17)
+  bool skip_polls;
+
+  int32_t bell;         // eventfd, read through the ring
+  uint64_t bell_value;  // where the doorbell read lands
+
+  std::mutex lock;  // everything below, the rings and the readers
+  uint32_t to_submit;
+  bool entered;     // the ring thread waits in io_uring_enter
+  bool bell_armed;
+  bool bell_rung;
+  bool stopping;
+  bool failed;
+
+  reader* readers[max_readers];
+  int32_t users;
+
+  std::thread thread;
+
+  // registered buffers, depth per reader slot
+  uint8_t buffers[max_readers * depth][buffer_size];
+};
+
+static std::mutex instance_lock;
+static shared* instance = nullptr;
+
+static int32_t sys_setup(uint32_t entries, io_uring_params* params) {
+  return static_cast<int32_t>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int32_t sys_enter(int32_t fd, uint32_t to_submit, uint32_t min_complete,
+    uint32_t flags) {
+  return static_cast<int32_t>(syscall(__NR_io_uring_enter, fd, to_submit,
+        min_complete, flags, nullptr, 0));
+}
+
+static int32_t sys_register(int32_t fd, uint32_t opcode, const void* arg,
+    uint32_t nr_args) {
+  return static_cast<int32_t>(syscall(__NR_io_uring_register, fd, opcode,
+        arg, nr_args));
+}
+
+static io_uring_sqe* next_sqe(shared& ring) {
+  const uint32_t tail = *ring.sq_tail;
+
+  if ( tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE) >= *ring.sq_entries ) {
+    throw error{"serial device read queue is full."};
+  }
+
+  const uint32_t index = tail & *ring.sq_mask;
+
+  io_uring_sqe* sqe = &ring.sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+
+  ring.sq_array[index] = index;
+  __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ++ring.to_submit;
+
+  return sqe;
+}
+
+// The port is O_NONBLOCK: before 5.19 a read on an empty tty completes at
+// once with -EAGAIN instead of waiting, so every read waits behind a poll
+// for input. Two reads on the same tty running at once could complete out
+// of byte order: the free buffers go into a single hard-linked chain of
+// poll and read pairs, which the kernel runs one after the other, whatever
+// each one returns. A new chain is only posted once the last one finished.
+static void post_chain(shared& ring, reader& r) {
+  if ( r.chain_reads > 0 || r.interrupted || r.cancelling )
+    return;
+
+  int32_t last = -1;
+
+  for ( int32_t n = 0; n < depth; ++n ) {
+    if ( r.buffers[n] == slot_state::free )
+      last = n;
+  }
+
+  for ( int32_t n = 0; n <= last; ++n ) {
+    if ( r.buffers[n] != slot_state::free )
+      continue;
+
+    io_uring_sqe* poll = next_sqe(ring);
+    poll->opcode = IORING_OP_POLL_ADD;
+    poll->fd = r.fd;
+    poll->poll_events = POLLIN;
+    poll->flags = IOSQE_IO_HARDLINK;
+    poll->user_data = tag(r.slot, kind_poll, n);
+
+#ifdef IOSQE_CQE_SKIP_SUCCESS
+    if ( ring.skip_polls )
+      poll->flags |= IOSQE_CQE_SKIP_SUCCESS;
+#endif
+
+    const int32_t index = r.slot * depth + n;
+
+    io_uring_sqe* sqe = next_sqe(ring);
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = r.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(ring.buffers[index]);
+    sqe->len = buffer_size;
+    sqe->off = static_cast<uint64_t>(-1);  // current position, as for read(2)
+    sqe->buf_index = static_cast<uint16_t>(index);
+    sqe->flags = n == last ? 0 : IOSQE_IO_HARDLINK;
+    sqe->user_data = tag(r.slot, kind_read, n);
+
+    r.buffers[n] = slot_state::posted;
+    ++r.chain_reads;
+    ++r.pending;
+  }
+}
+
+static void post_wake(shared& ring, reader& r) {
+  io_uring_sqe* sqe = next_sqe(ring);
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = r.wake_fd;
+  sqe->poll_events = POLLIN;
+  sqe->user_data = tag(r.slot, kind_wake, 0);
+
+  r.wake_armed = true;
+  ++r.pending;
+}
+
+static void post_cancel(shared& ring, reader& r, uint64_t target) {
+  io_uring_sqe* sqe = next_sqe(ring);
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->addr = target;
+  sqe->user_data = tag(r.slot, kind_cancel, 0);
+
+  ++r.cancels;
+  ++r.pending;
+}
+
+// Reading the eventfd also resets it
+static void post_bell(shared& ring) {
+  io_uring_sqe* sqe = next_sqe(ring);
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = ring.bell;
+  sqe->addr = reinterpret_cast<uint64_t>(&ring.bell_value);
+  sqe->len = sizeof(ring.bell_value);
+  sqe->user_data = tag(max_readers, kind_bell, 0);
+
+  ring.bell_armed = true;
+}
+
+// The ring thread submits queued requests when it enters next; wake it up
+// if it already sleeps in the kernel
+static void ring_bell(shared& ring) {
+  if ( ring.to_submit == 0 || !ring.entered || ring.bell_rung )
+    return;
+
+  const uint64_t one = 1;
+
+  if ( write(ring.bell, &one, sizeof(one)) != sizeof(one) ) {
+    throw error{"waking up the serial device ring failed."};
+  }
+
+  ring.bell_rung = true;
+}
+
+static void reap(shared& ring) {
+  uint32_t head = *ring.cq_head;
+  const uint32_t tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+
+  for ( ; head != tail; ++head ) {
+    const io_uring_cqe& cqe = ring.cqes[head & *ring.cq_mask];
+    const uint64_t kind = (cqe.user_data >> 8) & 0xff;
+    const int32_t buffer = static_cast<int32_t>(cqe.user_data & 0xff);
+
+    if ( kind == kind_bell ) {
+      ring.bell_armed = false;
+      ring.bell_rung = false;
+      continue;
+    }
+
+    // Polls are not tracked: each one completes before the read behind it
+    if ( kind == kind_poll )
+      continue;
+
+    reader* r = ring.readers[cqe.user_data >> 16];
+    NEO_ASSERT(r);
+
+    --r->pending;
+    r->ready.notify_one();
+
+    switch ( kind ) {
+    case kind_read: {
+      int32_t result = cqe.res;
+
+      // a cancelled or interrupted read simply delivered nothing, neither
+      // did one that raced empty after its poll
+      if ( result == -ECANCELED || result == -EINTR || result == -EAGAIN )
+        result = 0;
+      else if ( result == 0 )
+        result = -EPIPE;  // EOF
+
+      r->buffers[buffer] = slot_state::done;
+      r->results[buffer] = result;
+      r->done[(r->done_head + r->done_count) % depth] = buffer;
+      ++r->done_count;
+
+      // Keep the port busy while the reader catches up
+      if ( --r->chain_reads == 0 )
+        post_chain(ring, *r);
+      break;
+    }
+
+    case kind_wake:
+      r->wake_armed = false;
+      r->interrupted = r->interrupted || cqe.res > 0;
+      break;
+
+    case kind_cancel:
+      --r->cancels;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+}
+
+static void run(shared* ring) {
+  neo::thread::set_name("neo-uring");
+
+  std::unique_lock<std::mutex> held{ring->lock};
+
+  for ( ;; ) {
+    if ( !ring->bell_armed ) {
+      if ( ring->stopping )
+        return;
+
+      post_bell(*ring);
+    }
+
+    const uint32_t to_submit = ring->to_submit;
+    ring->to_submit = 0;
+    ring->entered = true;
+
+    held.unlock();
+    const int32_t ret = sys_enter(ring->ring_fd, to_submit, 1,
+        IORING_ENTER_GETEVENTS);
+    const int32_t failure = ret == -1 ? errno : 0;
+    held.lock();
+
+    ring->entered = false;
+    ring->to_submit += to_submit - (ret > 0 ? static_cast<uint32_t>(ret) : 0);
+
+    if ( failure != 0 && failure != EINTR && failure != EAGAIN && failure != EBUSY )
+      ring->failed = true;
+
+    try {
+      reap(*ring);
+    } catch ( const error& ) {
+      ring->failed = true;
+    }
+
+    if ( ring->failed ) {
+      for ( reader* r : ring->readers ) {
+        if ( r )
+          r->ready.notify_one();
+      }
+
+      return;
+    }
+  }
+}
+
+// Waits for the ring thread to complete requests of r until done() holds;
+// throws timed_out if that takes until the deadline
+template <typename Predicate>
+static void wait(shared& ring, reader& r, std::unique_lock<std::mutex>& held,
+    Predicate done, deadline until = deadline::max()) {
+  while ( !done() ) {
+    if ( ring.failed ) {
+      throw error{"waiting for serial device completions failed."};
+    }
+
+    ring_bell(ring);
+
+    if ( until == deadline::max() ) {
+      r.ready.wait(held);
+    } else if ( r.ready.wait_until(held, until) == std::cv_status::timeout
+        && !done() ) {
+      throw timed_out{"reading from serial device timed out."};
+    }
+  }
+}
+
+// Cancels the posted chain and waits until all of its reads completed. A
+// cancel only finds the request the chain is at; the next one then starts,
+// so this takes a few rounds.
+static void cancel_chain(shared& ring, reader& r, std::unique_lock<std::mutex>& held) {
+  r.cancelling = true;
+
+  while ( r.chain_reads > 0 ) {
+    for ( int32_t n = 0; n < depth; ++n ) {
+      if ( r.buffers[n] != slot_state::posted )
+        continue;
+
+      post_cancel(ring, r, tag(r.slot, kind_poll, n));
+      post_cancel(ring, r, tag(r.slot, kind_read, n));
+    }
+
+    wait(ring, r, held, [&r] { return r.cancels == 0; });
+  }
+
+  r.cancelling = false;
+}
+
+static void unmap(shared* ring) {
+  if ( ring->sqes )
+    munmap(ring->sqes, ring->sqes_size);
+  if ( ring->cq_ptr && ring->cq_ptr != ring->sq_ptr )
+    munmap(ring->cq_ptr, ring->cq_size);
+  if ( ring->sq_ptr )
+    munmap(ring->sq_ptr, ring->sq_size);
+}
+
+static shared* shared_construct() {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  const int32_t ring_fd = sys_setup(ring_entries, &params);
+
+  // ENOSYS on old kernels, EPERM where io_uring is disabled by policy
+  if ( ring_fd == -1 )
+    return nullptr;
+
+  // Hard links need 5.5, as does NODROP
+  if ( !(params.features & IORING_FEAT_NODROP) ) {
+    close(ring_fd);
+    return nullptr;
+  }
+
+  const int32_t bell = eventfd(0, EFD_CLOEXEC);
+
+  if ( bell == -1 ) {
+    close(ring_fd);
+    return nullptr;
+  }
+
+  auto out = new shared();
+  out->ring_fd = ring_fd;
+  out->bell = bell;
+
+#if defined(IOSQE_CQE_SKIP_SUCCESS) && defined(IORING_FEAT_CQE_SKIP)
+  out->skip_polls = (params.features & IORING_FEAT_CQE_SKIP) != 0;
+#endif
+
+  out->sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  out->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+  if ( params.features & IORING_FEAT_SINGLE_MMAP )
+    out->sq_size = out->cq_size = std::max(out->sq_size, out->cq_size);
+
+  out->sq_ptr = mmap(nullptr, out->sq_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  out->cq_ptr = (params.features & IORING_FEAT_SINGLE_MMAP) ? out->sq_ptr
+    : mmap(nullptr, out->cq_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+  out->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  out->sqes = static_cast<io_uring_sqe*>(mmap(nullptr, out->sqes_size,
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+        IORING_OFF_SQES));
+
+  // Pin the buffers once instead of mapping them on every read
+  iovec iovecs[max_readers * depth];
+
+  for ( int32_t n = 0; n < max_readers * depth; ++n )
+    iovecs[n] = {out->buffers[n], buffer_size};
+
+  const bool mapped = out->sq_ptr != MAP_FAILED && out->cq_ptr != MAP_FAILED
+    && out->sqes != MAP_FAILED;
+
+  if ( !mapped || sys_register(ring_fd, IORING_REGISTER_BUFFERS, iovecs,
+        max_readers * depth) == -1 ) {
+    if ( out->sq_ptr == MAP_FAILED ) out->sq_ptr = nullptr;
+    if ( out->cq_ptr == MAP_FAILED ) out->cq_ptr = nullptr;
+    if ( out->sqes == MAP_FAILED ) out->sqes = nullptr;
+    unmap(out);
+    close(ring_fd);
+    close(bell);
+    delete out;
+    return nullptr;
+  }
+
+  auto sq = static_cast<uint8_t*>(out->sq_ptr);
+  out->sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+  out->sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+  out->sq_mask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+  out->sq_entries = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_entries);
+  out->sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+  auto cq = static_cast<uint8_t*>(out->cq_ptr);
+  out->cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+  out->cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+  out->cq_mask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+  out->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  out->thread = std::thread(run, out);
+
+  return out;
+}
+
+// Once the last reader left only the doorbell is still posted
+static void shared_destruct(shared* ring) {
+  {
+    std::lock_guard<std::mutex> held{ring->lock};
+    ring->stopping = true;
+
+    const uint64_t one = 1;
+    const ssize_t written = write(ring->bell, &one, sizeof(one));
+    NEO_ASSERT(written == sizeof(one));
+    (void)written;
+  }
+
+  ring->thread.join();
+
+  unmap(ring);
+  close(ring->ring_fd);
+  close(ring->bell);
+  delete ring;
+}
+
+reader_s reader_construct(int32_t fd, int32_t wake_fd) {
+  std::lock_guard<std::mutex> registry{instance_lock};
+
+  if ( !instance )
+    instance = shared_construct();
+
+  if ( !instance )
+    return nullptr;
+
+  shared& ring = *instance;
+  std::lock_guard<std::mutex> held{ring.lock};
+
+  const auto slot = std::find(ring.readers, ring.readers + max_readers, nullptr);
+
+  if ( ring.failed || slot == ring.readers + max_readers )
+    return nullptr;
+
+  auto out = new reader();
+  out->ring = &ring;
+  out->slot = static_cast<int32_t>(slot - ring.readers);
+  out->fd = fd;
+  out->wake_fd = wake_fd;
+  out->handed_out = -1;
+
+  std::fill(out->buffers, out->buffers + depth, slot_state::free);
+
+  *slot = out;
+  ++ring.users;
+
+  // Submitted once the reader first waits
+  post_wake(ring, *out);
+
+  return out;
+}
+
+void reader_destruct(reader_s reader) {
+  NEO_ASSERT(reader);
+
+  shared& ring = *reader->ring;
+
+  // Requests still in flight would keep writing into the pinned buffers
+  // and completing for a slot that is gone. Cancel them and wait for their
+  // completions first.
+  {
+    std::unique_lock<std::mutex> held{ring.lock};
+
+    try {
+      cancel_chain(ring, *reader, held);
+
+      if ( reader->wake_armed )
+        post_cancel(ring, *reader, tag(reader->slot, kind_wake, 0));
+
+      wait(ring, *reader, held, [reader] { return reader->pending == 0; });
+    } catch ( const error& ) {
+      // The ring thread gave up and reaps nothing any more
+      NEO_ASSERT(ring.failed);
+    }
+
+    ring.readers[reader->slot] = nullptr;
+  }
+
+  delete reader;
+
+  std::lock_guard<std::mutex> registry{instance_lock};
+
+  if ( --ring.users == 0 ) {
+    shared_destruct(instance);
+    instance = nullptr;
+  }
+}
+
+int32_t reader_read(reader_s reader, deadline until, const uint8_t** data) {
+  NEO_ASSERT(reader);
+  NEO_ASSERT(data);
+
+  shared& ring = *reader->ring;
+  std::unique_lock<std::mutex> held{ring.lock};
+
+  if ( reader->handed_out != -1 ) {
+    reader->buffers[reader->handed_out] = slot_state::free;
+    reader->handed_out = -1;
+  }
+
+  for ( ;; ) {
+    if ( reader->interrupted ) {
+      throw interrupted{"reading from serial device interrupted."};
+    }
+
+    // Also when chunks keep coming, e.g. a unit streaming instead of answering
+    if ( until != deadline::max() && std::chrono::steady_clock::now() >= until ) {
+      throw timed_out{"reading from serial device timed out."};
+    }
+
+    // Chunks that landed while the last one was parsed are handed out
+    // without waiting on the ring thread
+    if ( reader->done_count > 0 ) {
+      const int32_t buffer = reader->done[reader->done_head];
+      const int32_t bytes = reader->results[buffer];
+
+      reader->done_head = (reader->done_head + 1) % depth;
+      --reader->done_count;
+
+      if ( bytes <= 0 ) {
+        reader->buffers[buffer] = slot_state::free;
+
+        if ( bytes == -EPIPE ) {
+          throw error{"encountered EOF on serial device."};
+        } else if ( bytes < 0 ) {
+          throw error{"reading from serial device failed."};
+        }
+
+        continue;
+      }
+
+      reader->buffers[buffer] = slot_state::handed_out;
+      reader->handed_out = buffer;
+
+      *data = ring.buffers[reader->slot * depth + buffer];
+      return bytes;
+    }
+
+    // The ring thread posts the next chain as soon as one finished, unless
+    // all buffers were taken by then
+    post_chain(ring, *reader);
+
+    if ( !reader->wake_armed )
+      post_wake(ring, *reader);
+
+    wait(ring, *reader, held, [reader] {
+      return reader->done_count > 0 || reader->interrupted;
+    }, until);
+  }
+}
+
+void reader_flush(reader_s reader) {
+  NEO_ASSERT(reader);
+
+  shared& ring = *reader->ring;
+  std::unique_lock<std::mutex> held{ring.lock};
+
+  cancel_chain(ring, *reader, held);
+
+  // Whatever was read is stale; the next reader_read posts a fresh chain
+  std::fill(reader->buffers, reader->buffers + depth, slot_state::free);
+  reader->done_head = 0;
+  reader->done_count = 0;
+  reader->handed_out = -1;
+  reader->interrupted = false;
+
+  if ( !reader->wake_armed )
+    post_wake(ring, *reader);
+}
+
+}  // namespace uring
+}  // namespace serial
+}  // namespace neo
+
+#else
+
+namespace neo {
+namespace serial {
+namespace uring {
+
+reader_s reader_construct(int32_t fd, int32_t wake_fd) {
+  (void)fd;
+  (void)wake_fd;
+  return nullptr;
+}
+
+void reader_destruct(reader_s reader) { (void)reader; }
+
+int32_t reader_read(reader_s reader, deadline until, const uint8_t** data) {
+  (void)reader;
+  (void)until;
+  (void)data;
+  throw error{"io_uring is not available."};
+}
+
+void reader_flush(reader_s reader) { (void)reader; }
+
+}  // namespace uring
+}  // namespace serial
+}  // namespace neo
+
+#endif
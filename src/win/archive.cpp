@@ -0,0 +1,18 @@
+#include "archive.hpp"
+
+namespace neo {
+namespace archive {
+
+// Not yet available on Windows: archives can be written but not mapped.
+
+mapping map_file(const char* path) {
+  (void)path;
+  throw error{"reading scan archives is not supported on this platform."};
+}
+
+void unmap_file(const mapping& m) {
+  (void)m;
+}
+
+}  // namespace archive
+}  // namespace neo
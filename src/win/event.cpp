@@ -0,0 +1,31 @@
+#include "event.hpp"
+
+namespace neo {
+namespace event {
+
+// Not yet available on Windows: construction reports an error, so the
+// remaining functions are never reached with a valid handle.
+
+flag_s flag_construct() {
+  throw error{"readiness descriptors are not supported on this platform."};
+}
+
+void flag_destruct(flag_s flag) {
+  NEO_ASSERT(!flag);
+}
+
+void flag_set(flag_s flag) {
+  NEO_ASSERT(!flag);
+}
+
+void flag_clear(flag_s flag) {
+  NEO_ASSERT(!flag);
+}
+
+int32_t flag_fd(flag_s flag) {
+  NEO_ASSERT(!flag);
+  return -1;
+}
+
+}  // namespace event
+}  // namespace neo
@@ -0,0 +1,78 @@
+#include "profile.hpp"
+
+#include <string>
+
+#include <windows.h>
+
+namespace neo {
+namespace profile {
+
+struct update_lock {
+  HANDLE file;
+};
+
+update_lock_s lock_for_update(const char* path) {
+  NEO_ASSERT(path);
+
+  const std::string name = std::string{path} + ".lock";
+  HANDLE file = CreateFileA(name.c_str(), GENERIC_READ | GENERIC_WRITE,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if ( file == INVALID_HANDLE_VALUE )
+    return nullptr;
+
+  OVERLAPPED whole = {};
+
+  // Held only for the few file operations of one update
+  if ( !LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD,
+        &whole) ) {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  return new update_lock{file};
+}
+
+void unlock_for_update(update_lock_s lock) {
+  NEO_ASSERT(lock);
+
+  OVERLAPPED whole = {};
+  UnlockFileEx(lock->file, 0, MAXDWORD, MAXDWORD, &whole);
+  CloseHandle(lock->file);
+  delete lock;
+}
+
+bool replace(const char* path, const std::string& contents) {
+  NEO_ASSERT(path);
+
+  // Unique per process and thread; the update lock orders the rest
+  const std::string name = std::string{path} + "."
+    + std::to_string(GetCurrentProcessId()) + "."
+    + std::to_string(GetCurrentThreadId()) + ".tmp";
+
+  HANDLE file = CreateFileA(name.c_str(), GENERIC_WRITE, 0, nullptr,
+      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if ( file == INVALID_HANDLE_VALUE )
+    return false;
+
+  DWORD written = 0;
+  bool ok = WriteFile(file, contents.data(),
+      static_cast<DWORD>(contents.size()), &written, nullptr)
+    && written == contents.size() && FlushFileBuffers(file);
+
+  CloseHandle(file);
+
+  // Replaces the old file in one step, unlike remove followed by rename
+  ok = ok && MoveFileExA(name.c_str(), path,
+      MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+
+  if ( !ok )
+    DeleteFileA(name.c_str());
+
+  return ok;
+}
+
+}  // namespace profile
+}  // namespace neo
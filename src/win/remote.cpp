@@ -0,0 +1,36 @@
+#include "remote.hpp"
+
+namespace neo {
+namespace remote {
+
+// Not yet available on Windows: connecting reports an error, so the
+// remaining functions are never reached with a valid handle.
+
+connection_s connection_construct(const endpoint& to, info& out) {
+  (void)to;
+  (void)out;
+  throw error{"neo:// devices are not supported on this platform."};
+}
+
+void connection_destruct(connection_s connection) {
+  NEO_ASSERT(!connection);
+}
+
+void connection_subscribe(connection_s connection, bool sectors,
+    int32_t decimate) {
+  (void)sectors;
+  (void)decimate;
+  NEO_ASSERT(!connection);
+}
+
+void connection_read(connection_s connection, neo_scan& out) {
+  (void)out;
+  NEO_ASSERT(!connection);
+}
+
+void connection_interrupt(connection_s connection) {
+  NEO_ASSERT(!connection);
+}
+
+}  // namespace remote
+}  // namespace neo
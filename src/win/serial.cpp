@@ -1,5 +1,6 @@
 #include "serial.hpp"
 
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -17,6 +18,8 @@ struct device {
   bool waiting_on_read;      // Used to prevent creation of new read operation
                              // if one is outstanding
   DWORD read_timeout_millis; // timeout interval for entire read operation
+  HANDLE h_interrupt;        // manual-reset event set by device_interrupt
+  deadline until;            // reads waiting past it throw timed_out
 };
 
 static int32_t detail_get_port_number(const char* port) {
@@ -35,10 +38,14 @@ static int32_t detail_get_port_number(const char* port) {
   return -1;
 }
 
-device_s device_construct(const char* port, int32_t baudrate) {
+device_s device_construct(const char* port, int32_t baudrate,
+    const config& cfg) {
   NEO_ASSERT(port);
   NEO_ASSERT(baudrate > 0);
 
+  // Latency profiles only apply to the unix tty implementation
+  (void)cfg;
+
   if ( baudrate != 230400 ) {
     throw error{"baudrate is not supported."};
   }
@@ -126,8 +133,17 @@ device_s device_construct(const char* port, int32_t baudrate) {
     throw error{"flushing serial port failed during serial device construction."};
   }
 
+  // Create the manual-reset interrupt event. Must be closed before exiting
+  auto h_interrupt = CreateEvent(NULL, TRUE, FALSE, NULL);
+  if ( h_interrupt == NULL ) {
+    CloseHandle(h_comm);
+    CloseHandle(os_reader.hEvent);
+    throw error{"creating interrupt event failed."};
+  }
+
   // create the serial device
-  auto out = new device{h_comm, os_reader, FALSE, 500};
+  auto out = new device{h_comm, os_reader, FALSE, 500, h_interrupt,
+    deadline::max()};
 
   return out;
 }
@@ -147,6 +163,9 @@ void device_destruct(device_s serial) {
   // close the overlapped read event
   CloseHandle(serial->os_reader.hEvent);
 
+  // close the interrupt event
+  CloseHandle(serial->h_interrupt);
+
   delete serial;
 }
 
@@ -159,6 +178,11 @@ void device_read(device_s serial, void* to, int32_t len) {
   DWORD dw_num_to_read = (DWORD)len;
   bool f_result = false;
 
+  // The interrupt is sticky until device_flush resets it
+  if ( WaitForSingleObject(serial->h_interrupt, 0) == WAIT_OBJECT_0 ) {
+    throw interrupted{"reading from serial device interrupted."};
+  }
+
   if ( !serial->waiting_on_read ) {
     // Issue read operation.
     if ( !ReadFile(serial->h_comm, (unsigned char*)to, dw_num_to_read,
@@ -180,9 +204,31 @@ void device_read(device_s serial, void* to, int32_t len) {
 
   // If the read is pending, wait for it to finish... but permit timeout
   if ( serial->waiting_on_read ) {
-    dwRes = WaitForSingleObject(serial->os_reader.hEvent,
-        serial->read_timeout_millis);
+    DWORD timeout_millis = serial->read_timeout_millis;
+
+    // A deadline cuts the wait short; the read stays pending for the next call
+    if ( serial->until != deadline::max() ) {
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+          serial->until - std::chrono::steady_clock::now()).count();
+
+      if ( left <= 0 ) {
+        throw timed_out{"reading from serial device timed out."};
+      }
+
+      if ( left < static_cast<int64_t>(timeout_millis) ) {
+        timeout_millis = static_cast<DWORD>(left);
+      }
+    }
+
+    const HANDLE wait_handles[2] = {serial->os_reader.hEvent, serial->h_interrupt};
+    dwRes = WaitForMultipleObjects(2, wait_handles, FALSE, timeout_millis);
     switch ( dwRes ) {
+    // Interrupted; abandon the outstanding read.
+    case WAIT_OBJECT_0 + 1:
+      CancelIo(serial->h_comm);
+      serial->waiting_on_read = false;
+      throw interrupted{"reading from serial device interrupted."};
+
     // Read completed.
     case WAIT_OBJECT_0:
       if ( !GetOverlappedResult(serial->h_comm, &(serial->os_reader),
@@ -200,6 +246,11 @@ void device_read(device_s serial, void* to, int32_t len) {
       break;
 
     case WAIT_TIMEOUT:
+      if ( serial->until != deadline::max()
+          && std::chrono::steady_clock::now() >= serial->until ) {
+        throw timed_out{"reading from serial device timed out."};
+      }
+
       // Operation isn't complete yet. serial->waiting_on_read flag isn't changed since we'll loop back
       // around, and we don't want to issue another read until the first one finishes.
       break;
@@ -296,6 +347,46 @@ void device_flush(device_s serial) {
   if ( !PurgeComm(serial->h_comm, PURGE_RXABORT | PURGE_TXABORT | PURGE_RXCLEAR | PURGE_TXCLEAR) ) {
     throw error{"flushing serial port failed."};
   }
+
+  // pending reads were aborted above; forget about any interrupt
+  serial->waiting_on_read = false;
+  ResetEvent(serial->h_interrupt);
+}
+
+void device_interrupt(device_s serial) {
+  NEO_ASSERT(serial);
+
+  if ( !SetEvent(serial->h_interrupt) ) {
+    throw error{"interrupting serial device failed."};
+  }
+}
+
+void device_set_deadline(device_s serial, deadline until) {
+  NEO_ASSERT(serial);
+
+  serial->until = until;
+}
+
+int32_t device_fd(device_s serial) {
+  NEO_ASSERT(serial);
+
+  // Overlapped handles do not fit poll-style readiness
+  return -1;
+}
+
+std::vector<std::string> list_ports() {
+  std::vector<std::string> out;
+  char target[256];
+
+  // Every COM port present has a DOS device name, USB adapters included
+  for ( int32_t n = 1; n <= 255; ++n ) {
+    const std::string port = "COM" + std::to_string(n);
+
+    if ( QueryDosDeviceA(port.c_str(), target, sizeof(target)) != 0 )
+      out.push_back(port);
+  }
+
+  return out;
 }
 
 } // namespace serial
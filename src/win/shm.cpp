@@ -0,0 +1,67 @@
+#include "shm.hpp"
+
+namespace neo {
+namespace shm {
+
+// Not yet available on Windows: constructing either end reports an error,
+// so the remaining functions are never reached with a valid handle.
+
+publisher_s publisher_construct(const char* name, int32_t slots) {
+  (void)name;
+  (void)slots;
+  throw error{"shared memory scan rings are not supported on this platform."};
+}
+
+void publisher_destruct(publisher_s publisher) {
+  NEO_ASSERT(!publisher);
+}
+
+void publisher_publish(publisher_s publisher, const sample* samples,
+    int32_t count, int32_t revolution, int32_t sector, int64_t timestamp) {
+  (void)samples;
+  (void)count;
+  (void)revolution;
+  (void)sector;
+  (void)timestamp;
+  NEO_ASSERT(!publisher);
+}
+
+reader_s reader_construct(const char* name) {
+  (void)name;
+  throw error{"shared memory scan rings are not supported on this platform."};
+}
+
+void reader_destruct(reader_s reader) {
+  NEO_ASSERT(!reader);
+}
+
+const frame* reader_acquire(reader_s reader, int32_t timeout_ms) {
+  (void)timeout_ms;
+  NEO_ASSERT(!reader);
+  return nullptr;
+}
+
+bool reader_release(reader_s reader) {
+  NEO_ASSERT(!reader);
+  return false;
+}
+
+bool reader_read(reader_s reader, int32_t timeout_ms, neo_scan& out) {
+  (void)timeout_ms;
+  (void)out;
+  NEO_ASSERT(!reader);
+  return false;
+}
+
+uint64_t reader_sequence(reader_s reader) {
+  NEO_ASSERT(!reader);
+  return 0;
+}
+
+uint64_t reader_dropped(reader_s reader) {
+  NEO_ASSERT(!reader);
+  return 0;
+}
+
+}  // namespace shm
+}  // namespace neo
@@ -0,0 +1,26 @@
+#include "transport.hpp"
+
+namespace neo {
+namespace transport {
+
+// Nothing connects here, so there is nothing to interrupt
+struct interrupter {};
+
+interrupter_s interrupter_construct() { return new interrupter{}; }
+void interrupter_destruct(interrupter_s interrupter) { delete interrupter; }
+void interrupter_interrupt(interrupter_s interrupter) { (void)interrupter; }
+void interrupter_reset(interrupter_s interrupter) { (void)interrupter; }
+
+transport_s unix_socket_construct(const char* path) {
+  (void)path;
+  throw error{"socket transports are not supported on this platform."};
+}
+
+transport_s tcp_socket_construct(const char* address, interrupter_s interrupter) {
+  (void)address;
+  (void)interrupter;
+  throw error{"socket transports are not supported on this platform."};
+}
+
+}  // namespace transport
+}  // namespace neo
@@ -0,0 +1,34 @@
+#include "thread.hpp"
+
+#include <windows.h>
+
+namespace neo {
+namespace thread {
+
+bool set_affinity(uint64_t cpu_mask) {
+  return SetThreadAffinityMask(GetCurrentThread(),
+      static_cast<DWORD_PTR>(cpu_mask)) != 0;
+}
+
+bool set_realtime_priority(int32_t priority) {
+  // Windows has no per-thread FIFO policy; use its highest regular class
+  (void)priority;
+  return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+}
+
+bool set_name(const char* name) {
+  // SetThreadDescription is not available on all supported versions
+  (void)name;
+  return false;
+}
+
+bool lock_memory(const void* address, size_t length) {
+  return VirtualLock(const_cast<void*>(address), length) != 0;
+}
+
+void unlock_memory(const void* address, size_t length) {
+  VirtualUnlock(const_cast<void*>(address), length);
+}
+
+}  // namespace thread
+}  // namespace neo
@@ -0,0 +1,178 @@
+// Scans through an archive file and back, and archives cut short or
+// damaged on disk.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#include "capture.hpp"
+
+namespace {
+
+const int32_t scans = 10;
+const int32_t chunk_scans = 4;  // three chunks: 4, 4 and 2 scans
+
+// Header sizes and column alignment of the file format, see archive.hpp
+const size_t file_header = 64;
+const size_t chunk_header = 64;
+const size_t alignment = 64;
+
+// Scan n has 3n samples, the first none
+neo::scan make_scan(int32_t n) {
+  neo::scan out{{}, n, -1, {}, {}, {}, 1000 * (n + 1)};
+
+  for ( int32_t k = 0; k < 3 * n; ++k )
+    out.samples.push_back({1.5f * k, 100 + 10 * n + k});
+
+  return out;
+}
+
+std::string read_file(const std::string& path) {
+  std::ifstream file{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+void write_file(const std::string& path, const std::string& bytes) {
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+  file << bytes;
+  CHECK(file.good());
+}
+
+uint64_t u64_at(const std::string& bytes, size_t at) {
+  uint64_t out;
+  memcpy(&out, bytes.data() + at, sizeof(out));
+  return out;
+}
+
+size_t padded(size_t bytes) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+// Scans a reader finds in bytes
+int64_t scans_in(const std::string& path, const std::string& bytes) {
+  write_file(path, bytes);
+  return neo::archive_reader{path.c_str()}.size();
+}
+
+std::string open_error(const std::string& path, const std::string& bytes) {
+  write_file(path, bytes);
+
+  try {
+    neo::archive_reader reader{path.c_str()};
+  } catch ( const neo::device_error& e ) {
+    return e.what();
+  }
+
+  return "";
+}
+
+void round_trip(const std::string& path) {
+  {
+    neo::archive_writer writer{path.c_str(), chunk_scans};
+
+    for ( int32_t n = 0; n < scans; ++n )
+      writer.append(make_scan(n));
+
+    writer.flush();
+    CHECK(writer.get_dropped() == 0);
+  }
+
+  neo::archive_reader reader{path.c_str()};
+  CHECK(reader.size() == scans);
+
+  const int64_t first = reader.at(0).timestamp;
+
+  for ( int32_t n = 0; n < scans; ++n ) {
+    const auto expected = make_scan(n);
+    const auto scan = reader.at(n);
+
+    CHECK(scan.revolution == n);
+    CHECK(scan.count == 3 * n);
+
+    for ( int32_t k = 0; k < scan.count; ++k ) {
+      CHECK(scan.angles[k] == expected.samples[k].angle);
+      CHECK(scan.distances[k] == expected.samples[k].distance);
+    }
+
+    // Steady clock timestamps come back on the Unix epoch, spaced alike
+    CHECK(scan.timestamp - first == expected.timestamp - 1000);
+
+    CHECK(reader.find(scan.timestamp) == n);
+    CHECK(reader.find(scan.timestamp - 1) == n);
+  }
+
+  CHECK(reader.find(first - 1000000) == 0);
+  CHECK(reader.find(reader.at(scans - 1).timestamp + 1) == scans);
+}
+
+// A torn or damaged chunk ends the archive; the chunks before it stay
+void damaged(const std::string& path) {
+  const std::string bytes = read_file(path);
+  const std::string copy = path + ".damaged";
+
+  const size_t second = file_header + u64_at(bytes, file_header + 16);
+  const size_t third = second + u64_at(bytes, second + 16);
+
+  CHECK(third < bytes.size());
+  CHECK(scans_in(copy, bytes) == scans);
+
+  // Cut anywhere in the last chunk, or in its header
+  CHECK(scans_in(copy, bytes.substr(0, bytes.size() - 1)) == 2 * chunk_scans);
+  CHECK(scans_in(copy, bytes.substr(0, third + 10)) == 2 * chunk_scans);
+  CHECK(scans_in(copy, bytes.substr(0, third)) == 2 * chunk_scans);
+  CHECK(scans_in(copy, bytes.substr(0, third - 1)) == chunk_scans);
+  CHECK(scans_in(copy, bytes.substr(0, file_header)) == 0);
+
+  // Sample offsets of the second chunk that go backwards; its first scan
+  // still has its samples, the columns before hold timestamps and
+  // revolutions
+  const size_t offsets = second + chunk_header + padded(chunk_scans * sizeof(int64_t))
+    + padded(chunk_scans * sizeof(int32_t));
+
+  std::string decreasing = bytes;
+  uint32_t offset[3];
+  memcpy(offset, decreasing.data() + offsets, sizeof(offset));
+  CHECK(offset[0] == 0 && offset[1] < offset[2]);
+
+  offset[1] = offset[2] + 1;
+  memcpy(&decreasing[offsets], offset, sizeof(offset));
+  CHECK(scans_in(copy, decreasing) == chunk_scans);
+
+  // Not an archive, or one this version cannot read
+  CHECK(open_error(copy, "") == "not a scan archive.");
+  CHECK(open_error(copy, std::string(file_header, 'x')) == "not a scan archive.");
+
+  std::string future = bytes;
+  future[4] = 99;
+  CHECK(open_error(copy, future)
+      == "scan archive was written by an incompatible version.");
+
+  unlink(copy.c_str());
+}
+
+}  // namespace
+
+int main() try {
+  const std::string directory = capture::temporary_directory();
+  const std::string path = directory + "/archive";
+
+  round_trip(path);
+  damaged(path);
+
+  unlink(path.c_str());
+  rmdir(directory.c_str());
+
+  std::cout << "archive round trips passed" << std::endl;
+} catch ( const neo::device_error& e ) {
+  std::cerr << "Error: " << e.what() << std::endl;
+  return EXIT_FAILURE;
+}
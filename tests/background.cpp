@@ -0,0 +1,111 @@
+// Background subtraction: learning the room, delivering only what changed
+// in it, and changes that stay fading into the background.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#include "capture.hpp"
+
+namespace {
+
+const int32_t samples_per_revolution = 90;
+const int32_t room = 1000;
+const int32_t object = 400;
+
+const int32_t learning_scans = 5;
+const int32_t min_change = 20;
+
+// Samples of the object, 120 to 136 degrees
+const int32_t first_sample = 30;
+const int32_t object_samples = 5;
+
+// The room with the object in it, or the empty room
+std::string revolution(bool with_object) {
+  std::vector<int32_t> distances(samples_per_revolution, room);
+
+  for ( int32_t n = 0; with_object && n < object_samples; ++n )
+    distances[first_sample + n] = object;
+
+  return capture::revolution(distances);
+}
+
+void check_object(const neo::scan& scan, int32_t distance) {
+  CHECK(static_cast<int32_t>(scan.samples.size()) == object_samples);
+
+  for ( int32_t n = 0; n < object_samples; ++n ) {
+    CHECK(scan.samples[n].angle == 4.f * (first_sample + n));
+    CHECK(scan.samples[n].distance == distance);
+  }
+}
+
+void subtraction(const std::string& directory) {
+  // The empty room, then the object for long enough to become part of the
+  // background, then the empty room again
+  const int32_t empty_scans = 10;
+  const int32_t object_scans = 400;
+  const int32_t gone_scans = 5;
+
+  std::vector<std::string> revolutions;
+
+  for ( int32_t n = 0; n < empty_scans; ++n )
+    revolutions.push_back(revolution(false));
+  for ( int32_t n = 0; n < object_scans; ++n )
+    revolutions.push_back(revolution(true));
+  for ( int32_t n = 0; n <= gone_scans; ++n )
+    revolutions.push_back(revolution(false));
+
+  neo::device_options options;
+  options.set_background(samples_per_revolution, learning_scans, min_change);
+  options.set_grid(samples_per_revolution);
+
+  const auto scans = capture::replay(directory + "/background", revolutions, options);
+
+  // Learning and an unchanged room: nothing to deliver. Grids still see
+  // every sample.
+  for ( int32_t n = 0; n < empty_scans; ++n ) {
+    CHECK(scans[n].samples.empty());
+    CHECK(scans[n].grid == std::vector<int32_t>(samples_per_revolution, room));
+  }
+
+  // Exactly the object, until it stayed long enough to fade in; then
+  // nothing again
+  int32_t faded = -1;
+
+  for ( int32_t n = empty_scans; n < empty_scans + object_scans; ++n ) {
+    if ( faded == -1 && scans[n].samples.empty() )
+      faded = n;
+
+    if ( faded == -1 )
+      check_object(scans[n], object);
+    else
+      CHECK(scans[n].samples.empty());
+  }
+
+  CHECK(faded > empty_scans + 100);
+
+  // Where it stood now differs from the background
+  for ( int32_t n = empty_scans + object_scans; n < static_cast<int32_t>(scans.size()); ++n )
+    check_object(scans[n], room);
+}
+
+}  // namespace
+
+int main() try {
+  const std::string directory = capture::temporary_directory();
+
+  subtraction(directory);
+
+  rmdir(directory.c_str());
+
+  std::cout << "background subtraction passed" << std::endl;
+} catch ( const neo::device_error& e ) {
+  std::cerr << "Error: " << e.what() << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,142 @@
+#ifndef _TESTS_CAPTURE_HPP_
+#define _TESTS_CAPTURE_HPP_
+
+// Shared by the tests: device bytes as the unit sends them, captures made
+// of them, and a failure check.
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#define CHECK(condition)                                                     \
+  do {                                                                       \
+    if ( !(condition) ) {                                                    \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: "         \
+        << #condition << std::endl;                                          \
+      std::exit(EXIT_FAILURE);                                               \
+    }                                                                        \
+  } while ( 0 )
+
+namespace capture {
+
+// One scan packet, see protocol.hpp
+inline std::string packet(float degrees, int32_t distance, bool sync) {
+  const uint16_t angle = static_cast<uint16_t>(degrees * 128);
+  const uint8_t low = distance & 0x1f;
+  const uint8_t high = (distance >> 5) & 0xff;
+  const uint8_t first = static_cast<uint8_t>((low << 3) | (sync ? 1 : 0));
+  const uint8_t checksum = ((low << 3) + (sync ? 1 : 0) + high + (angle & 0xff)
+      + (angle >> 8)) % 15;
+
+  const char bytes[] = {static_cast<char>(first), static_cast<char>(high),
+    static_cast<char>(angle & 0xff), static_cast<char>(angle >> 8),
+    static_cast<char>(checksum)};
+
+  return std::string(bytes, sizeof(bytes));
+}
+
+// A revolution of evenly spaced samples starting at 0 degrees. Counts
+// dividing 360 * 128 put every angle exactly on the device's grid.
+inline std::string revolution(const std::vector<int32_t>& distances) {
+  std::string out;
+  const int32_t count = static_cast<int32_t>(distances.size());
+
+  for ( int32_t n = 0; n < count; ++n )
+    out += packet(360.f * n / count, distances[n], n == 0);
+
+  return out;
+}
+
+// A replay yields one scan less than it holds revolutions: the last one
+// is never closed by a sync packet
+inline void write(const std::string& path, const std::vector<std::string>& revolutions) {
+  std::ofstream file{path, std::ios::binary};
+
+  for ( const auto& bytes : revolutions )
+    file << bytes;
+
+  CHECK(file.good());
+}
+
+// The scans of a replay of revolutions through a device with options;
+// the replay waits for the test instead of dropping scans
+inline std::vector<neo::scan> replay(const std::string& path,
+    const std::vector<std::string>& revolutions, neo::device_options& options) {
+  write(path, revolutions);
+  options.set_queue_policy(neo::queue_policy::block_producer);
+
+  neo::neo device{("file:" + path).c_str(), 115200, options};
+  device.start_scanning();
+
+  std::vector<neo::scan> out;
+
+  try {
+    for ( ;; )
+      out.push_back(device.get_scan());
+  } catch ( const neo::device_error& e ) {
+    CHECK(std::string(e.what()) == "reached the end of the capture file.");
+  }
+
+  CHECK(out.size() + 1 == revolutions.size());
+  unlink(path.c_str());
+  return out;
+}
+
+// A capture written while the device reads it, through a named pipe: each
+// revolution sent completes the one before it. Close it before the device
+// goes away, which otherwise waits for more bytes forever.
+class live {
+ public:
+  explicit live(const std::string& path) : path(path) {
+    CHECK(mkfifo(path.c_str(), 0600) == 0);
+
+    // Read-write, so opening does not wait for the device to open it
+    fd = open(path.c_str(), O_RDWR);
+    CHECK(fd != -1);
+  }
+
+  ~live() {
+    close();
+    unlink(path.c_str());
+  }
+
+  live(const live&) = delete;
+  live& operator=(const live&) = delete;
+
+  std::string port() const { return "file:" + path; }
+
+  void send(const std::string& bytes) {
+    CHECK(::write(fd, bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()));
+  }
+
+  // The device reads what is left, then reaches the end of the capture
+  void close() {
+    if ( fd != -1 )
+      ::close(fd);
+    fd = -1;
+  }
+
+ private:
+  std::string path;
+  int fd;
+};
+
+inline std::string temporary_directory() {
+  char path[] = "/tmp/neo-test-XXXXXX";
+  CHECK(mkdtemp(path) != nullptr);
+  return path;
+}
+
+}  // namespace capture
+
+#endif  // _TESTS_CAPTURE_HPP_
@@ -0,0 +1,219 @@
+// Clusters of single scans, including one joined across 0 degrees, and
+// objects tracked across the scans of a device.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#include "capture.hpp"
+
+namespace {
+
+const int32_t room = 1000;
+const int32_t no_return = 1;  // as the device reports it
+
+// 36 samples, 10 degrees apart. Neighbors at 100 cm are 17 cm apart, at
+// the room's 1000 cm far more than any gap used here.
+neo::scan make_scan(const std::vector<int32_t>& distances) {
+  neo::scan out{{}, 0, -1, {}, {}, {}, 0};
+
+  for ( size_t n = 0; n < distances.size(); ++n )
+    out.samples.push_back({10.f * n, distances[n]});
+
+  return out;
+}
+
+// The room with objects at 100 cm on the given samples
+neo::scan room_with(const std::vector<int32_t>& indices) {
+  std::vector<int32_t> distances(36, room);
+
+  for ( const int32_t n : indices )
+    distances[n] = 100;
+
+  return make_scan(distances);
+}
+
+void check_cluster(const neo::cluster& c, int32_t first, int32_t last, int32_t count) {
+  CHECK(c.first_sample == first);
+  CHECK(c.last_sample == last);
+  CHECK(c.sample_count == count);
+  CHECK(c.min_x <= c.centroid_x && c.centroid_x <= c.max_x);
+  CHECK(c.min_y <= c.centroid_y && c.centroid_y <= c.max_y);
+}
+
+void extraction() {
+  // An object across 0 degrees is one cluster, reported where it starts
+  const auto wrapped = neo::extract_clusters(room_with({34, 35, 0, 1, 10, 11, 12}), 20, 2);
+
+  CHECK(wrapped.size() == 2);
+  check_cluster(wrapped[0], 10, 12, 3);
+  check_cluster(wrapped[1], 34, 1, 4);
+  CHECK(wrapped[1].min_y < 0 && wrapped[1].max_y > 0);
+  CHECK(wrapped[1].centroid_x > 95);
+
+  // One starting at 0 degrees that does not reach around stays first
+  const auto head = neo::extract_clusters(room_with({0, 1, 2, 20, 21, 22}), 20, 2);
+
+  CHECK(head.size() == 2);
+  check_cluster(head[0], 0, 2, 3);
+  check_cluster(head[1], 20, 22, 3);
+
+  // Every lone sample of the room is a cluster of its own
+  CHECK(neo::extract_clusters(room_with({0, 1, 2, 20, 21, 22}), 20, 1).size() == 32);
+
+  // A missing return does not split an object the gap bridges
+  std::vector<int32_t> distances(36, room);
+  distances[10] = distances[11] = distances[13] = distances[14] = 100;
+  distances[12] = no_return;
+  const auto holed = make_scan(distances);
+
+  const auto bridged = neo::extract_clusters(holed, 40, 2);
+  CHECK(bridged.size() == 1);
+  check_cluster(bridged[0], 10, 14, 4);
+
+  const auto split = neo::extract_clusters(holed, 20, 2);
+  CHECK(split.size() == 2);
+  check_cluster(split[0], 10, 11, 2);
+  check_cluster(split[1], 13, 14, 2);
+
+  // All the way around: one cluster, not joined to itself
+  const auto circle = neo::extract_clusters(make_scan(std::vector<int32_t>(36, 100)), 20, 2);
+  CHECK(circle.size() == 1);
+  check_cluster(circle[0], 0, 35, 36);
+  CHECK(std::fabs(circle[0].centroid_x) < 1 && std::fabs(circle[0].centroid_y) < 1);
+
+  CHECK(neo::extract_clusters(make_scan(std::vector<int32_t>(36, no_return)), 20, 1).empty());
+  CHECK(neo::extract_clusters(make_scan({}), 20, 1).empty());
+}
+
+// Scans of 360 samples, 1 degree apart, seeing nothing but two objects:
+// A at 200 cm moving 1 degree a scan until scan 12, B standing at 300 cm
+// from scan 6
+const int32_t scans = 18;
+const int32_t a_gone = 12;
+const int32_t b_appears = 6;
+const int32_t max_misses = 3;
+
+std::string tracking_revolution(int32_t scan) {
+  std::vector<int32_t> distances(360, no_return);
+
+  for ( int32_t n = 0; n < 5; ++n ) {
+    if ( scan < a_gone )
+      distances[30 + scan + n] = 200;
+    if ( scan >= b_appears )
+      distances[200 + n] = 300;
+  }
+
+  return capture::revolution(distances);
+}
+
+const neo::track* find_track(const neo::scan& scan, int32_t id) {
+  for ( const auto& track : scan.tracks ) {
+    if ( track.id == id )
+      return &track;
+  }
+
+  return nullptr;
+}
+
+void tracking(const std::string& directory) {
+  capture::live feed{directory + "/tracking"};
+
+  neo::device_options options;
+  options.set_clusters(10, 3);
+  options.set_tracking(50, max_misses);
+
+  neo::neo device{feed.port().c_str(), 115200, options};
+  device.start_scanning();
+
+  feed.send(tracking_revolution(0));
+
+  int32_t a = -1;
+  int32_t b = -1;
+
+  for ( int32_t n = 0; n < scans; ++n ) {
+    // Scans a realistic time apart for the motion model
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    feed.send(tracking_revolution(n + 1));
+
+    const auto scan = device.get_scan();
+    CHECK(scan.revolution == n);
+
+    const bool has_a = n < a_gone;
+    const bool has_b = n >= b_appears;
+    CHECK(static_cast<int32_t>(scan.clusters.size()) == has_a + has_b);
+
+    // Confirmed on the third scan in a row
+    if ( n == 2 ) {
+      CHECK(scan.tracks.size() == 1);
+      a = scan.tracks[0].id;
+    }
+
+    if ( n == b_appears + 2 ) {
+      CHECK(scan.tracks.size() == 2);
+      b = scan.tracks[0].id == a ? scan.tracks[1].id : scan.tracks[0].id;
+      CHECK(b != a);
+    }
+
+    if ( n < 2 ) {
+      CHECK(scan.tracks.empty());
+      continue;
+    }
+
+    // A keeps its id while it moves, and survives a few scans without it
+    const neo::track* track_a = find_track(scan, a);
+    CHECK((track_a != nullptr) == (n <= a_gone - 1 + max_misses));
+
+    if ( track_a && has_a ) {
+      CHECK(track_a->misses == 0);
+      CHECK(track_a->age == n + 1);
+      CHECK(std::hypot(track_a->x - scan.clusters[0].centroid_x,
+            track_a->y - scan.clusters[0].centroid_y) < 10);
+    } else if ( track_a ) {
+      CHECK(track_a->misses == n - a_gone + 1);
+    }
+
+    if ( n >= b_appears + 2 ) {
+      const neo::track* track_b = find_track(scan, b);
+      CHECK(track_b != nullptr);
+      CHECK(track_b->misses == 0);
+    }
+
+    CHECK(static_cast<int32_t>(scan.tracks.size())
+        == (track_a != nullptr) + (n >= b_appears + 2));
+  }
+
+  feed.close();
+
+  try {
+    device.get_scan();
+    CHECK(false);
+  } catch ( const neo::device_error& e ) {
+    CHECK(std::string(e.what()) == "reached the end of the capture file.");
+  }
+}
+
+}  // namespace
+
+int main() try {
+  const std::string directory = capture::temporary_directory();
+
+  extraction();
+  tracking(directory);
+
+  rmdir(directory.c_str());
+
+  std::cout << "clusters and tracking passed" << std::endl;
+} catch ( const neo::device_error& e ) {
+  std::cerr << "Error: " << e.what() << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,171 @@
+// Round trips through the scan encoding, raw and compressed, and decoding
+// of truncated and corrupt input.
+
+#include <stdlib.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#define CHECK(condition)                                                     \
+  do {                                                                       \
+    if ( !(condition) ) {                                                    \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: "         \
+        << #condition << std::endl;                                          \
+      std::exit(EXIT_FAILURE);                                               \
+    }                                                                        \
+  } while ( 0 )
+
+namespace {
+
+// Samples per scan the encoding takes at most
+const int32_t max_samples = 4096;
+
+// Angles on the device's 1/128 degree grid, so the encoding is lossless;
+// distances jump around so the deltas are not all small
+neo::scan make_scan(int32_t count) {
+  neo::scan out{{}, 42, -1, {}, {}, {}, 0};
+
+  for ( int32_t n = 0; n < count; ++n ) {
+    const float angle = static_cast<float>((n * 360 * 128) / count) / 128;
+    out.samples.push_back({angle, (n * 7919) % 4000});
+  }
+
+  return out;
+}
+
+// A static scene: the same distances over and over compress well
+neo::scan make_static_scan(int32_t count) {
+  neo::scan out{{}, 7, 3, {}, {}, {}, 0};
+
+  for ( int32_t n = 0; n < count; ++n )
+    out.samples.push_back({static_cast<float>(n % 360), 250});
+
+  return out;
+}
+
+void check_equal(const neo::scan& a, const neo::scan& b) {
+  CHECK(a.revolution == b.revolution);
+  CHECK(a.sector == b.sector);
+  CHECK(a.samples.size() == b.samples.size());
+
+  for ( size_t n = 0; n < a.samples.size(); ++n ) {
+    CHECK(a.samples[n].angle == b.samples[n].angle);
+    CHECK(a.samples[n].distance == b.samples[n].distance);
+  }
+}
+
+bool decodes(const std::vector<uint8_t>& data) {
+  try {
+    neo::decode(data.data(), data.size());
+    return true;
+  } catch ( const neo::device_error& ) {
+    return false;
+  }
+}
+
+std::string decode_error(const std::vector<uint8_t>& data) {
+  try {
+    neo::decode(data.data(), data.size());
+  } catch ( const neo::device_error& e ) {
+    return e.what();
+  }
+
+  return "";
+}
+
+void round_trip(const neo::scan& scan) {
+  for ( const bool compress : {false, true} ) {
+    const auto encoded = neo::encode(scan, compress);
+    check_equal(scan, neo::decode(encoded.data(), encoded.size()));
+  }
+}
+
+void round_trips() {
+  round_trip(make_scan(0));
+  round_trip(make_scan(1));
+  round_trip(make_scan(100));
+  round_trip(make_scan(max_samples));
+  round_trip(make_static_scan(max_samples));
+
+  // Decoding reuses its buffers: a small scan after a large one is intact
+  round_trip(make_scan(3));
+
+  const auto scan = make_static_scan(1000);
+  CHECK(neo::encode(scan, true).size() < neo::encode(scan, false).size());
+}
+
+// Every proper prefix of an encoding fails cleanly
+void truncated() {
+  for ( const bool compress : {false, true} ) {
+    const auto encoded = neo::encode(make_scan(200), compress);
+
+    for ( size_t size = 0; size < encoded.size(); ++size ) {
+      const std::vector<uint8_t> prefix(encoded.begin(), encoded.begin() + size);
+      CHECK(!decodes(prefix));
+    }
+  }
+}
+
+void corrupt() {
+  const auto encoded = neo::encode(make_static_scan(500), true);
+
+  auto bad_magic = encoded;
+  bad_magic[0] = 'X';
+  CHECK(decode_error(bad_magic) == "not an encoded scan.");
+
+  auto bad_version = encoded;
+  bad_version[2] = 99;
+  CHECK(decode_error(bad_version) == "unsupported encoded scan version.");
+
+  // Flags this version does not know are refused, not ignored
+  for ( int32_t bit = 1; bit < 8; ++bit ) {
+    auto unknown_flag = encoded;
+    unknown_flag[3] = static_cast<uint8_t>(unknown_flag[3] | (1 << bit));
+    CHECK(decode_error(unknown_flag) == "unknown flags in encoded scan.");
+  }
+
+  // Any damaged byte either fails or still decodes into a valid scan
+  for ( size_t at = 0; at < encoded.size(); ++at ) {
+    for ( const uint8_t mask : {0x01, 0x80, 0xff} ) {
+      auto damaged = encoded;
+      damaged[at] = static_cast<uint8_t>(damaged[at] ^ mask);
+
+      try {
+        const auto scan = neo::decode(damaged.data(), damaged.size());
+        CHECK(static_cast<int32_t>(scan.samples.size()) <= max_samples);
+      } catch ( const neo::device_error& ) {
+        // refused
+      }
+    }
+  }
+
+  // The encoder refuses flags it does not know as well
+  neo_error_s error = nullptr;
+  const neo_scan_s scan = neo_scan_construct(nullptr, nullptr, 0, 0, -1, &error);
+  CHECK(scan && !error);
+
+  uint8_t buffer[64];
+  CHECK(neo_scan_encode(scan, 2, buffer, sizeof(buffer), &error) == 0);
+  CHECK(error);
+  CHECK(std::string(neo_error_message(error)) == "unknown scan encoding flags.");
+
+  neo_error_destruct(error);
+  neo_scan_destruct(scan);
+}
+
+}  // namespace
+
+int main() try {
+  round_trips();
+  truncated();
+  corrupt();
+
+  std::cout << "codec round trips passed" << std::endl;
+} catch ( const neo::device_error& e ) {
+  std::cerr << "Error: " << e.what() << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,150 @@
+// Grid reductions of single scans, the grid the device bins while it
+// assembles scans, and its temporal median and vote filters.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#include "capture.hpp"
+
+namespace {
+
+// 90 samples, 4 degrees apart: one per bin of a 90 bin grid
+const int32_t samples_per_revolution = 90;
+const int32_t room = 1000;
+
+neo::scan make_scan(const std::vector<neo::sample>& samples) {
+  return {samples, 0, -1, {}, {}, {}, 0};
+}
+
+void reductions() {
+  // Three samples in the first quarter, two in the second, none after
+  const auto scan = make_scan({{10.f, 100}, {44.f, 300}, {80.f, 200},
+      {100.f, 1}, {110.f, 2}});
+
+  const auto min = neo::resample(scan, 4, neo::grid_reduction::min);
+  const auto nearest = neo::resample(scan, 4, neo::grid_reduction::nearest);
+  const auto mean = neo::resample(scan, 4, neo::grid_reduction::mean);
+
+  CHECK((min == std::vector<int32_t>{100, 1, neo::grid_empty, neo::grid_empty}));
+  // 44 degrees is closest to the bin's center at 45
+  CHECK((nearest == std::vector<int32_t>{300, 2, neo::grid_empty, neo::grid_empty}));
+  // 1.5 rounds up
+  CHECK((mean == std::vector<int32_t>{200, 2, neo::grid_empty, neo::grid_empty}));
+
+  // The last bin runs up to 360 degrees; bins without samples stay empty
+  CHECK(neo::resample(make_scan({{359.f, 50}}), 4)
+      == (std::vector<int32_t>{neo::grid_empty, neo::grid_empty, neo::grid_empty, 50}));
+  CHECK(neo::resample(make_scan({}), 2)
+      == (std::vector<int32_t>{neo::grid_empty, neo::grid_empty}));
+}
+
+// The grid a device bins during assembly is the scan's samples resampled
+void device_grid(const std::string& directory) {
+  std::vector<std::string> revolutions;
+
+  for ( int32_t r = 0; r < 4; ++r ) {
+    std::vector<int32_t> distances;
+
+    for ( int32_t n = 0; n < samples_per_revolution; ++n )
+      distances.push_back(100 + (n * 37 + r * 11) % 500);
+
+    revolutions.push_back(capture::revolution(distances));
+  }
+
+  for ( const auto reduction : {neo::grid_reduction::min,
+      neo::grid_reduction::nearest, neo::grid_reduction::mean} ) {
+    neo::device_options options;
+    options.set_grid(8, reduction);
+
+    for ( const auto& scan : capture::replay(directory + "/grid", revolutions, options) ) {
+      CHECK(static_cast<int32_t>(scan.samples.size()) == samples_per_revolution);
+      CHECK(scan.grid == neo::resample(scan, 8, reduction));
+    }
+  }
+}
+
+// One bin of the filtered grid over scans in which that bin's distance
+// goes through `sequence` and every other bin sees the room
+std::vector<int32_t> filtered(const std::string& directory,
+    const std::vector<int32_t>& sequence, neo::temporal_filter mode) {
+  const int32_t bin = 20;
+
+  std::vector<std::string> revolutions;
+
+  for ( const int32_t distance : sequence ) {
+    std::vector<int32_t> distances(samples_per_revolution, room);
+    distances[bin] = distance;
+    revolutions.push_back(capture::revolution(distances));
+  }
+
+  revolutions.push_back(capture::revolution(
+        std::vector<int32_t>(samples_per_revolution, room)));
+
+  neo::device_options options;
+  options.set_grid(samples_per_revolution);
+  options.set_temporal_filter(3, mode);
+
+  std::vector<int32_t> out;
+
+  for ( const auto& scan : capture::replay(directory + "/temporal", revolutions, options) ) {
+    CHECK(static_cast<int32_t>(scan.grid.size()) == samples_per_revolution);
+
+    for ( int32_t b = 0; b < samples_per_revolution; ++b )
+      CHECK(b == bin || scan.grid[b] == room);
+
+    out.push_back(scan.grid[bin]);
+  }
+
+  return out;
+}
+
+void temporal(const std::string& directory) {
+  const int32_t empty = neo::grid_empty;
+
+  // A single stray return is filtered out by both
+  const std::vector<int32_t> spike{room, room, 50, room, room};
+
+  CHECK(filtered(directory, spike, neo::temporal_filter::median)
+      == (std::vector<int32_t>{room, room, room, room, room}));
+  CHECK(filtered(directory, spike, neo::temporal_filter::vote)
+      == (std::vector<int32_t>{room, room, empty, room, room}));
+
+  // A lasting change comes through once most of the window saw it
+  const std::vector<int32_t> step{room, room, 500, 500, 500};
+
+  CHECK(filtered(directory, step, neo::temporal_filter::median)
+      == (std::vector<int32_t>{room, room, room, 500, 500}));
+  CHECK(filtered(directory, step, neo::temporal_filter::vote)
+      == (std::vector<int32_t>{room, room, empty, 500, 500}));
+
+  // Jitter within the tolerance is the same return: vote keeps the newest
+  const std::vector<int32_t> jitter{room, room + 5, room - 5, room + 3, room - 2};
+
+  CHECK(filtered(directory, jitter, neo::temporal_filter::median)
+      == (std::vector<int32_t>{room, room, room, room + 3, room - 2}));
+  CHECK(filtered(directory, jitter, neo::temporal_filter::vote) == jitter);
+}
+
+}  // namespace
+
+int main() try {
+  const std::string directory = capture::temporary_directory();
+
+  reductions();
+  device_grid(directory);
+  temporal(directory);
+
+  rmdir(directory.c_str());
+
+  std::cout << "grid and temporal filters passed" << std::endl;
+} catch ( const neo::device_error& e ) {
+  std::cerr << "Error: " << e.what() << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+// Lidar odometry following a sensor that moves through a rectangular room.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#include "capture.hpp"
+
+namespace {
+
+const double pi = 3.14159265358979;
+
+// cm; the sensor starts off center and moves diagonally, never turning
+const double width = 400;
+const double depth = 300;
+const double start_x = 120;
+const double start_y = 100;
+const double step_x = 2;
+const double step_y = 1;
+
+const int32_t scans = 40;
+
+// What the sensor sees from (x, y): one sample per degree, each the
+// distance to the first wall along its ray
+std::string revolution(double x, double y) {
+  std::vector<int32_t> distances;
+
+  for ( int32_t degrees = 0; degrees < 360; ++degrees ) {
+    const double dx = std::cos(degrees * pi / 180);
+    const double dy = std::sin(degrees * pi / 180);
+
+    double distance = 1e9;
+
+    if ( dx > 1e-9 )
+      distance = std::min(distance, (width - x) / dx);
+    if ( dx < -1e-9 )
+      distance = std::min(distance, -x / dx);
+    if ( dy > 1e-9 )
+      distance = std::min(distance, (depth - y) / dy);
+    if ( dy < -1e-9 )
+      distance = std::min(distance, -y / dy);
+
+    distances.push_back(static_cast<int32_t>(std::lround(distance)));
+  }
+
+  return capture::revolution(distances);
+}
+
+std::string revolution(int32_t scan) {
+  return revolution(start_x + scan * step_x, start_y + scan * step_y);
+}
+
+void moving_sensor(const std::string& directory) {
+  capture::live feed{directory + "/odometry"};
+
+  neo::device_options options;
+  options.set_odometry(50);
+
+  neo::neo device{feed.port().c_str(), 115200, options};
+  device.start_scanning();
+
+  feed.send(revolution(0));
+
+  for ( int32_t n = 0; n < scans; ++n ) {
+    // Waiting for each pose keeps the odometry from skipping scans
+    feed.send(revolution(n + 1));
+
+    const auto pose = device.get_pose();
+    CHECK(pose.revolution == n);
+
+    // Poses are in the frame of the first scan
+    CHECK(std::fabs(pose.x - n * step_x) < 1);
+    CHECK(std::fabs(pose.y - n * step_y) < 1);
+    CHECK(std::fabs(pose.heading) < 0.5);
+    CHECK((pose.correspondences > 0) == (n > 0));
+  }
+
+  feed.close();
+
+  try {
+    device.get_pose();
+    CHECK(false);
+  } catch ( const neo::device_error& e ) {
+    CHECK(std::string(e.what()) == "reached the end of the capture file.");
+  }
+}
+
+}  // namespace
+
+int main() try {
+  const std::string directory = capture::temporary_directory();
+
+  moving_sensor(directory);
+
+  rmdir(directory.c_str());
+
+  std::cout << "odometry passed" << std::endl;
+} catch ( const neo::device_error& e ) {
+  std::cerr << "Error: " << e.what() << std::endl;
+  return EXIT_FAILURE;
+}
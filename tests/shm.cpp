@@ -0,0 +1,120 @@
+// Scans through the shared memory ring while a device publishes as fast as
+// it can: never torn, skipped ones counted, and the ring closing.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#include "capture.hpp"
+
+namespace {
+
+const int32_t samples_per_revolution = 90;
+const int32_t revolutions = 7;  // replayed in a loop
+const int32_t slots = 4;
+
+// Revolution r of the capture has all distances 100 + r
+void check_scan(const neo::scan& scan) {
+  CHECK(scan.sector == -1);
+  CHECK(static_cast<int32_t>(scan.samples.size()) == samples_per_revolution);
+
+  const int32_t distance = 100 + scan.revolution % revolutions;
+
+  for ( int32_t n = 0; n < samples_per_revolution; ++n ) {
+    CHECK(scan.samples[n].angle == 4.f * n);
+    CHECK(scan.samples[n].distance == distance);
+  }
+}
+
+void ring(const std::string& directory) {
+  const std::string path = directory + "/capture";
+  const std::string name = "/neo-test-" + std::to_string(getpid());
+
+  std::vector<std::string> recorded;
+
+  for ( int32_t r = 0; r < revolutions; ++r ) {
+    recorded.push_back(capture::revolution(
+          std::vector<int32_t>(samples_per_revolution, 100 + r)));
+  }
+
+  capture::write(path, recorded);
+
+  neo::device_options options;
+  options.set_shm_ring(name.c_str(), slots);
+
+  std::unique_ptr<neo::neo> device{new neo::neo{("mem:" + path).c_str(), 115200, options}};
+  neo::shm_reader reader{name.c_str()};
+
+  neo::scan scan{{}, -1, -1, {}, {}, {}, 0};
+  CHECK(!reader.read(scan, 0));
+
+  device->start_scanning();
+
+  CHECK(reader.read(scan, 1000));
+  check_scan(scan);
+
+  uint64_t sequence = reader.get_sequence();
+  uint64_t dropped = reader.get_dropped();
+  int32_t revolution = scan.revolution;
+
+  for ( int32_t n = 0; n < 2000; ++n ) {
+    // Now and then fall more than a ring behind
+    if ( n % 100 == 0 )
+      std::this_thread::sleep_for(std::chrono::milliseconds{5});
+
+    CHECK(reader.read(scan, 1000));
+    check_scan(scan);
+
+    // Every scan in between was dropped, and counted
+    CHECK(reader.get_sequence() > sequence);
+    CHECK(reader.get_sequence() - sequence - 1 == reader.get_dropped() - dropped);
+    CHECK(scan.revolution - revolution
+        == static_cast<int32_t>(reader.get_sequence() - sequence));
+
+    sequence = reader.get_sequence();
+    dropped = reader.get_dropped();
+    revolution = scan.revolution;
+  }
+
+  CHECK(reader.get_dropped() > 0);
+
+  device.reset();
+
+  // What is left in the ring can still be read, then it is closed
+  try {
+    for ( int32_t n = 0; n <= slots; ++n ) {
+      if ( reader.read(scan, 0) )
+        check_scan(scan);
+    }
+
+    CHECK(false);
+  } catch ( const neo::device_error& e ) {
+    CHECK(std::string(e.what()) == "scan publisher closed the shared memory ring.");
+  }
+
+  unlink(path.c_str());
+}
+
+}  // namespace
+
+int main() try {
+  const std::string directory = capture::temporary_directory();
+
+  ring(directory);
+
+  rmdir(directory.c_str());
+
+  std::cout << "shm ring passed" << std::endl;
+} catch ( const neo::device_error& e ) {
+  std::cerr << "Error: " << e.what() << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,235 @@
+// Round trips through the transport layer: scans replayed from a capture
+// file, and a fake unit answering commands and streaming over a socket.
+
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <neo/neo.hpp>
+
+#include "capture.hpp"
+
+namespace {
+
+const int32_t samples_per_revolution = 100;
+
+std::string revolution() {
+  std::string out;
+
+  for ( int32_t n = 0; n < samples_per_revolution; ++n ) {
+    const float degrees = 360.f * n / samples_per_revolution;
+    out += capture::packet(degrees, 100 + n, n == 0);
+  }
+
+  return out;
+}
+
+// Command replies
+std::string header(const std::string& command) {
+  return command + "00P\n";
+}
+
+std::string param(const std::string& command, const std::string& argument) {
+  return command + argument + "\n00P\n";
+}
+
+// A unit at 7 Hz that was brought up before, see profile_cache below
+const char serial_number[] = "00012345";
+const int32_t motor_speed = 7;
+
+// Answers commands and streams revolutions on the first connection until
+// the library hangs up
+void serve(int listener) {
+  const int fd = accept(listener, nullptr, nullptr);
+  CHECK(fd != -1);
+
+  std::string pending;
+  bool streaming = false;
+
+  for ( ;; ) {
+    pollfd readable{fd, POLLIN, 0};
+
+    if ( poll(&readable, 1, streaming ? 5 : 100) > 0 ) {
+      char buffer[256];
+      const ssize_t got = read(fd, buffer, sizeof(buffer));
+
+      if ( got <= 0 )
+        break;
+
+      pending.append(buffer, static_cast<size_t>(got));
+    }
+
+    std::string reply;
+    size_t end;
+
+    while ( (end = pending.find('\n')) != std::string::npos ) {
+      const std::string command = pending.substr(0, 2);
+      const std::string argument = pending.substr(2, end > 2 ? end - 2 : 0);
+      pending.erase(0, end + 1);
+
+      if ( command == "DX" ) {
+        streaming = false;
+        reply += header(command);
+      } else if ( command == "DS" ) {
+        reply += header(command);
+        streaming = true;
+      } else if ( command == "MS" || command == "LR" ) {
+        reply += param(command, argument.substr(0, 2));
+      } else if ( command == "CS" ) {
+        reply += header(command);
+      } else if ( command == "IV" ) {
+        reply += std::string("IVNEOF111101") + serial_number + "\n";
+      } else if ( command == "ID" ) {
+        char speed[3];
+        snprintf(speed, sizeof(speed), "%02d", motor_speed);
+        reply += std::string("ID115200100") + speed + "0500\n";
+      }
+    }
+
+    if ( streaming )
+      reply += revolution();
+
+    if ( !reply.empty() && send(fd, reply.data(), reply.size(), MSG_NOSIGNAL) == -1 )
+      break;
+  }
+
+  close(fd);
+}
+
+void check_scan(const neo::scan& scan) {
+  CHECK(scan.sector == -1);
+  CHECK(static_cast<int32_t>(scan.samples.size()) == samples_per_revolution);
+
+  for ( int32_t n = 0; n < samples_per_revolution; ++n )
+    CHECK(scan.samples[n].distance == 100 + n);
+}
+
+// Revolutions written to a file come back as scans, then the replay ends
+void replay_capture(const std::string& directory) {
+  const std::string path = directory + "/capture";
+  const int32_t revolutions = 5;
+
+  capture::write(path, std::vector<std::string>(revolutions, revolution()));
+
+  neo::neo device{("file:" + path).c_str()};
+  device.start_scanning();
+
+  int32_t scans = 0;
+
+  try {
+    for ( ;; ) {
+      check_scan(device.get_scan());
+      ++scans;
+    }
+  } catch ( const neo::device_error& e ) {
+    CHECK(std::string(e.what()) == "reached the end of the capture file.");
+  }
+
+  // The last revolution is never closed by a sync packet
+  CHECK(scans == revolutions - 1);
+
+  unlink(path.c_str());
+}
+
+// Talks to the unit through a connected socket: bring-up, streaming, stop
+void round_trip(int listener, const std::string& port, const std::string& directory) {
+  std::thread unit{serve, listener};
+
+  // A settled unit skips the multi-second motor wait and the calibration
+  const std::string cache = directory + "/profiles";
+
+  {
+    std::ofstream file{cache};
+    file << serial_number << " 115200 " << motor_speed << " 1\n";
+  }
+
+  // Errors must not unwind past the unit thread
+  try {
+    neo::device_options options;
+    options.set_profile_cache(cache.c_str());
+
+    neo::neo device{port.c_str(), 115200, options};
+    CHECK(device.get_identity().serial_number == serial_number);
+
+    device.start_scanning();
+
+    for ( int32_t n = 0; n < 5; ++n )
+      check_scan(device.get_scan());
+
+    device.stop_scanning();
+  } catch ( const neo::device_error& e ) {
+    std::cerr << port << ": " << e.what() << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  unit.join();
+  close(listener);
+  unlink(cache.c_str());
+}
+
+void unix_socket(const std::string& directory) {
+  const std::string path = directory + "/unit";
+
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  CHECK(listener != -1);
+  CHECK(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+  CHECK(listen(listener, 1) == 0);
+
+  round_trip(listener, "unix:" + path, directory);
+  unlink(path.c_str());
+}
+
+// Same over TCP, as through a serial-to-Ethernet bridge
+void tcp_socket(const std::string& directory) {
+  sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = 0;
+
+  const int listener = socket(AF_INET, SOCK_STREAM, 0);
+  CHECK(listener != -1);
+  CHECK(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+  CHECK(listen(listener, 1) == 0);
+
+  socklen_t length = sizeof(address);
+  CHECK(getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+
+  round_trip(listener, "tcp://127.0.0.1:" + std::to_string(ntohs(address.sin_port)),
+      directory);
+}
+
+}  // namespace
+
+int main() try {
+  const std::string directory = capture::temporary_directory();
+
+  replay_capture(directory);
+  unix_socket(directory);
+  tcp_socket(directory);
+
+  rmdir(directory.c_str());
+  std::cout << "transport round trips passed" << std::endl;
+} catch ( const neo::device_error& e ) {
+  std::cerr << "Error: " << e.what() << std::endl;
+  return EXIT_FAILURE;
+}